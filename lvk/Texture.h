@@ -9,6 +9,7 @@
 
 #include "allocator.h"
 #include "render_context.h"
+#include "render_graph.h"
 #include "stb_image.h"
 #include "vulkan_context.h"
 
@@ -23,9 +24,14 @@ public:
         texture = std::move(other.texture);
         sampler = other.sampler;
         imageView = other.imageView;
+        format = other.format;
+        mipLevels = other.mipLevels;
+        pending = std::move(other.pending);
+        bindless_index = other.bindless_index;
 
         other.imageView = VK_NULL_HANDLE;
         other.sampler = VK_NULL_HANDLE;
+        other.bindless_index = BindlessTextureHeap::INVALID_INDEX;
         return *this;
     }
 
@@ -33,105 +39,74 @@ public:
         texture = std::move(other.texture);
         sampler = other.sampler;
         imageView = other.imageView;
+        format = other.format;
+        mipLevels = other.mipLevels;
+        pending = std::move(other.pending);
+        bindless_index = other.bindless_index;
 
         other.imageView = VK_NULL_HANDLE;
         other.sampler = VK_NULL_HANDLE;
+        other.bindless_index = BindlessTextureHeap::INVALID_INDEX;
     }
 
     void LoadImage(const std::string &file) {
-        int texWidth, texHeight, texChannels;
-        stbi_uc *pixels = stbi_load(file.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        VkDeviceSize imageSize = texWidth * texHeight * 4;
-        // mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+        LoadImage(context.GetTextureLoader().Load(file).get());
+    }
+
+    // Decode on the texture loader's workers, the image is created on the first Resolve().
+    void LoadImageAsync(const std::string &file) {
+        pending = context.GetTextureLoader().Load(file);
+    }
 
-        if (!pixels) {
-            throw std::runtime_error("failed to load texture image!");
+    // Finish an outstanding LoadImageAsync, blocks if the decode is still running.
+    void Resolve() {
+        if (pending.valid()) {
+            TextureRequest request = std::move(pending);
+            pending = {};
+            LoadImage(request.get());
+        }
+    }
+
+    void LoadImage(const DecodedImage &decoded) {
+        auto &physical_device = context.GetContext().device.physical_device;
+        if (isBlockCompressed(decoded.format) && !physical_device.features.textureCompressionBC) {
+            throw std::runtime_error("block compressed texture needs the textureCompressionBC feature!");
         }
-        auto texture_buffer = context.GetAllocator().CreateBuffer2(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                                                   VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-                                                                   VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-                                                                   |
-                                                                   VMA_ALLOCATION_CREATE_MAPPED_BIT);
-        texture_buffer->CopyData(imageSize, (void *) pixels);
-        texture_buffer->Flush(0, imageSize);
-        //
-        stbi_image_free(pixels);
 
+        format = decoded.format;
+        mipLevels = decoded.mip_levels;
         texture = context.GetAllocator().CreateImage(
-            {static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)},
-            VK_FORMAT_R8G8B8A8_SRGB,
+            {decoded.width, decoded.height},
+            format,
             VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            // TRANSFER_SRC for the mip blits
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT
+            0,
+            mipLevels
         );
 
-
-        TransitionImageLayout(texture->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        CopyBufferToImage(texture_buffer->buffer, texture->image, static_cast<uint32_t>(texWidth),
-                          static_cast<uint32_t>(texHeight));
-
-        TransitionImageLayout(texture->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        texture_buffer->Destroy();
+        // batched into the next upload submission straight from the decoder's staging buffer
+        context.GetTextureLoader().Upload(decoded, texture->image);
 
         //
         createTextureImageView();
         createTextureSampler();
+
+        if (auto *heap = context.GetBindlessHeap()) {
+            bindless_index = heap->Register(imageView, sampler);
+        }
     }
 
     VkSampler GetSampler() { return sampler; }
     VkImageView GetImageView() { return imageView; }
+    // slot in the context's BindlessTextureHeap, INVALID_INDEX without one
+    [[nodiscard]] uint32_t GetBindlessIndex() const { return bindless_index; }
 
     void TransitionImageLayout(VkImage image_, VkFormat format, VkImageLayout oldLayout,
                                VkImageLayout newLayout) {
         VkCommandBuffer commandBuffer = context.BeginSingleTimeCommands();
-
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = oldLayout;
-        barrier.newLayout = newLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = image_;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-
-        VkPipelineStageFlags sourceStage;
-        VkPipelineStageFlags destinationStage;
-
-        if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout ==
-                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        } else {
-            throw std::invalid_argument("unsupported layout transition!");
-        }
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            sourceStage, destinationStage,
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier
-        );
-
+        RecordImageTransition(commandBuffer, image_, format, oldLayout, newLayout);
         context.EndSingleTimeCommands(commandBuffer);
     }
 
@@ -158,10 +133,21 @@ public:
         context.EndSingleTimeCommands(commandBuffer);
     }
 
-    void Destroy() const {
+    void Destroy() {
+        // don't leave a worker writing into a staging buffer the loader is about to free
+        if (pending.valid()) {
+            pending.wait();
+            pending = {};
+        }
         if (texture) {
             texture->Destroy();
         }
+        if (bindless_index != BindlessTextureHeap::INVALID_INDEX) {
+            context.GetBindlessHeap()->Unregister(bindless_index);
+            bindless_index = BindlessTextureHeap::INVALID_INDEX;
+        }
+        context.GetDescriptorSetCache().Invalidate(sampler);
+        context.GetDescriptorSetCache().Invalidate(imageView);
         vkDestroySampler(context.GetContext().device.device, sampler, nullptr);
         vkDestroyImageView(context.GetContext().device.device, imageView, nullptr);
     }
@@ -170,8 +156,16 @@ private:
     RenderContext &context;
 
     std::unique_ptr<Image> texture;
+    TextureRequest pending;
     VkSampler sampler{};
     VkImageView imageView = VK_NULL_HANDLE;
+    VkFormat format = TextureLoader::FORMAT;
+    uint32_t mipLevels = 1;
+    uint32_t bindless_index = BindlessTextureHeap::INVALID_INDEX;
+
+    static bool isBlockCompressed(VkFormat p_format) {
+        return p_format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && p_format <= VK_FORMAT_BC7_SRGB_BLOCK;
+    }
 
 
     void createTextureImageView() {
@@ -179,10 +173,10 @@ private:
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = texture->image;
         viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+        viewInfo.format = format;
         viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.levelCount = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
@@ -209,6 +203,8 @@ private:
         samplerInfo.compareEnable = VK_FALSE;
         samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = static_cast<float>(mipLevels);
 
         if (vkCreateSampler(context.GetContext().device.device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
             throw std::runtime_error("failed to create texture sampler!");
@@ -7,6 +7,8 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include "vertex_layout.h"
+
 namespace lvk {
 
 using vec2 = glm::vec2;
@@ -17,19 +19,6 @@ struct Vertex2 {
     glm::vec3 color;
 
     Vertex2(glm::vec3 pos, glm::vec3 color) : pos(pos), color(color) {}
-
-    static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions() {
-        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
-        attributeDescriptions[0].binding = 0;
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex2, pos);
-        attributeDescriptions[1].binding = 0;
-        attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[1].offset = offsetof(Vertex2, color);
-        return attributeDescriptions;
-    }
 };
 
 struct Vertex3{
@@ -38,25 +27,16 @@ struct Vertex3{
     glm::vec2 uv;
 
     Vertex3(glm::vec3 pos, glm::vec3 color, vec2 uv) : pos(pos), color(color), uv(uv) {}
-
-    static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions() {
-        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(3);
-        attributeDescriptions[0].binding = 0;
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex3, pos);
-        attributeDescriptions[1].binding = 0;
-        attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[1].offset = offsetof(Vertex3, color);
-        attributeDescriptions[2].binding = 0;
-        attributeDescriptions[2].location = 2;
-        attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[2].offset = offsetof(Vertex3, uv);
-        return attributeDescriptions;
-    }
 };
 
+using Vertex2Layout = VertexLayout<
+    LVK_VERTEX_ATTRIBUTE(Vertex2, pos, VK_FORMAT_R32G32B32_SFLOAT),
+    LVK_VERTEX_ATTRIBUTE(Vertex2, color, VK_FORMAT_R32G32B32_SFLOAT)>;
+
+using Vertex3Layout = VertexLayout<
+    LVK_VERTEX_ATTRIBUTE(Vertex3, pos, VK_FORMAT_R32G32B32_SFLOAT),
+    LVK_VERTEX_ATTRIBUTE(Vertex3, color, VK_FORMAT_R32G32B32_SFLOAT),
+    LVK_VERTEX_ATTRIBUTE(Vertex3, uv, VK_FORMAT_R32G32_SFLOAT)>;
 
 } // end namespace lvk
 
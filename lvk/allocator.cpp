@@ -4,6 +4,11 @@
 
 #define VMA_IMPLEMENTATION
 #include "allocator.h"
+#include "upload_manager.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 
 namespace lvk {
 Allocator::Allocator(VulkanContext &context_): context(context_) {
@@ -55,23 +60,23 @@ std::unique_ptr<Buffer> Allocator::CreateBuffer2(VkDeviceSize p_buffer_size, uin
 
     VkBuffer buffer;
     VmaAllocation allocation;
-    vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr);
+    VmaAllocationInfo allocationInfo = {};
+    vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, &allocationInfo);
 
-    return std::make_unique<Buffer>(allocator, buffer, allocation);
+    return std::make_unique<Buffer>(allocator, buffer, allocation, allocationInfo.pMappedData);
 }
 
 std::unique_ptr<Image> Allocator::CreateImage(VkExtent2D extent, VkFormat format, VkImageTiling tiling, uint32_t p_buffer_usage, VmaMemoryUsage p_alloc_usage,
-                                               uint32_t p_alloc_flag) {
+                                               uint32_t p_alloc_flag, uint32_t mip_levels) {
     VkImageCreateInfo imageInfo = {VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
     imageInfo.extent = {extent.width, extent.height, 1};
     imageInfo.usage = p_buffer_usage;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mip_levels;
     imageInfo.arrayLayers = 1;
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-    imageInfo.tiling = VK_IMAGE_TILING_LINEAR;
 
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = p_alloc_usage;
@@ -85,8 +90,238 @@ std::unique_ptr<Image> Allocator::CreateImage(VkExtent2D extent, VkFormat format
     return std::make_unique<Image>(allocator, textureImage, allocation);
 }
 
+VmaAllocation Allocator::AllocateMemory(const VkMemoryRequirements &requirements) {
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    VmaAllocation allocation;
+    if (vmaAllocateMemory(allocator, &requirements, &allocInfo, &allocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate memory!");
+    }
+    return allocation;
+}
+
+void Allocator::BindImageMemory(VmaAllocation allocation, VkDeviceSize offset, VkImage image) {
+    if (vmaBindImageMemory2(allocator, allocation, offset, image, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to bind image memory!");
+    }
+}
+
+void Allocator::FreeMemory(VmaAllocation allocation) {
+    vmaFreeMemory(allocator, allocation);
+}
+
+const VkPhysicalDeviceLimits &Allocator::GetLimits() const {
+    return context.device.physical_device.properties.limits;
+}
+
 void Allocator::Destroy() const {
     vmaDestroyAllocator(allocator);
 }
 
+// *************** Offset Allocator *********************
+
+OffsetAllocator::OffsetAllocator(uint64_t capacity_) : capacity(capacity_) {
+    Reset();
+}
+
+void OffsetAllocator::Reset() {
+    free_by_offset.clear();
+    free_by_size.clear();
+    allocations.clear();
+    used = 0;
+    if (capacity > 0) {
+        insertFreeRange(0, capacity);
+    }
+}
+
+uint64_t OffsetAllocator::Allocate(uint64_t size, uint64_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+    if (size == 0) {
+        return INVALID_OFFSET;
+    }
+
+    // best fit: smallest free range that still holds the request after alignment padding
+    for (auto it = free_by_size.lower_bound(size); it != free_by_size.end(); ++it) {
+        uint64_t begin = it->second;
+        uint64_t range_size = it->first;
+        uint64_t aligned = (begin + alignment - 1) & ~(alignment - 1);
+        uint64_t padding = aligned - begin;
+        if (padding + size > range_size) {
+            continue;
+        }
+
+        eraseFreeRange(free_by_offset.find(begin));
+
+        uint64_t taken = padding + size;
+        if (range_size > taken) {
+            insertFreeRange(begin + taken, range_size - taken);
+        }
+
+        allocations[aligned] = Range{begin, taken};
+        used += taken;
+        return aligned;
+    }
+
+    return INVALID_OFFSET;
+}
+
+void OffsetAllocator::Free(uint64_t offset) {
+    auto it = allocations.find(offset);
+    assert(it != allocations.end() && "freeing an offset that was not allocated");
+    if (it == allocations.end()) {
+        return;
+    }
+
+    Range range = it->second;
+    allocations.erase(it);
+    used -= range.size;
+
+    insertFreeRange(range.begin, range.size);
+}
+
+uint64_t OffsetAllocator::GetLargestFreeRange() const {
+    if (free_by_size.empty()) {
+        return 0;
+    }
+    return free_by_size.rbegin()->first;
+}
+
+void OffsetAllocator::insertFreeRange(uint64_t begin, uint64_t size) {
+    // coalesce with the following range
+    auto next = free_by_offset.lower_bound(begin);
+    if (next != free_by_offset.end() && begin + size == next->first) {
+        size += next->second;
+        eraseFreeRange(next);
+    }
+
+    // coalesce with the preceding range
+    auto prev = free_by_offset.lower_bound(begin);
+    if (prev != free_by_offset.begin()) {
+        --prev;
+        if (prev->first + prev->second == begin) {
+            begin = prev->first;
+            size += prev->second;
+            eraseFreeRange(prev);
+        }
+    }
+
+    free_by_offset.emplace(begin, size);
+    free_by_size.emplace(size, begin);
+}
+
+void OffsetAllocator::eraseFreeRange(std::map<uint64_t, uint64_t>::iterator it) {
+    auto range = free_by_size.equal_range(it->second);
+    for (auto sit = range.first; sit != range.second; ++sit) {
+        if (sit->second == it->first) {
+            free_by_size.erase(sit);
+            break;
+        }
+    }
+    free_by_offset.erase(it);
+}
+
+// *************** Buffer Pool *********************
+
+BufferPool::BufferPool(Allocator &allocator_, UploadManager *upload_manager_, VkBufferUsageFlags usage_,
+                       VkDeviceSize block_size_, bool host_visible_)
+    : allocator(allocator_), upload_manager(upload_manager_), usage(usage_), block_size(block_size_),
+      host_visible(host_visible_) {
+}
+
+BufferPool::Block &BufferPool::createBlock(VkDeviceSize size) {
+    // mapped blocks are device local when the device exposes host visible VRAM, otherwise VMA falls
+    // back to host memory; the others are always plain device local.
+    VmaAllocationCreateFlags flags = host_visible
+                                         ? VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                           VMA_ALLOCATION_CREATE_MAPPED_BIT
+                                         : 0;
+    auto buffer = allocator.CreateBuffer2(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                          VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, flags);
+    if (buffer->buffer == VK_NULL_HANDLE) {
+        throw std::runtime_error("failed to create buffer pool block!");
+    }
+
+    blocks.push_back(Block{std::move(buffer), OffsetAllocator(size)});
+    return blocks.back();
+}
+
+BufferSlice BufferPool::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    // the offset allocator has nothing to hand out for empty ranges
+    if (size == 0) {
+        return {};
+    }
+    for (uint32_t i = 0; i < blocks.size(); i++) {
+        uint64_t offset = blocks[i].ranges.Allocate(size, alignment);
+        if (offset != OffsetAllocator::INVALID_OFFSET) {
+            return BufferSlice{blocks[i].buffer->buffer, offset, size, i};
+        }
+    }
+
+    // oversized requests get a block of their own
+    auto &block = createBlock(std::max(block_size, size));
+    uint64_t offset = block.ranges.Allocate(size, alignment);
+    assert(offset != OffsetAllocator::INVALID_OFFSET);
+
+    return BufferSlice{block.buffer->buffer, offset, size, static_cast<uint32_t>(blocks.size() - 1)};
+}
+
+BufferSlice BufferPool::Upload(const void *data, VkDeviceSize size, VkDeviceSize alignment) {
+    auto slice = Allocate(size, alignment);
+    if (!slice.IsValid()) {
+        return slice;
+    }
+
+    auto &buffer = blocks[slice.block].buffer;
+    if (!host_visible) {
+        if (upload_manager == nullptr) {
+            throw std::runtime_error("buffer pool block is not host visible!");
+        }
+        // staged right away, the copy lands with the upload manager's next flush
+        upload_manager->EnqueueBufferCopy(data, size, buffer->buffer, slice.offset);
+        return slice;
+    }
+
+    auto *mapped = static_cast<uint8_t *>(buffer->GetMappedData());
+    memcpy(mapped + slice.offset, data, size);
+    buffer->Flush(slice.offset, size);
+
+    return slice;
+}
+
+void BufferPool::Free(const BufferSlice &slice) {
+    if (!slice.IsValid()) {
+        return;
+    }
+    assert(slice.block < blocks.size() && "slice does not belong to this pool");
+    blocks[slice.block].ranges.Free(slice.offset);
+}
+
+BufferPoolStats BufferPool::GetStats() const {
+    BufferPoolStats stats{};
+    stats.block_count = static_cast<uint32_t>(blocks.size());
+
+    for (auto const &block: blocks) {
+        stats.allocation_count += block.ranges.GetAllocationCount();
+        stats.free_range_count += block.ranges.GetFreeRangeCount();
+        stats.capacity += block.ranges.GetCapacity();
+        stats.used += block.ranges.GetUsedSize();
+        stats.largest_free_range = std::max<VkDeviceSize>(stats.largest_free_range,
+                                                          block.ranges.GetLargestFreeRange());
+    }
+
+    VkDeviceSize free_size = stats.capacity - stats.used;
+    if (free_size > 0) {
+        stats.fragmentation = 1.0f - static_cast<float>(stats.largest_free_range) / static_cast<float>(free_size);
+    }
+    return stats;
+}
+
+void BufferPool::Destroy() {
+    for (auto &block: blocks) {
+        block.buffer->Destroy();
+    }
+    blocks.clear();
+}
+
 } // end namespace lvk
@@ -5,12 +5,17 @@
 #ifndef LYH_ALLOCATOR_H
 #define LYH_ALLOCATOR_H
 #include <vma/vk_mem_alloc.h>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "vulkan_context.h"
 #include "buffer.h"
 #include "image.h"
 
 namespace lvk {
+class UploadManager;
 
 class Allocator {
 public:
@@ -20,13 +25,125 @@ public:
 
     std::unique_ptr<Buffer> CreateBuffer(VkDeviceSize size_, uint32_t usage_, VmaMemoryUsage memory_);
     std::unique_ptr<Buffer> CreateBuffer2(VkDeviceSize p_buffer_size, uint32_t p_buffer_usage, VmaMemoryUsage p_alloc_usage, uint32_t p_alloc_flag);
-    std::unique_ptr<Image> CreateImage(VkExtent2D extent, VkFormat format, VkImageTiling tiling, uint32_t p_buffer_usage, VmaMemoryUsage p_alloc_usage, uint32_t p_alloc_flag);
+    std::unique_ptr<Image> CreateImage(VkExtent2D extent, VkFormat format, VkImageTiling tiling, uint32_t p_buffer_usage, VmaMemoryUsage p_alloc_usage, uint32_t p_alloc_flag, uint32_t mip_levels = 1);
+
+    // Device local memory for resources created and bound by the caller, e.g. several images
+    // placed at offsets of one allocation.
+    VmaAllocation AllocateMemory(const VkMemoryRequirements &requirements);
+    void BindImageMemory(VmaAllocation allocation, VkDeviceSize offset, VkImage image);
+    void FreeMemory(VmaAllocation allocation);
+
+    [[nodiscard]] const VkPhysicalDeviceLimits &GetLimits() const;
 
 private:
     VmaAllocator allocator{};
     VulkanContext &context;
 };
 
+// CPU side range allocator, best fit over a free list with neighbour coalescing.
+// Hands out offsets only, the memory it describes is owned by the caller.
+class OffsetAllocator {
+public:
+    static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+    explicit OffsetAllocator(uint64_t capacity);
+
+    // Returns INVALID_OFFSET when no free range is large enough.
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+
+    void Free(uint64_t offset);
+
+    void Reset();
+
+    [[nodiscard]] uint64_t GetCapacity() const { return capacity; }
+    [[nodiscard]] uint64_t GetUsedSize() const { return used; }
+    [[nodiscard]] uint32_t GetAllocationCount() const { return static_cast<uint32_t>(allocations.size()); }
+    [[nodiscard]] uint32_t GetFreeRangeCount() const { return static_cast<uint32_t>(free_by_offset.size()); }
+    [[nodiscard]] uint64_t GetLargestFreeRange() const;
+
+private:
+    struct Range {
+        uint64_t begin;
+        uint64_t size;
+    };
+
+    void insertFreeRange(uint64_t begin, uint64_t size);
+
+    void eraseFreeRange(std::map<uint64_t, uint64_t>::iterator it);
+
+    uint64_t capacity = 0;
+    uint64_t used = 0;
+
+    std::map<uint64_t, uint64_t> free_by_offset;
+    std::multimap<uint64_t, uint64_t> free_by_size;
+    // aligned offset -> range actually taken out of the free list (includes alignment padding)
+    std::unordered_map<uint64_t, Range> allocations;
+};
+
+struct BufferSlice {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t block = UINT32_MAX;
+
+    [[nodiscard]] bool IsValid() const { return buffer != VK_NULL_HANDLE; }
+};
+
+struct BufferPoolStats {
+    uint32_t block_count = 0;
+    uint32_t allocation_count = 0;
+    uint32_t free_range_count = 0;
+    VkDeviceSize capacity = 0;
+    VkDeviceSize used = 0;
+    VkDeviceSize largest_free_range = 0;
+    // 0 when all free space is one contiguous range, approaching 1 when it is scattered
+    float fragmentation = 0.0f;
+};
+
+// Places many meshes into a few large buffers instead of one VkBuffer/VmaAllocation per draw object.
+class BufferPool {
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 16 * 1024 * 1024;
+
+    // Blocks are device local and Upload() enqueues a copy on `upload_manager`, which may be
+    // nullptr for pools only filled by the caller's own copies. With `host_visible` blocks are
+    // persistently mapped instead and Upload() writes through the mapping.
+    explicit BufferPool(Allocator &allocator, UploadManager *upload_manager, VkBufferUsageFlags usage,
+                        VkDeviceSize block_size = DEFAULT_BLOCK_SIZE, bool host_visible = false);
+
+    BufferPool(const BufferPool &) = delete;
+
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // An empty slice (IsValid() false) for size 0.
+    BufferSlice Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+    // Allocate and copy `data` in. Throws for device local pools without an upload manager.
+    BufferSlice Upload(const void *data, VkDeviceSize size, VkDeviceSize alignment = 16);
+
+    // Empty slices are ignored.
+    void Free(const BufferSlice &slice);
+
+    [[nodiscard]] BufferPoolStats GetStats() const;
+
+    void Destroy();
+
+private:
+    struct Block {
+        std::unique_ptr<Buffer> buffer;
+        OffsetAllocator ranges;
+    };
+
+    Block &createBlock(VkDeviceSize size);
+
+    Allocator &allocator;
+    UploadManager *upload_manager;
+    VkBufferUsageFlags usage;
+    VkDeviceSize block_size;
+    bool host_visible;
+    std::vector<Block> blocks;
+};
+
 
 } // end namespace lvk
 
@@ -0,0 +1,150 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "bindless_heap.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace lvk {
+
+VkPhysicalDeviceDescriptorIndexingFeatures BindlessTextureHeap::requiredFeatures() {
+    VkPhysicalDeviceDescriptorIndexingFeatures features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    features.runtimeDescriptorArray = VK_TRUE;
+    features.descriptorBindingPartiallyBound = VK_TRUE;
+    features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    return features;
+}
+
+void BindlessTextureHeap::RequireFeatures(PhysicalDeviceSelector &selector) {
+    // core in 1.2, the instance targets 1.1
+    selector.AddRequiredExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    selector.AddRequiredExtensionFeatures(requiredFeatures());
+}
+
+bool BindlessTextureHeap::IsSupported(const Device &device) {
+    // what the device was created with, the physical device may support more than was asked for
+    return device.IsExtensionEnabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) &&
+           device.AreExtensionFeaturesEnabled(requiredFeatures());
+}
+
+BindlessTextureHeap::BindlessTextureHeap(Device &device, uint32_t frame_count, uint32_t capacity)
+    : device{device}, frame_count{frame_count} {
+    VkPhysicalDeviceDescriptorIndexingProperties indexing{};
+    indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &indexing;
+    vkGetPhysicalDeviceProperties2(device.physical_device.physical_device, &properties);
+
+    // a combined image sampler counts against both the sampler and the sampled image limits
+    this->capacity = std::min({capacity,
+                               indexing.maxPerStageDescriptorUpdateAfterBindSamplers,
+                               indexing.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                               indexing.maxDescriptorSetUpdateAfterBindSamplers,
+                               indexing.maxDescriptorSetUpdateAfterBindSampledImages});
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = this->capacity;
+    binding.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+
+    VkDescriptorBindingFlags binding_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                             VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                             VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info{};
+    flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flags_info.bindingCount = 1;
+    flags_info.pBindingFlags = &binding_flags;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.pNext = &flags_info;
+    layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layout_info.bindingCount = 1;
+    layout_info.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(device.device, &layout_info, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create bindless descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, this->capacity};
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+    if (vkCreateDescriptorPool(device.device, &pool_info, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = pool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &layout;
+    if (vkAllocateDescriptorSets(device.device, &alloc_info, &set) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate bindless descriptor set!");
+    }
+}
+
+void BindlessTextureHeap::Destroy() {
+    vkDestroyDescriptorPool(device.device, pool, nullptr);
+    vkDestroyDescriptorSetLayout(device.device, layout, nullptr);
+}
+
+void BindlessTextureHeap::BeginFrame() {
+    std::lock_guard lock(mutex);
+    frame_number++;
+    auto end = std::remove_if(retired.begin(), retired.end(), [&](auto const &retired_index) {
+        if (frame_number - retired_index.first < frame_count) {
+            return false;
+        }
+        free_indices.push_back(retired_index.second);
+        return true;
+    });
+    retired.erase(end, retired.end());
+}
+
+uint32_t BindlessTextureHeap::Register(VkImageView image_view, VkSampler sampler) {
+    std::lock_guard lock(mutex);
+    uint32_t index;
+    if (!free_indices.empty()) {
+        index = free_indices.back();
+        free_indices.pop_back();
+    } else if (next_index < capacity) {
+        index = next_index++;
+    } else {
+        throw std::runtime_error("failed to register texture, bindless heap is full!");
+    }
+
+    VkDescriptorImageInfo image_info{};
+    image_info.sampler = sampler;
+    image_info.imageView = image_view;
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = 0;
+    write.dstArrayElement = index;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &image_info;
+    // the set is externally synchronized, hence the update under the lock
+    vkUpdateDescriptorSets(device.device, 1, &write, 0, nullptr);
+    return index;
+}
+
+void BindlessTextureHeap::Unregister(uint32_t index) {
+    std::lock_guard lock(mutex);
+    // frames still in flight may sample it, the slot is left as is until it is reused
+    retired.emplace_back(frame_number, index);
+}
+
+} // end namespace lvk
@@ -0,0 +1,78 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_BINDLESS_HEAP_H
+#define LYH_BINDLESS_HEAP_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "device.h"
+
+namespace lvk {
+
+// One descriptor set holding a large COMBINED_IMAGE_SAMPLER array that every texture registers
+// into for a stable index. The set is bound once and shaders pick the texture with the index from
+// per-draw data, so drawing with another texture no longer needs a vkCmdBindDescriptorSets.
+//
+// The binding is partially bound and update-after-bind: unused slots may stay empty and textures
+// can be registered while command buffers using the set are recorded or in flight. Unregistered
+// indices are only handed out again `frame_count` frames later.
+class BindlessTextureHeap {
+public:
+    static constexpr uint32_t MAX_TEXTURES = 4096;
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // Add the descriptor indexing extension and features the heap needs to the device requirements.
+    static void RequireFeatures(PhysicalDeviceSelector &selector);
+
+    // True when `device` was created with the features RequireFeatures() asks for.
+    static bool IsSupported(const Device &device);
+
+    // `capacity` is clamped to the device's update-after-bind limits.
+    BindlessTextureHeap(Device &device, uint32_t frame_count, uint32_t capacity = MAX_TEXTURES);
+
+    BindlessTextureHeap(const BindlessTextureHeap &) = delete;
+
+    BindlessTextureHeap &operator=(const BindlessTextureHeap &) = delete;
+
+    void Destroy();
+
+    // Makes indices unregistered `frame_count` frames ago available again, call once per frame
+    // after the fence wait.
+    void BeginFrame();
+
+    // The image must be in SHADER_READ_ONLY_OPTIMAL when sampled. Throws when the heap is full.
+    uint32_t Register(VkImageView image_view, VkSampler sampler);
+
+    void Unregister(uint32_t index);
+
+    [[nodiscard]] VkDescriptorSetLayout GetLayout() const { return layout; }
+    [[nodiscard]] VkDescriptorSet GetSet() const { return set; }
+    [[nodiscard]] uint32_t GetCapacity() const { return capacity; }
+
+private:
+    static VkPhysicalDeviceDescriptorIndexingFeatures requiredFeatures();
+
+    Device &device;
+    uint32_t frame_count;
+    uint32_t capacity;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+
+    std::mutex mutex;
+    uint32_t next_index = 0;
+    std::vector<uint32_t> free_indices;
+    std::vector<std::pair<uint64_t, uint32_t>> retired; // frame unregistered in, index
+    uint64_t frame_number = 0;
+};
+
+} // end namespace lvk
+
+#endif //LYH_BINDLESS_HEAP_H
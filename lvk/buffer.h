@@ -9,9 +9,11 @@
 
 namespace lvk {
 struct Buffer {
-    explicit Buffer(VmaAllocator &allocator_, VkBuffer buffer_, VmaAllocation allocation_) : allocator(allocator_),
-        buffer(buffer_),
-        allocation(allocation_) {
+    explicit Buffer(VmaAllocator &allocator_, VkBuffer buffer_, VmaAllocation allocation_,
+                    void *mapped_ = nullptr) : allocator(allocator_),
+                                               buffer(buffer_),
+                                               allocation(allocation_),
+                                               mapped(mapped_) {
     }
 
     explicit Buffer(VmaAllocator &allocator_, VkImage image_, VmaAllocation allocation_) : allocator(allocator_),
@@ -21,9 +23,11 @@ struct Buffer {
 
     // The Move Constructor
     Buffer(Buffer &&other) noexcept
-        : allocator(other.allocator),
+        : size(other.size),
+          allocator(other.allocator),
           buffer(other.buffer),
-          allocation(other.allocation) {
+          allocation(other.allocation),
+          mapped(other.mapped) {
     }
 
     // The Move Assignment Operator
@@ -32,6 +36,8 @@ struct Buffer {
             allocator = other.allocator;
             buffer = other.buffer;
             allocation = other.allocation;
+            mapped = other.mapped;
+            size = other.size;
         }
 
         return *this;
@@ -43,6 +49,13 @@ struct Buffer {
     }
 
     void CopyData(uint32_t p_size, void *data) {
+        // persistently mapped (VMA_ALLOCATION_CREATE_MAPPED_BIT), skip the map/unmap round trip
+        if (mapped) {
+            memcpy(mapped, data, p_size);
+            size = p_size;
+            return;
+        }
+
         void *mappedData;
         vmaMapMemory(allocator, allocation, &mappedData);
         memcpy(mappedData, data, p_size);
@@ -59,6 +72,8 @@ struct Buffer {
         vmaFlushAllocation(allocator, allocation, 0, VK_WHOLE_SIZE);
     }
 
+    [[nodiscard]] void *GetMappedData() const { return mapped; }
+
     // ~Buffer() {
     //     VmaAllocation allocation = nullptr;
     //     vmaDestroyBuffer(allocator, buffer, allocation);
@@ -67,6 +82,7 @@ struct Buffer {
     VmaAllocator &allocator;
     VkBuffer buffer;
     VmaAllocation allocation;
+    void *mapped = nullptr;
 };
 } // end namespace lvk
 #endif //LYH_BUFFER_H
@@ -4,7 +4,9 @@
 
 #include "descriptor.h"
 
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <ostream>
 
 namespace lvk {
@@ -106,6 +108,17 @@ void DescriptorPool::Cleanup() {
 }
 
 bool DescriptorPool::AllocDescriptor(
+    const VkDescriptorSetLayout &descriptorSetLayout, VkDescriptorSet &descriptor) const {
+    // a fixed size pool, DescriptorPoolManager grows a list of these instead of failing here
+    VkResult code = TryAllocDescriptor(descriptorSetLayout, descriptor);
+    if (code != VK_SUCCESS) {
+        std::cout << "failed to allocate descriptor set! code: " << code << std::endl;
+        return false;
+    }
+    return true;
+}
+
+VkResult DescriptorPool::TryAllocDescriptor(
     const VkDescriptorSetLayout &descriptorSetLayout, VkDescriptorSet &descriptor) const {
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -113,14 +126,7 @@ bool DescriptorPool::AllocDescriptor(
     allocInfo.pSetLayouts = &descriptorSetLayout;
     allocInfo.descriptorSetCount = 1;
 
-    // Might want to create a "DescriptorPoolManager" class that handles this case, and builds
-    // a new pool whenever an old pool fills up. But this is beyond our current scope
-    int32_t code = vkAllocateDescriptorSets(device.device, &allocInfo, &descriptor);
-    if (code != VK_SUCCESS) {
-        std::cout << "failed to allocate descriptor set! code: " << code << std::endl;
-        return false;
-    }
-    return true;
+    return vkAllocateDescriptorSets(device.device, &allocInfo, &descriptor);
 }
 
 void DescriptorPool::Free(std::vector<VkDescriptorSet> &descriptors) const {
@@ -135,10 +141,307 @@ void DescriptorPool::ResetPool() const {
     vkResetDescriptorPool(device.device, descriptorPool, 0);
 }
 
+// *************** Descriptor Pool Manager *********************
+
+DescriptorPoolManager::DescriptorPoolManager(Device &device, uint32_t frame_count)
+    : device{device}, frames(frame_count) {
+}
+
+void DescriptorPoolManager::Destroy() {
+    for (auto &[key, list]: persistent) {
+        for (auto &pool: list.pools) {
+            pool->Cleanup();
+        }
+    }
+    for (auto &classes: frames) {
+        for (auto &[key, list]: classes) {
+            for (auto &pool: list.pools) {
+                pool->Cleanup();
+            }
+        }
+    }
+    persistent.clear();
+    persistent_owners.clear();
+    frames.clear();
+}
+
+void DescriptorPoolManager::BeginFrame(uint32_t frame_index_) {
+    frame_index = frame_index_;
+    for (auto &[key, list]: frames[frame_index]) {
+        // only the pools this frame got to were touched, the pools stay around for the next use
+        for (size_t i = 0; i < list.pools.size() && i <= list.current; i++) {
+            list.pools[i]->ResetPool();
+        }
+        list.current = 0;
+    }
+}
+
+VkDescriptorSet DescriptorPoolManager::Allocate(const DescriptorSetLayout &layout) {
+    auto &list = poolList(persistent, layout);
+    size_t pool_index = 0;
+    auto set = allocate(list, layout, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, pool_index);
+    persistent_owners[set] = {&list, pool_index};
+    return set;
+}
+
+VkDescriptorSet DescriptorPoolManager::AllocateTransient(const DescriptorSetLayout &layout) {
+    size_t pool_index = 0;
+    return allocate(poolList(frames[frame_index], layout), layout, 0, pool_index);
+}
+
+void DescriptorPoolManager::Free(const std::vector<VkDescriptorSet> &descriptors) {
+    for (auto set: descriptors) {
+        auto found = persistent_owners.find(set);
+        if (found == persistent_owners.end()) {
+            throw std::runtime_error("failed to free descriptor set, it is not a persistent set of this manager!");
+        }
+        auto [list, pool_index] = found->second;
+        std::vector<VkDescriptorSet> single{set};
+        list->pools[pool_index]->Free(single);
+        // the pool has room again, let the next allocation try it first
+        list->current = std::min(list->current, pool_index);
+        persistent_owners.erase(found);
+    }
+}
+
+uint32_t DescriptorPoolManager::GetPoolCount() const {
+    size_t count = 0;
+    for (auto const &[key, list]: persistent) {
+        count += list.pools.size();
+    }
+    for (auto const &classes: frames) {
+        for (auto const &[key, list]: classes) {
+            count += list.pools.size();
+        }
+    }
+    return static_cast<uint32_t>(count);
+}
+
+DescriptorPoolManager::PoolList &DescriptorPoolManager::poolList(
+    LayoutClasses &classes, const DescriptorSetLayout &layout) const {
+    // the layout class: descriptor count per type, in type order so equal shapes give equal keys
+    std::map<VkDescriptorType, uint32_t> counts;
+    for (auto const &[binding, layoutBinding]: layout.bindings) {
+        counts[layoutBinding.descriptorType] += layoutBinding.descriptorCount;
+    }
+    std::vector<VkDescriptorPoolSize> set_sizes;
+    for (auto const &[type, count]: counts) {
+        if (count > 0) {
+            set_sizes.push_back({type, count});
+        }
+    }
+    std::string key(reinterpret_cast<const char *>(set_sizes.data()), set_sizes.size() * sizeof(VkDescriptorPoolSize));
+
+    auto &list = classes[key];
+    if (list.set_sizes.empty()) {
+        list.set_sizes = std::move(set_sizes);
+    }
+    return list;
+}
+
+VkDescriptorSet DescriptorPoolManager::allocate(PoolList &list, const DescriptorSetLayout &layout,
+                                                VkDescriptorPoolCreateFlags flags, size_t &pool_index) {
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    for (; list.current < list.pools.size(); list.current++) {
+        VkResult code = list.pools[list.current]->TryAllocDescriptor(layout.getDescriptorSetLayout(), set);
+        if (code == VK_SUCCESS) {
+            pool_index = list.current;
+            return set;
+        }
+        if (code != VK_ERROR_OUT_OF_POOL_MEMORY && code != VK_ERROR_FRAGMENTED_POOL) {
+            throw std::runtime_error("failed to allocate descriptor set!");
+        }
+    }
+
+    // every pool is full, grow
+    auto builder = DescriptorPool::Builder(device);
+    builder.SetMaxSets(list.next_sets).SetPoolFlags(flags);
+    for (auto const &size: list.set_sizes) {
+        builder.AddPoolSize(size.type, size.descriptorCount * list.next_sets);
+    }
+    if (list.set_sizes.empty()) {
+        // a layout without descriptors still needs a valid pool to allocate its sets from
+        builder.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1);
+    }
+    list.pools.push_back(builder.Build());
+    list.next_sets = std::min(list.next_sets * 2, MAX_SETS_PER_POOL);
+
+    if (list.pools.back()->TryAllocDescriptor(layout.getDescriptorSetLayout(), set) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor set from a new pool!");
+    }
+    pool_index = list.current;
+    return set;
+}
+
+// *************** Descriptor Set Cache *********************
+
+namespace {
+template<typename T>
+void append_bytes(std::string &key, const T &value) {
+    key.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename Handle>
+uint64_t handle_bits(Handle handle) {
+    uint64_t bits = 0;
+    memcpy(&bits, &handle, sizeof(Handle));
+    return bits;
+}
+} // namespace
+
+DescriptorSetCache::DescriptorSetCache(DescriptorPoolManager &pools, uint32_t frame_count, size_t capacity)
+    : pools{pools}, frame_count{frame_count}, capacity{capacity} {
+}
+
+void DescriptorSetCache::Destroy() {
+    // the sets go away with the manager's pools
+    entries.clear();
+    lookup.clear();
+    by_set.clear();
+    idle.clear();
+    retired.clear();
+}
+
+void DescriptorSetCache::BeginFrame() {
+    frame_number++;
+    std::vector<VkDescriptorSet> expired;
+    auto end = std::remove_if(retired.begin(), retired.end(), [&](auto const &retired_set) {
+        if (frame_number - retired_set.first < frame_count) {
+            return false;
+        }
+        expired.push_back(retired_set.second);
+        return true;
+    });
+    retired.erase(end, retired.end());
+    if (!expired.empty()) {
+        pools.Free(expired);
+    }
+}
+
+VkDescriptorSet DescriptorSetCache::Acquire(DescriptorWriter &writer) {
+    auto layout = writer.setLayout.getDescriptorSetLayout();
+    std::vector<uint64_t> resources{handle_bits(layout)};
+    std::string key;
+    append_bytes(key, handle_bits(layout));
+
+    // in binding order, so the same writes made in a different order still hit
+    auto writes = writer.writes;
+    std::sort(writes.begin(), writes.end(), [](auto const &a, auto const &b) {
+        return a.dstBinding != b.dstBinding ? a.dstBinding < b.dstBinding : a.dstArrayElement < b.dstArrayElement;
+    });
+    for (auto const &write: writes) {
+        append_bytes(key, write.dstBinding);
+        append_bytes(key, write.dstArrayElement);
+        append_bytes(key, write.descriptorType);
+        append_bytes(key, write.descriptorCount);
+        for (uint32_t i = 0; i < write.descriptorCount; i++) {
+            if (write.pBufferInfo) {
+                auto const &info = write.pBufferInfo[i];
+                append_bytes(key, handle_bits(info.buffer));
+                append_bytes(key, info.offset);
+                append_bytes(key, info.range);
+                resources.push_back(handle_bits(info.buffer));
+            } else if (write.pImageInfo) {
+                auto const &info = write.pImageInfo[i];
+                append_bytes(key, handle_bits(info.sampler));
+                append_bytes(key, handle_bits(info.imageView));
+                append_bytes(key, info.imageLayout);
+                resources.push_back(handle_bits(info.sampler));
+                resources.push_back(handle_bits(info.imageView));
+            }
+        }
+    }
+
+    auto found = lookup.find(key);
+    if (found != lookup.end()) {
+        auto entry = found->second;
+        if (entry->refs++ == 0) {
+            idle.erase(entry->idle_pos);
+        }
+        hits++;
+        return entry->set;
+    }
+
+    misses++;
+    VkDescriptorSet set = pools.Allocate(writer.setLayout);
+    writer.overwrite(set);
+
+    entries.push_front({std::move(key), set, std::move(resources), 1});
+    auto entry = entries.begin();
+    lookup[entry->key] = entry;
+    by_set[set] = entry;
+    evict();
+    return set;
+}
+
+void DescriptorSetCache::Release(VkDescriptorSet set) {
+    auto found = by_set.find(set);
+    if (found == by_set.end()) {
+        throw std::runtime_error("failed to release descriptor set, it is not in the cache!");
+    }
+    auto entry = found->second;
+    assert(entry->refs > 0 && "descriptor set released more often than acquired");
+    if (--entry->refs > 0) {
+        return;
+    }
+    if (entry->stale) {
+        retire(entry);
+        return;
+    }
+    idle.push_front(entry);
+    entry->idle_pos = idle.begin();
+    evict();
+}
+
+void DescriptorSetCache::PrintStats() const {
+    std::cout << "[DescriptorSetCache] " << hits << " hits, " << misses << " misses, " << evictions
+            << " evicted, " << entries.size() << " cached" << std::endl;
+}
+
+void DescriptorSetCache::invalidate(uint64_t handle) {
+    for (auto entry = entries.begin(); entry != entries.end();) {
+        auto next = std::next(entry);
+        if (!entry->stale && std::find(entry->resources.begin(), entry->resources.end(), handle) !=
+                             entry->resources.end()) {
+            // nothing may find it again, in use sets live on until their last Release()
+            lookup.erase(entry->key);
+            entry->stale = true;
+            if (entry->refs == 0) {
+                idle.erase(entry->idle_pos);
+                retire(entry);
+            }
+        }
+        entry = next;
+    }
+}
+
+void DescriptorSetCache::retire(EntryIt entry) {
+    retired.emplace_back(frame_number, entry->set);
+    by_set.erase(entry->set);
+    if (!entry->stale) {
+        lookup.erase(entry->key);
+    }
+    entries.erase(entry);
+}
+
+void DescriptorSetCache::evict() {
+    // only unreferenced sets can go, the cache may stay above capacity while they are all in use
+    while (entries.size() > capacity && !idle.empty()) {
+        auto entry = idle.back();
+        idle.pop_back();
+        retire(entry);
+        evictions++;
+    }
+}
+
 // *************** Descriptor Writer *********************
 
 DescriptorWriter::DescriptorWriter(DescriptorSetLayout &setLayout, DescriptorPool &pool)
-    : setLayout{setLayout}, pool{pool} {
+    : setLayout{setLayout}, pool{&pool} {
+}
+
+DescriptorWriter::DescriptorWriter(DescriptorSetLayout &setLayout, DescriptorPoolManager &manager, bool transient)
+    : setLayout{setLayout}, manager{&manager}, transient{transient} {
 }
 
 DescriptorWriter &DescriptorWriter::WriteBuffer(
@@ -184,8 +487,10 @@ DescriptorWriter &DescriptorWriter::WriteImage(
 }
 
 bool DescriptorWriter::Build(VkDescriptorSet &set) {
-    bool success = pool.AllocDescriptor(setLayout.getDescriptorSetLayout(), set);
-    if (!success) {
+    if (manager) {
+        // the manager grows instead of failing, it throws on anything else
+        set = transient ? manager->AllocateTransient(setLayout) : manager->Allocate(setLayout);
+    } else if (!pool->AllocDescriptor(setLayout.getDescriptorSetLayout(), set)) {
         return false;
     }
     overwrite(set);
@@ -196,7 +501,7 @@ void DescriptorWriter::overwrite(VkDescriptorSet &set) {
     for (auto &write: writes) {
         write.dstSet = set;
     }
-    vkUpdateDescriptorSets(pool.device.device, writes.size(), writes.data(), 0, nullptr);
+    vkUpdateDescriptorSets(setLayout.device.device, writes.size(), writes.data(), 0, nullptr);
 }
 
 } // end namespace lvk
@@ -6,6 +6,9 @@
 #define LYH_DESCRIPTOR_H
 
 #include <vulkan/vulkan.h>
+#include <cstring>
+#include <list>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include <memory>
@@ -50,6 +53,7 @@ private:
     std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
 
     friend class DescriptorWriter;
+    friend class DescriptorPoolManager;
 };
 
 class DescriptorPool {
@@ -89,6 +93,11 @@ public:
     bool AllocDescriptor(
         const VkDescriptorSetLayout &descriptorSetLayout, VkDescriptorSet &descriptor) const;
 
+    // Returns vkAllocateDescriptorSets' result, VK_ERROR_OUT_OF_POOL_MEMORY / VK_ERROR_FRAGMENTED_POOL
+    // mean this pool is full.
+    VkResult TryAllocDescriptor(
+        const VkDescriptorSetLayout &descriptorSetLayout, VkDescriptorSet &descriptor) const;
+
     void Free(std::vector<VkDescriptorSet> &descriptors) const;
 
     void ResetPool() const;
@@ -100,10 +109,149 @@ private:
     friend class DescriptorWriter;
 };
 
+// Hands out descriptor sets from pools it creates on demand, so nothing has to be sized up front.
+// Pools are kept per layout class (the descriptor types and counts a layout needs): a pool only
+// serves sets of its shape and cannot run dry of one type while the others sit unused. When a
+// pool reports VK_ERROR_OUT_OF_POOL_MEMORY or VK_ERROR_FRAGMENTED_POOL the next one is tried, and
+// a new pool twice the size of the last is created once all of them are full.
+//
+// Persistent sets live until Free() or Destroy(). Transient sets belong to the current frame and
+// are never freed one by one, BeginFrame() recycles them all with a vkResetDescriptorPool per pool.
+// Like the pools themselves the manager is not thread safe.
+class DescriptorPoolManager {
+public:
+    static constexpr uint32_t INITIAL_SETS_PER_POOL = 64;
+    static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+    DescriptorPoolManager(Device &device, uint32_t frame_count);
+
+    DescriptorPoolManager(const DescriptorPoolManager &) = delete;
+
+    DescriptorPoolManager &operator=(const DescriptorPoolManager &) = delete;
+
+    void Destroy();
+
+    // Must only be called after the in-flight fence of `frame_index` has been waited on,
+    // every transient set allocated while it was last current is reset.
+    void BeginFrame(uint32_t frame_index);
+
+    VkDescriptorSet Allocate(const DescriptorSetLayout &layout);
+
+    // Valid until BeginFrame() comes back around to the current frame index.
+    VkDescriptorSet AllocateTransient(const DescriptorSetLayout &layout);
+
+    void Free(const std::vector<VkDescriptorSet> &descriptors);
+
+    [[nodiscard]] uint32_t GetPoolCount() const;
+
+private:
+    struct PoolList {
+        std::vector<VkDescriptorPoolSize> set_sizes; // what one set of this class needs
+        std::vector<std::unique_ptr<DescriptorPool>> pools;
+        size_t current = 0; // pools before it were full last time they were tried
+        uint32_t next_sets = INITIAL_SETS_PER_POOL;
+    };
+
+    using LayoutClasses = std::unordered_map<std::string, PoolList>;
+
+    PoolList &poolList(LayoutClasses &classes, const DescriptorSetLayout &layout) const;
+
+    // `pool_index` receives the index of the pool in `list` the set came from
+    VkDescriptorSet allocate(PoolList &list, const DescriptorSetLayout &layout, VkDescriptorPoolCreateFlags flags,
+                             size_t &pool_index);
+
+    Device &device;
+    LayoutClasses persistent;
+    // persistent set -> the list and pool it was allocated from, for Free()
+    std::unordered_map<VkDescriptorSet, std::pair<PoolList *, size_t>> persistent_owners;
+    std::vector<LayoutClasses> frames;
+    uint32_t frame_index = 0;
+};
+
+class DescriptorWriter;
+
+// Descriptor sets deduplicated by content: the layout plus every buffer / image / sampler written
+// into it. Acquiring a writer whose writes match a cached set returns that set without allocating
+// or calling vkUpdateDescriptorSets, so e.g. every untextured object shares the same per-frame
+// UBO set. Sets are reference counted; released sets stay cached and are evicted least recently
+// used first once the cache holds more than `capacity` sets.
+//
+// Invalidate() must be called before a resource a set refers to is destroyed, the sets using it
+// are dropped from the cache. Evicted and invalidated sets are freed `frame_count` frames later,
+// when no in-flight frame can still be reading them.
+class DescriptorSetCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    DescriptorSetCache(DescriptorPoolManager &pools, uint32_t frame_count, size_t capacity = DEFAULT_CAPACITY);
+
+    DescriptorSetCache(const DescriptorSetCache &) = delete;
+
+    DescriptorSetCache &operator=(const DescriptorSetCache &) = delete;
+
+    void Destroy();
+
+    // Frees the sets retired `frame_count` frames ago, call once per frame after the fence wait.
+    void BeginFrame();
+
+    // The writer's buffer / image infos only have to be valid during the call.
+    VkDescriptorSet Acquire(DescriptorWriter &writer);
+
+    void Release(VkDescriptorSet set);
+
+    // Any VkBuffer, VkImageView, VkSampler or VkDescriptorSetLayout used by cached sets.
+    template<typename Handle>
+    void Invalidate(Handle handle) {
+        static_assert(sizeof(Handle) <= sizeof(uint64_t));
+        uint64_t bits = 0;
+        memcpy(&bits, &handle, sizeof(Handle));
+        invalidate(bits);
+    }
+
+    [[nodiscard]] size_t GetSize() const { return entries.size(); }
+
+    void PrintStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        std::vector<uint64_t> resources; // handles the set refers to, for Invalidate()
+        uint32_t refs = 0;
+        bool stale = false; // invalidated while in use, retired on its last Release()
+        std::list<std::list<Entry>::iterator>::iterator idle_pos;
+    };
+    using EntryIt = std::list<Entry>::iterator;
+
+    void invalidate(uint64_t handle);
+
+    void retire(EntryIt entry);
+
+    void evict();
+
+    DescriptorPoolManager &pools;
+    uint32_t frame_count;
+    size_t capacity;
+
+    std::list<Entry> entries;
+    std::unordered_map<std::string, EntryIt> lookup;
+    std::unordered_map<VkDescriptorSet, EntryIt> by_set;
+    std::list<EntryIt> idle; // unreferenced entries, most recently released first
+
+    uint64_t frame_number = 0;
+    std::vector<std::pair<uint64_t, VkDescriptorSet>> retired; // frame retired in, set
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
 class DescriptorWriter {
 public:
     DescriptorWriter(DescriptorSetLayout &setLayout, DescriptorPool &pool);
 
+    DescriptorWriter(DescriptorSetLayout &setLayout, DescriptorPoolManager &manager, bool transient = false);
+
     DescriptorWriter &WriteBuffer(uint32_t binding, VkDescriptorBufferInfo *bufferInfo);
 
     DescriptorWriter &WriteImage(uint32_t binding, VkDescriptorImageInfo *imageInfo);
@@ -114,8 +262,12 @@ public:
 private:
     void overwrite(VkDescriptorSet &set);
     DescriptorSetLayout &setLayout;
-    DescriptorPool &pool;
+    DescriptorPool *pool = nullptr;
+    DescriptorPoolManager *manager = nullptr;
+    bool transient = false;
     std::vector<VkWriteDescriptorSet> writes;
+
+    friend class DescriptorSetCache;
 };
 
 } // end namespace lvk
@@ -442,17 +442,25 @@ bool PhysicalDevice::EnableExtensionsIfPresent(size_t count, const char *const *
     return true;
 }
 
-bool PhysicalDevice::EnableFeaturesIfPresent(const VkPhysicalDeviceFeatures &features_to_enable) const {
+bool PhysicalDevice::EnableFeaturesIfPresent(const VkPhysicalDeviceFeatures &features_to_enable) {
     VkPhysicalDeviceFeatures actual_pdf{};
     vkGetPhysicalDeviceFeatures(physical_device, &actual_pdf);
 
-    std::vector<std::string> unsupported_features;
-    // detail::compare_VkPhysicalDeviceFeatures(unsupported_features, actual_pdf, features_to_enable);
-    // if (unsupported_features.empty()) {
-    //     detail::merge_VkPhysicalDeviceFeatures(features, features_to_enable);
-    //     return true;
-    // }
-    return false;
+    // VkPhysicalDeviceFeatures is nothing but VkBool32 members
+    constexpr size_t count = sizeof(VkPhysicalDeviceFeatures) / sizeof(VkBool32);
+    auto requested = reinterpret_cast<const VkBool32 *>(&features_to_enable);
+    auto supported = reinterpret_cast<const VkBool32 *>(&actual_pdf);
+    for (size_t i = 0; i < count; i++) {
+        if (requested[i] && !supported[i]) {
+            return false;
+        }
+    }
+
+    auto enabled = reinterpret_cast<VkBool32 *>(&features);
+    for (size_t i = 0; i < count; i++) {
+        enabled[i] = enabled[i] || requested[i];
+    }
+    return true;
 }
 
 bool PhysicalDevice::EnableFeaturesStructIfPresent(
@@ -461,22 +469,18 @@ bool PhysicalDevice::EnableFeaturesStructIfPresent(
     actual_pdf2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     actual_pdf2.pNext = query_struct;
 
-    // bool instance_is_1_1 = instance_version >= VKB_VK_API_VERSION_1_1;
-    // if (instance_is_1_1 || properties2_ext_enabled) {
-    //     if (instance_is_1_1) {
-    //         detail::vulkan_functions().fp_vkGetPhysicalDeviceFeatures2(physical_device, &actual_pdf2);
-    //     } else {
-    //         detail::vulkan_functions().fp_vkGetPhysicalDeviceFeatures2KHR(physical_device, &actual_pdf2);
-    //     }
-    //
-    //     std::vector<std::string> error_list;
-    //     detail::compare_feature_struct(sType, error_list, query_struct, features_struct);
-    //
-    //     if (error_list.empty()) {
-    //         extended_features_chain.add_structure(sType, struct_size, features_struct);
-    //         return true;
-    //     }
-    // }
+    // the KHR entry point would need the instance handle, which the physical device does not keep
+    if (instance_version_ >= VK_API_VERSION_1_1) {
+        vkGetPhysicalDeviceFeatures2(physical_device, &actual_pdf2);
+
+        std::vector<std::string> error_list;
+        compare_feature_struct(sType, error_list, query_struct, features_struct);
+
+        if (error_list.empty()) {
+            extended_features_chain_.AddStructure(sType, struct_size, features_struct);
+            return true;
+        }
+    }
     return false;
 }
 
@@ -485,6 +489,10 @@ PhysicalDevice::operator VkPhysicalDevice() const { return this->physical_device
 
 // ---- Queues ---- //
 
+bool Device::IsExtensionEnabled(const char *extension) const {
+    return std::binary_search(std::begin(enabled_extensions_), std::end(enabled_extensions_), extension);
+}
+
 uint32_t Device::GetQueueIndex(QueueType type) const {
     uint32_t index = QUEUE_INDEX_MAX_VALUE;
     switch (type) {
@@ -620,6 +628,17 @@ Device DeviceBuilder::Build() const {
     local_features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     local_features2.features = physical_device.features;
 
+    // enabled features were collected on the physical device but never handed to vkCreateDevice
+    if (!user_defined_phys_dev_features_2) {
+        if (physical_device.instance_version_ >= VK_API_VERSION_1_1 || physical_device.properties2_ext_enabled_) {
+            final_pnext_chain.push_back(&local_features2);
+            for (auto &features_node: physical_device_extension_features_copy.GetPNextChainMembers()) {
+                final_pnext_chain.push_back(features_node);
+            }
+        } else {
+            device_create_info.pEnabledFeatures = &physical_device.features;
+        }
+    }
 
     for (auto &next: info.next_chain) {
         final_pnext_chain.push_back(next);
@@ -643,6 +662,11 @@ Device DeviceBuilder::Build() const {
     }
 
     device.physical_device = physical_device;
+    device.enabled_extensions_.assign(extensions_to_enable.begin(), extensions_to_enable.end());
+    std::sort(device.enabled_extensions_.begin(), device.enabled_extensions_.end());
+    if (!final_pnext_chain.empty() && final_pnext_chain.front() == &local_features2) {
+        device.enabled_features_chain_ = physical_device.extended_features_chain_;
+    }
     device.surface = physical_device.surface;
     device.queue_families = physical_device.queue_families_;
     device.allocation_callbacks = info.allocation_callbacks;
@@ -77,7 +77,7 @@ struct PhysicalDevice {
     // If the features from VkPhysicalDeviceFeatures are all present, make all of
     // the features be enable on the device. Returns true if all the features are
     // present.
-    bool EnableFeaturesIfPresent(const VkPhysicalDeviceFeatures &features_to_enable) const;
+    bool EnableFeaturesIfPresent(const VkPhysicalDeviceFeatures &features_to_enable);
 
     // If the features from the provided features struct are all present, make all
     // of the features be enable on the device. Returns true if all of the
@@ -301,11 +301,26 @@ struct Device {
     // Only a compute or transfer queue type is valid. All other queue types do not support a 'dedicated' queue
     VkQueue GetDedicatedQueue(QueueType type) const;
 
+    // Returns true if the extension was enabled when the device was created
+    bool IsExtensionEnabled(const char *extension) const;
+
+    // Returns true if all the true fields of `features` were enabled when the device was created
+    template<typename T>
+    bool AreExtensionFeaturesEnabled(T const &features) const {
+        return enabled_features_chain_.Match(static_cast<VkStructureType>(features.sType), &features);
+    }
+
     // A conversion function which allows this Device to be used
     // in places where VkDevice would have been used.
     explicit operator VkDevice() const;
 
 private:
+    // sorted, includes the swapchain extension when the device presents
+    std::vector<std::string> enabled_extensions_;
+    // the extension feature structs handed to vkCreateDevice, empty when the caller passed its own
+    // VkPhysicalDeviceFeatures2
+    FeatureChain enabled_features_chain_;
+
     struct {
         PFN_vkGetDeviceQueue fp_vkGetDeviceQueue = nullptr;
         PFN_vkDestroyDevice fp_vkDestroyDevice = nullptr;
@@ -4,20 +4,39 @@
 
 #include "draw_model.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
 #include <ostream>
 #include <vector>
 #include "functions.h"
+#include "render_graph.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <variant>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 namespace lvk {
-DrawModel::DrawModel(RenderContext &context) : context(context) {
+static constexpr const char *VERTEX_BUFFER_VERT = "../shaders/18_shader_vertexbuffer.vert";
+static constexpr const char *VERTEX_BUFFER_FRAG = "../shaders/18_shader_vertexbuffer.frag";
+static constexpr const char *UBO_VERT = "../shaders/22_shader_ubo.vert";
+static constexpr const char *UBO_FRAG = "../shaders/22_shader_ubo.frag";
+static constexpr const char *TEXTURE_VERT = "../shaders/26_shader_textures.vert";
+static constexpr const char *TEXTURE_FRAG = "../shaders/26_shader_textures.frag";
+// samples the BindlessTextureHeap with a texture index pushed per draw
+static constexpr const char *TEXTURE_BINDLESS_FRAG = "../shaders/26_shader_textures_bindless.frag";
+
+DrawModel::DrawModel(RenderContext &context) : context(context), transforms(&context.GetWorkers()) {
     // create_render_pass();
     render_pass = context.GetContext().GetDefaultRenderPass();
     // allocator = std::make_unique<Allocator>(context.GetContext());
+    // device local, Upload() goes through the context's upload manager
+    geometry_pool = std::make_unique<BufferPool>(context.GetAllocator(), &context.GetUploadManager(),
+                                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
 
     createDescriptorSet();
     AddDrawObject();
@@ -77,92 +96,82 @@ void DrawModel::load2() {
     // indices_buffer->Flush(0, indices_size);
 }
 
-void DrawModel::AddDrawObject() {
-    CreateGraphicsPipeline2();
-
+uint32_t DrawModel::AddDrawObject(const VertexFormat &format) {
+    // compiled on the pipeline compiler's workers, Draw() skips the object until it is ready
     auto draw_object = DrawObjectV2();
     // auto obj = static_cast<DrawObjectVector2>(draw_object);
     draw_object
-            .WithPipeline(graphics_pipeline)
-            .WithPipelineLayout(pipeline_layout);
+            .WithPipelineRequest(context.GetPipelineCompiler().Compile(uboPipelineDesc(format)))
+            .WithVertexFormat(format)
+            .WithTransform(transforms.Create());
 
     draw_objects.emplace_back(std::make_unique<DrawObjectV2>(std::move(draw_object)));
+    return draw_objects.back()->GetTransform();
 }
 
-void DrawModel::AddDrawTextureObject(const std::string &image_path) {
-    CreateGraphicsPipeline3("../shaders/textures.vert.spv", "../shaders/textures.frag.spv");
+uint32_t DrawModel::AddDrawTextureObject(const std::string &image_path, const VertexFormat &format) {
+    auto pipeline = context.GetPipelineCompiler().Compile(
+        texturePipelineDesc(TEXTURE_VERT, textureFrag(), format));
 
     auto texture = std::make_unique<Texture>(context);
     // texture->LoadImage("textures/texture.jpg");
-    texture->LoadImage(image_path);
+    // decoded on the texture loader's workers while the remaining objects are set up, resolved in LoadVertex()
+    texture->LoadImageAsync(image_path);
 
     auto draw_object = DrawObjectV3{};
     draw_object
-            .WithPipeline(graphics_pipeline)
-            .WithPipelineLayout(pipeline_layout)
-            .WithTexture(texture);
+            .WithPipelineRequest(pipeline)
+            .WithTexture(texture)
+            .WithVertexFormat(format)
+            .WithTransform(transforms.Create());
 
     draw_objects.emplace_back(std::make_unique<DrawObjectV3>(std::move(draw_object)));
+    return draw_objects.back()->GetTransform();
 }
 
-void DrawModel::LoadVertex() {
-    ubo_buffers.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
-    for (auto &ubo_buffer: ubo_buffers) {
-        ubo_buffer = context.GetAllocator().CreateBuffer2(sizeof(GlobalUbo),
-                                                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
-                                                          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                          VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-                                                          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-                                                          VMA_ALLOCATION_CREATE_MAPPED_BIT
-        );
-    }
-
-    int32_t index = 0;
-    for (auto const &object: draw_objects) {
-        uint32_t vertice_size = object->GetVertexDataSize();
-        uint32_t indices_size = object->GetIndicesDataSize();
-
-        vertex_buffers[index] = context.GetAllocator().CreateBuffer(vertice_size,
-                                                                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
-                                                                    VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                                    VMA_MEMORY_USAGE_CPU_TO_GPU);
-        indices_buffers[index] = context.GetAllocator().CreateBuffer(indices_size,
-                                                                     VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
-                                                                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                                     VMA_MEMORY_USAGE_CPU_TO_GPU);
-
-        //
-        vertex_buffers[index]->CopyData(vertice_size, const_cast<void *>(object->GetVertexData()));
-        vertex_buffers[index]->Flush(0, vertice_size);
+uint32_t DrawModel::AddDrawMesh(const std::string &mesh_path, const std::string &image_path,
+                                const VertexFormat &format) {
+    auto pipeline = context.GetPipelineCompiler().Compile(
+        texturePipelineDesc(TEXTURE_VERT, textureFrag(), format));
 
-        indices_buffers[index]->CopyData(indices_size, const_cast<void *>(object->GetIndicesData()));
-        indices_buffers[index]->Flush(0, indices_size);
+    auto texture = std::make_unique<Texture>(context);
+    texture->LoadImageAsync(image_path);
 
-        descriptor_sets[index].resize(descriptorSets.size());
+    // parsed or mapped alongside the texture decode, staged by the time LoadVertex() asks for it
+    auto draw_object = DrawObjectV3{};
+    draw_object
+            .WithPipelineRequest(pipeline)
+            .WithTexture(texture)
+            .WithVertexFormat(format)
+            .WithMesh(context.GetMeshLoader().Load(mesh_path, {format}))
+            .WithTransform(transforms.Create());
 
-        for (int i = 0; i < descriptorSets.size(); i++) {
-            auto bufferInfo = VkDescriptorBufferInfo{
-                ubo_buffers[i]->buffer,
-                0,
-                VK_WHOLE_SIZE
-                // ubo_buffers[i]->size,
-                // range
-            };
+    draw_objects.emplace_back(std::make_unique<DrawObjectV3>(std::move(draw_object)));
+    return draw_objects.back()->GetTransform();
+}
 
-            auto writer = DescriptorWriter(*descriptorSetLayout, *descriptorPool)
-                    .WriteBuffer(0, &bufferInfo);
+void DrawModel::LoadVertex() {
+    // all decodes were started in AddDrawTextureObject, wait for them here before writing image descriptors
+    for (auto const &object: draw_objects) {
+        if (object->HasTexture()) {
+            object->GetTexture().Resolve();
+        }
+    }
 
-            if (object->HasTexture()) {
-                auto &texture = object->GetTexture();
-                auto textureInfo = VkDescriptorImageInfo{
-                    texture.GetSampler(),
-                    texture.GetImageView(),
-                };
+    int32_t index = 0;
+    for (auto const &object: draw_objects) {
+        if (object->HasMesh()) {
+            // device local, copied by the upload manager ahead of the first frame's draws
+            auto const &mesh = object->UploadMesh(context.GetMeshLoader());
+            vertex_buffers[index] = mesh.vertices;
+            indices_buffers[index] = mesh.indices;
+        } else {
+            uint32_t vertice_size = object->GetVertexDataSize();
+            uint32_t indices_size = object->GetIndicesDataSize();
 
-                textureInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                writer.WriteImage(1, &textureInfo);
-            }
-            writer.Build(descriptor_sets[index][i]);
+            // sub-allocated from the shared geometry pool, bound with offsets in Draw()
+            vertex_buffers[index] = geometry_pool->Upload(object->GetVertexData(), vertice_size);
+            indices_buffers[index] = geometry_pool->Upload(object->GetIndicesData(), indices_size);
         }
 
         index++;
@@ -344,6 +353,27 @@ void DrawModel::LoadVertex() {
     // ubo_buffers[i]->Flush();
     // }
     // UpdateUniform(globalUbo);
+
+    // world matrices of the first Update(), later changes are copied in by Draw()
+    transforms.Update();
+    transform_buffers.resize(descriptorSets.size());
+    transform_capacity.assign(descriptorSets.size(), 0);
+    pending_transforms.assign(descriptorSets.size(), {});
+    for (uint32_t frame = 0; frame < descriptorSets.size(); frame++) {
+        syncTransforms(frame);
+    }
+
+    // the geometry is uploaded whole, Draw() picks the visible primitives' index ranges out of it
+    if (!primitives.empty()) {
+        Rect world = primitives[0].bounds;
+        for (auto const &primitive: primitives) {
+            world = world.Union(primitive.bounds);
+        }
+        primitive_index = std::make_unique<LooseQuadtree>(world);
+        for (uint32_t id = 0; id < primitives.size(); id++) {
+            primitive_index->Insert(id, primitives[id].bounds);
+        }
+    }
 }
 
 void DrawModel::LoadImage() {
@@ -412,49 +442,7 @@ void DrawModel::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width
 void DrawModel::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout,
                                       VkImageLayout newLayout) {
     VkCommandBuffer commandBuffer = context.BeginSingleTimeCommands();
-
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-
-    VkPipelineStageFlags sourceStage;
-    VkPipelineStageFlags destinationStage;
-
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout ==
-               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    } else {
-        throw std::invalid_argument("unsupported layout transition!");
-    }
-
-    vkCmdPipelineBarrier(
-        commandBuffer,
-        sourceStage, destinationStage,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier
-    );
-
+    RecordImageTransition(commandBuffer, image, format, oldLayout, newLayout);
     context.EndSingleTimeCommands(commandBuffer);
 }
 
@@ -488,32 +476,49 @@ void DrawModel::load() {
 }
 
 void DrawModel::Destroy() {
-    for (auto const &buffer: vertex_buffers) {
-        buffer.second->Destroy();
-    }
-    for (auto const &buffer: indices_buffers) {
-        buffer.second->Destroy();
+    // queued compiles still read the descriptor set layout destroyed below
+    context.GetPipelineCompiler().WaitIdle();
+
+    vertex_buffers.clear();
+    indices_buffers.clear();
+    geometry_pool->Destroy();
+    for (auto const &object: draw_objects) {
+        if (object->HasMesh()) {
+            context.GetMeshLoader().Free(object->GetMesh());
+        }
     }
     // texture->Destroy();
 
-    for (int i = 0; i < ubo_buffers.size(); i++) {
-        ubo_buffers[i]->Destroy();
+    vkDeviceWaitIdle(context.GetContext().device.device);
+    for (auto const &[index, sets]: descriptor_sets) {
+        for (auto set: sets) {
+            context.GetDescriptorSetCache().Release(set);
+        }
     }
+    descriptor_sets.clear();
 
-
-    descriptorPool->Cleanup();
+    for (auto const &transform_buffer: transform_buffers) {
+        if (transform_buffer) {
+            context.GetDescriptorSetCache().Invalidate(transform_buffer->buffer);
+            transform_buffer->Destroy();
+        }
+    }
+    transform_buffers.clear();
+    context.GetDescriptorSetCache().Invalidate(descriptorSetLayout->getDescriptorSetLayout());
     descriptorSetLayout->Cleanup();
+    primitive_index.reset();
 
-    vkDeviceWaitIdle(context.GetContext().device.device);
     for (auto const &object: draw_objects) {
         object->Cleanup();
-        vkDestroyPipeline(context.GetContext().device.device, object->GetPipeline(), nullptr);
-        vkDestroyPipelineLayout(context.GetContext().device.device, object->GetPipelineLayout(), nullptr);
+        object->WaitPipeline();
+        // the registry owns pipeline and layout, shared ones stay alive for the other objects
+        context.GetPipelineRegistry().Release(object->GetPipeline());
     }
 }
 
-void DrawModel::DrawTriangle(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec3 color) {
+uint32_t DrawModel::DrawTriangle(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec3 color) {
     auto &top = draw_objects.back();
+    uint32_t first_index = top->GetIndicesSize();
 
     // auto &object = dynamic_cast<DrawObjectVector2 &>(*top);
 
@@ -522,10 +527,12 @@ void DrawModel::DrawTriangle(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec3
         Vertex2(glm::vec3(p2.x, p2.y, 0.0f), color),
         Vertex2(glm::vec3(p3.x, p3.y, 0.0f), color)
     );
+    return addPrimitive({glm::min(glm::min(p1, p2), p3), glm::max(glm::max(p1, p2), p3)}, first_index);
 }
 
-void DrawModel::DrawRectangle(glm::vec2 pos, glm::vec2 size, glm::vec3 color) {
+uint32_t DrawModel::DrawRectangle(glm::vec2 pos, glm::vec2 size, glm::vec3 color) {
     auto &top = draw_objects.back();
+    uint32_t first_index = top->GetIndicesSize();
 
     top->AddRectangle(
         Vertex2(glm::vec3(pos.x, pos.y, 0.0f), color),
@@ -533,10 +540,12 @@ void DrawModel::DrawRectangle(glm::vec2 pos, glm::vec2 size, glm::vec3 color) {
         Vertex2(glm::vec3(pos.x + size.x, pos.y + size.y, 0.0f), color),
         Vertex2(glm::vec3(pos.x, pos.y + size.y, 0.0f), color)
     );
+    return addPrimitive({glm::min(pos, pos + size), glm::max(pos, pos + size)}, first_index);
 }
 
-void DrawModel::DrawRectangleUv(glm::vec2 pos, glm::vec2 size, glm::vec3 color) {
+uint32_t DrawModel::DrawRectangleUv(glm::vec2 pos, glm::vec2 size, glm::vec3 color) {
     auto &top = draw_objects.back();
+    uint32_t first_index = top->GetIndicesSize();
 
     // auto &object = reinterpret_cast<DrawObjectVector3 &>(top);
 
@@ -546,509 +555,350 @@ void DrawModel::DrawRectangleUv(glm::vec2 pos, glm::vec2 size, glm::vec3 color)
         Vertex3(glm::vec3(pos.x + size.x, pos.y + size.y, 0.0f), color, {0.0f, 1.0f}),
         Vertex3(glm::vec3(pos.x, pos.y + size.y, 0.0f), color, {1.0f, 1.0f})
     );
+    return addPrimitive({glm::min(pos, pos + size), glm::max(pos, pos + size)}, first_index);
+}
+
+void DrawModel::HitTest(glm::vec2 point, std::vector<uint32_t> &out) const {
+    if (primitive_index) {
+        primitive_index->QueryPoint(point, out);
+    }
+}
+
+void DrawModel::HitTest(const Rect &area, std::vector<uint32_t> &out) const {
+    if (primitive_index) {
+        primitive_index->Query(area, out);
+    }
 }
 
 void DrawModel::Draw() {
     assert(!draw_objects.empty() && "without draw objects");
     assert(!vertex_buffers.empty() && "init vertex buffer first");
 
-    // auto current_frame_ = context.image_index;
-    auto current_image_index = context.GetCurrentImageIndex();
+    // transform buffers and sets are per frame in flight, written once the frame's fence has signaled
+    auto current_frame = context.GetCurrentFrame();
     auto commandBuffer = context.GetCurrentCommandBuffer();
 
+    auto *bindless_heap = context.GetBindlessHeap();
+    VkPipeline bound_pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout bound_layout = VK_NULL_HANDLE;
+    VkDescriptorSet bound_set = VK_NULL_HANDLE;
+
+    // the sets read the GlobalUbo at a dynamic offset into the context's frame ring
+    auto ubo = context.GetFrameAllocator().PushUniform(&globalUbo, sizeof(GlobalUbo));
+    auto ubo_offset = static_cast<uint32_t>(ubo.offset);
+
+    stats = {};
+    auto start = std::chrono::steady_clock::now();
+    transforms.Update();
+    // every frame's buffer needs the changes, each catches up the next time its frame is drawn
+    auto transform_count = static_cast<uint32_t>(transforms.GetWorldMatrices().size());
+    for (auto &pending: pending_transforms) {
+        pending.Add(transforms.GetChanged(), transform_count);
+    }
+    syncTransforms(current_frame);
+    stats.transform_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    stats.primitives = static_cast<uint32_t>(primitives.size());
+    buildDrawRanges();
+    bool culling = cull && primitive_index;
+    stats.visible = culling ? static_cast<uint32_t>(visible_primitives.size()) : stats.primitives;
+
+    size_t range = 0;
     auto index = 0;
     for (auto const &object: draw_objects) {
-        VkBuffer vertexBuffers[] = {vertex_buffers[index]->buffer};
-        VkDeviceSize offsets[] = {0};
+        // this object's visible primitives are draw_ranges[first_range, range)
+        size_t first_range = range;
+        while (range < draw_ranges.size() && draw_ranges[range].object == static_cast<uint32_t>(index)) {
+            range++;
+        }
+        // primitive bounds are in object space, moved objects are drawn whole
+        bool culled = culling && static_cast<size_t>(index) < object_primitives.size() && object_primitives[index] > 0 &&
+                      transforms.GetWorld(object->GetTransform()) == glm::mat4(1.0f);
+        if (culled && first_range == range) {
+            index++;
+            continue;
+        }
+
+        if (!object->ResolvePipeline()) {
+            // still compiling, drawn from the first frame it is ready
+            index++;
+            continue;
+        }
+
+        auto const &vertex_slice = vertex_buffers[index];
+        auto const &index_slice = indices_buffers[index];
+        VkBuffer vertexBuffers[] = {vertex_slice.buffer};
+        VkDeviceSize offsets[] = {vertex_slice.offset};
 
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, object->GetPipeline());
+        if (object->GetPipeline() != bound_pipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, object->GetPipeline());
+            bound_pipeline = object->GetPipeline();
+        }
 
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 
-        vkCmdBindIndexBuffer(commandBuffer, indices_buffers[index]->buffer, 0, VK_INDEX_TYPE_UINT16);
+        vkCmdBindIndexBuffer(commandBuffer, index_slice.buffer, index_slice.offset, object->GetIndexType());
 
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, object->GetPipelineLayout(), 0, 1,
-                                &descriptor_sets[index][current_image_index], 0, nullptr);
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(object->GetIndicesSize()), 1, 0, 0, 0);
+        // objects sharing layout and set, e.g. all bindless textured ones, bind them once
+        auto layout = object->GetPipelineLayout();
+        auto set = descriptor_sets[index][current_frame];
+        if (layout != bound_layout || set != bound_set) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &set, 1,
+                                    &ubo_offset);
+        }
+        if (bindless_heap && object->HasTexture()) {
+            if (layout != bound_layout) {
+                auto heap_set = bindless_heap->GetSet();
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &heap_set, 0,
+                                        nullptr);
+            }
+            uint32_t texture_index = object->GetTexture().GetBindlessIndex();
+            vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(texture_index),
+                               &texture_index);
+        }
+        bound_layout = layout;
+        bound_set = set;
+
+        // the vertex shader reads the world matrix at gl_InstanceIndex, firstInstance carries the transform id
+        uint32_t transform = object->GetTransform();
+        if (culled) {
+            for (size_t i = first_range; i < range; i++) {
+                vkCmdDrawIndexed(commandBuffer, draw_ranges[i].index_count, 1, draw_ranges[i].first_index, 0,
+                                 transform);
+            }
+            stats.draws += static_cast<uint32_t>(range - first_range);
+        } else {
+            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(object->GetIndicesSize()), 1, 0, 0, transform);
+            stats.draws++;
+        }
 
         index++;
     }
 }
 
-void DrawModel::CreateGraphicsPipeline() {
-    auto vert_code = ReadFile("../shaders/vertbuffer.vert.spv");
-    auto frag_code = ReadFile("../shaders/vertbuffer.frag.spv");
+void DrawModel::PrintStats() const {
+    std::cout << "[DrawModel] " << stats.visible << " of " << stats.primitives << " primitives in " << stats.draws
+            << " draws, culled in " << stats.cull_ms << " ms, " << stats.transforms << " of "
+            << transforms.GetSize() << " transforms written in " << stats.transform_ms << " ms" << std::endl;
+}
+
+uint32_t DrawModel::addPrimitive(const Rect &bounds, uint32_t first_index) {
+    auto object = static_cast<uint32_t>(draw_objects.size() - 1);
+    object_primitives.resize(draw_objects.size());
+    object_primitives[object]++;
+    primitives.push_back({bounds, object, first_index, draw_objects.back()->GetIndicesSize() - first_index});
+    return static_cast<uint32_t>(primitives.size() - 1);
+}
 
-    VkShaderModule vert_module = CreateShaderModule(context.GetContext().device.device, vert_code);
-    VkShaderModule frag_module = CreateShaderModule(context.GetContext().device.device, frag_code);
-    if (vert_module == VK_NULL_HANDLE || frag_module == VK_NULL_HANDLE) {
-        throw std::runtime_error("failed to create shader module\n");
+void DrawModel::buildDrawRanges() {
+    draw_ranges.clear();
+    if (!cull || !primitive_index) {
+        return;
     }
 
-    VkPipelineShaderStageCreateInfo vert_stage_info = {};
-    vert_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vert_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vert_stage_info.module = vert_module;
-    vert_stage_info.pName = "main";
-
-    VkPipelineShaderStageCreateInfo frag_stage_info = {};
-    frag_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    frag_stage_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    frag_stage_info.module = frag_module;
-    frag_stage_info.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shader_stages[] = {vert_stage_info, frag_stage_info};
-
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex2);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(Vertex2, pos);
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(Vertex2, color);
-
-    VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
-    vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertex_input_info.vertexBindingDescriptionCount = 1;
-    vertex_input_info.vertexAttributeDescriptionCount = 2;
-    vertex_input_info.pVertexBindingDescriptions = &bindingDescription;
-    vertex_input_info.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
-    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    input_assembly.primitiveRestartEnable = VK_FALSE;
-
-    VkViewport viewport = {};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(context.GetContext().swapchain.extent.width);
-    viewport.height = static_cast<float>(context.GetContext().swapchain.extent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor = {};
-    scissor.offset = {0, 0};
-    scissor.extent = context.GetContext().swapchain.extent;
-
-    VkPipelineViewportStateCreateInfo viewport_state = {};
-    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewport_state.viewportCount = 1;
-    viewport_state.pViewports = &viewport;
-    viewport_state.scissorCount = 1;
-    viewport_state.pScissors = &scissor;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer = {};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    VkPipelineMultisampleStateCreateInfo multisampling = {};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-    colorBlendAttachment.colorWriteMask =
-            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo color_blending = {};
-    color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    color_blending.logicOpEnable = VK_FALSE;
-    color_blending.logicOp = VK_LOGIC_OP_COPY;
-    color_blending.attachmentCount = 1;
-    color_blending.pAttachments = &colorBlendAttachment;
-    color_blending.blendConstants[0] = 0.0f;
-    color_blending.blendConstants[1] = 0.0f;
-    color_blending.blendConstants[2] = 0.0f;
-    color_blending.blendConstants[3] = 0.0f;
-
-    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
-    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipeline_layout_info.setLayoutCount = 0;
-    pipeline_layout_info.pushConstantRangeCount = 0;
-
-    if (vkCreatePipelineLayout(context.GetContext().device.device, &pipeline_layout_info, nullptr, &pipeline_layout)
-        != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout\n");
+    auto start = std::chrono::steady_clock::now();
+    visible_primitives.clear();
+    primitive_index->Query(view_rect, visible_primitives);
+    // ids run in object and index order, sorted they line neighbouring primitives up into one range
+    std::sort(visible_primitives.begin(), visible_primitives.end());
+    for (auto id: visible_primitives) {
+        auto const &primitive = primitives[id];
+        if (!draw_ranges.empty() && draw_ranges.back().object == primitive.object &&
+            draw_ranges.back().first_index + draw_ranges.back().index_count == primitive.first_index) {
+            draw_ranges.back().index_count += primitive.index_count;
+        } else {
+            draw_ranges.push_back({primitive.object, primitive.first_index, primitive.index_count});
+        }
     }
+    stats.cull_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
-    std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
-
-    VkPipelineDynamicStateCreateInfo dynamic_info = {};
-    dynamic_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamic_info.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
-    dynamic_info.pDynamicStates = dynamic_states.data();
-
-    VkGraphicsPipelineCreateInfo pipeline_info = {};
-    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipeline_info.stageCount = 2;
-    pipeline_info.pStages = shader_stages;
-    pipeline_info.pVertexInputState = &vertex_input_info;
-    pipeline_info.pInputAssemblyState = &input_assembly;
-    pipeline_info.pViewportState = &viewport_state;
-    pipeline_info.pRasterizationState = &rasterizer;
-    pipeline_info.pMultisampleState = &multisampling;
-    pipeline_info.pColorBlendState = &color_blending;
-    pipeline_info.pDynamicState = &dynamic_info;
-    pipeline_info.layout = pipeline_layout;
-    pipeline_info.renderPass = render_pass;
-    pipeline_info.subpass = 0;
-    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
-
-    if (vkCreateGraphicsPipelines(context.GetContext().device.device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr,
-                                  &graphics_pipeline) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipline\n");
+void DrawModel::syncTransforms(uint32_t frame) {
+    auto const &world = transforms.GetWorldMatrices();
+    auto &buffer = transform_buffers[frame];
+    auto &pending = pending_transforms[frame];
+    auto count = static_cast<uint32_t>(world.size());
+    if (!buffer || count > transform_capacity[frame]) {
+        // the frame's sets point at the old buffer, nothing in flight reads either of them
+        if (buffer) {
+            for (auto &[index, sets]: descriptor_sets) {
+                context.GetDescriptorSetCache().Release(sets[frame]);
+            }
+            context.GetDescriptorSetCache().Invalidate(buffer->buffer);
+            buffer->Destroy();
+        }
+        transform_capacity[frame] = std::max({count, transform_capacity[frame] * 2, MIN_TRANSFORM_CAPACITY});
+        buffer = context.GetAllocator().CreateBuffer2(transform_capacity[frame] * sizeof(glm::mat4),
+                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                      VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                                      VMA_ALLOCATION_CREATE_MAPPED_BIT);
+        acquireDescriptorSets(frame);
+        // a new buffer starts out with everything
+        pending.Clear();
+        buffer->CopyData(count * sizeof(glm::mat4), (void *) world.data());
+        buffer->Flush();
+        stats.transforms = count;
+        return;
     }
 
-    vkDestroyShaderModule(context.GetContext().device.device, frag_module, nullptr);
-    vkDestroyShaderModule(context.GetContext().device.device, vert_module, nullptr);
+    if (!pending.all && pending.ids.empty()) {
+        return;
+    }
+    if (pending.all) {
+        buffer->CopyData(count * sizeof(glm::mat4), (void *) world.data());
+        stats.transforms = count;
+    } else {
+        auto *mapped = static_cast<glm::mat4 *>(buffer->GetMappedData());
+        for (auto id: pending.ids) {
+            memcpy(&mapped[id], &world[id], sizeof(glm::mat4));
+        }
+        stats.transforms = static_cast<uint32_t>(pending.ids.size());
+    }
+    buffer->Flush();
+    pending.Clear();
 }
 
-void DrawModel::CreateGraphicsPipeline2() {
-    auto vert_code = ReadFile("../shaders/ubo.vert.spv");
-    auto frag_code = ReadFile("../shaders/ubo.frag.spv");
-
-    VkShaderModule vert_module = CreateShaderModule(context.GetContext().device.device, vert_code);
-    VkShaderModule frag_module = CreateShaderModule(context.GetContext().device.device, frag_code);
-    if (vert_module == VK_NULL_HANDLE || frag_module == VK_NULL_HANDLE) {
-        throw std::runtime_error("failed to create shader module\n");
+void DrawModel::PendingTransforms::Add(const std::vector<uint32_t> &changed, uint32_t count) {
+    if (all) {
+        return;
+    }
+    // never shrunk, ids listed before a Destroy() may be past a smaller count
+    marked.resize(std::max<size_t>(marked.size(), count));
+    for (auto id: changed) {
+        if (!marked[id]) {
+            marked[id] = 1;
+            ids.push_back(id);
+        }
+    }
+    // past a quarter of the matrices one sequential copy beats the scattered ones
+    if (ids.size() > count / 4) {
+        Clear();
+        all = true;
     }
+}
 
-    VkPipelineShaderStageCreateInfo vert_stage_info = {};
-    vert_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vert_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vert_stage_info.module = vert_module;
-    vert_stage_info.pName = "main";
-
-    VkPipelineShaderStageCreateInfo frag_stage_info = {};
-    frag_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    frag_stage_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    frag_stage_info.module = frag_module;
-    frag_stage_info.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shader_stages[] = {vert_stage_info, frag_stage_info};
-
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex2);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    auto attributeDescriptions = Vertex2::GetAttributeDescriptions();
-
-    VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
-    vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertex_input_info.vertexBindingDescriptionCount = 1;
-    vertex_input_info.vertexAttributeDescriptionCount = attributeDescriptions.size();
-    vertex_input_info.pVertexBindingDescriptions = &bindingDescription;
-    vertex_input_info.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
-    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    input_assembly.primitiveRestartEnable = VK_FALSE;
-
-    VkViewport viewport = {};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(context.GetContext().swapchain.extent.width);
-    viewport.height = static_cast<float>(context.GetContext().swapchain.extent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor = {};
-    scissor.offset = {0, 0};
-    scissor.extent = context.GetContext().swapchain.extent;
-
-    VkPipelineViewportStateCreateInfo viewport_state = {};
-    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewport_state.viewportCount = 1;
-    viewport_state.pViewports = &viewport;
-    viewport_state.scissorCount = 1;
-    viewport_state.pScissors = &scissor;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer = {};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    VkPipelineMultisampleStateCreateInfo multisampling = {};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-    colorBlendAttachment.colorWriteMask =
-            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo color_blending = {};
-    color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    color_blending.logicOpEnable = VK_FALSE;
-    color_blending.logicOp = VK_LOGIC_OP_COPY;
-    color_blending.attachmentCount = 1;
-    color_blending.pAttachments = &colorBlendAttachment;
-    color_blending.blendConstants[0] = 0.0f;
-    color_blending.blendConstants[1] = 0.0f;
-    color_blending.blendConstants[2] = 0.0f;
-    color_blending.blendConstants[3] = 0.0f;
-
-    auto descriptor_set_Layout = descriptorSetLayout->getDescriptorSetLayout();
-    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
-    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipeline_layout_info.setLayoutCount = 1;
-    pipeline_layout_info.pSetLayouts = &descriptor_set_Layout;
-    // pipeline_layout_info.pushConstantRangeCount = 0;
-
-    if (vkCreatePipelineLayout(context.GetContext().device.device, &pipeline_layout_info, nullptr, &pipeline_layout)
-        != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout\n");
+void DrawModel::PendingTransforms::Clear() {
+    for (auto id: ids) {
+        marked[id] = 0;
     }
+    ids.clear();
+    all = false;
+}
 
-    std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
-
-    VkPipelineDynamicStateCreateInfo dynamic_info = {};
-    dynamic_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamic_info.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
-    dynamic_info.pDynamicStates = dynamic_states.data();
-
-    VkGraphicsPipelineCreateInfo pipeline_info = {};
-    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipeline_info.stageCount = 2;
-    pipeline_info.pStages = shader_stages;
-    pipeline_info.pVertexInputState = &vertex_input_info;
-    pipeline_info.pInputAssemblyState = &input_assembly;
-    pipeline_info.pViewportState = &viewport_state;
-    pipeline_info.pRasterizationState = &rasterizer;
-    pipeline_info.pMultisampleState = &multisampling;
-    pipeline_info.pColorBlendState = &color_blending;
-    pipeline_info.pDynamicState = &dynamic_info;
-    pipeline_info.layout = pipeline_layout;
-    pipeline_info.renderPass = render_pass;
-    pipeline_info.subpass = 0;
-    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
-
-    if (vkCreateGraphicsPipelines(context.GetContext().device.device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr,
-                                  &graphics_pipeline) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipline\n");
+void DrawModel::acquireDescriptorSets(uint32_t frame) {
+    auto transformInfo = VkDescriptorBufferInfo{transform_buffers[frame]->buffer, 0, VK_WHOLE_SIZE};
+    // the same for every frame, Draw() passes the offset of the frame's copy
+    auto bufferInfo = VkDescriptorBufferInfo{context.GetFrameAllocator().GetBuffer(), 0, sizeof(GlobalUbo)};
+
+    for (uint32_t index = 0; index < draw_objects.size(); index++) {
+        auto const &object = draw_objects[index];
+        auto writer = DescriptorWriter(*descriptorSetLayout, context.GetDescriptorPoolManager())
+                .WriteBuffer(0, &bufferInfo)
+                .WriteBuffer(2, &transformInfo);
+
+        // with a bindless heap the texture is picked by index in Draw(), every set is the same
+        VkDescriptorImageInfo textureInfo{};
+        if (object->HasTexture() && !context.GetBindlessHeap()) {
+            auto &texture = object->GetTexture();
+            textureInfo = VkDescriptorImageInfo{
+                texture.GetSampler(),
+                texture.GetImageView(),
+            };
+
+            textureInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            writer.WriteImage(1, &textureInfo);
+        }
+        // untextured objects all bind the same ubo, they end up sharing one set per frame
+        descriptor_sets[index].resize(descriptorSets.size());
+        descriptor_sets[index][frame] = context.GetDescriptorSetCache().Acquire(writer);
     }
+}
 
-    vkDestroyShaderModule(context.GetContext().device.device, frag_module, nullptr);
-    vkDestroyShaderModule(context.GetContext().device.device, vert_module, nullptr);
+GraphicsPipelineDesc DrawModel::defaultPipelineDesc(const std::string &vert_file, const std::string &frag_file) const {
+    GraphicsPipelineDesc desc{};
+    desc.vert_file = vert_file;
+    desc.frag_file = frag_file;
+    desc.render_pass = render_pass;
+    desc.subpass = 0;
+    desc.color_formats = {context.GetContext().swapchain.image_format};
+    return desc;
 }
 
+void DrawModel::reflectPipeline(GraphicsPipelineDesc &desc, const VertexPacker &packer) const {
+    // locations come from the shader, formats and offsets from the uploaded vertex layout
+    auto reflection = context.GetPipelineRegistry().Reflect({desc.vert_file, desc.frag_file});
+    desc.bindings = {{0, packer.GetStride(), VK_VERTEX_INPUT_RATE_VERTEX}};
+    desc.attributes = reflection.GetAttributeDescriptions(0);
+    packer.ApplyFormats(desc.attributes);
+    desc.push_constants = reflection.GetPushConstants();
+}
 
-void DrawModel::CreateGraphicsPipeline3(const std::string &vert_file, const std::string &frag_file) {
-    auto vert_code = ReadFile(vert_file);
-    auto frag_code = ReadFile(frag_file);
+void DrawModel::acquirePipeline(const GraphicsPipelineDesc &desc) {
+    auto handle = context.GetPipelineRegistry().Acquire(desc);
+    graphics_pipeline = handle.pipeline;
+    pipeline_layout = handle.layout;
+}
 
-    VkShaderModule vert_module = CreateShaderModule(context.GetContext().device.device, vert_code);
-    VkShaderModule frag_module = CreateShaderModule(context.GetContext().device.device, frag_code);
-    if (vert_module == VK_NULL_HANDLE || frag_module == VK_NULL_HANDLE) {
-        throw std::runtime_error("failed to create shader module\n");
-    }
+void DrawModel::CreateGraphicsPipeline() {
+    auto desc = defaultPipelineDesc(VERTEX_BUFFER_VERT, VERTEX_BUFFER_FRAG);
+    reflectPipeline(desc, VertexPacker::ForVertex2({}));
 
-    VkPipelineShaderStageCreateInfo vert_stage_info = {};
-    vert_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vert_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vert_stage_info.module = vert_module;
-    vert_stage_info.pName = "main";
-
-    VkPipelineShaderStageCreateInfo frag_stage_info = {};
-    frag_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    frag_stage_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    frag_stage_info.module = frag_module;
-    frag_stage_info.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shader_stages[] = {vert_stage_info, frag_stage_info};
-
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex3);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(Vertex3, pos);
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(Vertex3, color);
-    attributeDescriptions[2].binding = 0;
-    attributeDescriptions[2].location = 2;
-    attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[2].offset = offsetof(Vertex3, uv);
-
-    VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
-    vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertex_input_info.vertexBindingDescriptionCount = 1;
-    vertex_input_info.pVertexBindingDescriptions = &bindingDescription;
-    vertex_input_info.vertexAttributeDescriptionCount = attributeDescriptions.size();
-    vertex_input_info.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
-    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    input_assembly.primitiveRestartEnable = VK_FALSE;
-
-    VkViewport viewport = {};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(context.GetContext().swapchain.extent.width);
-    viewport.height = static_cast<float>(context.GetContext().swapchain.extent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor = {};
-    scissor.offset = {0, 0};
-    scissor.extent = context.GetContext().swapchain.extent;
-
-    VkPipelineViewportStateCreateInfo viewport_state = {};
-    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewport_state.viewportCount = 1;
-    viewport_state.pViewports = &viewport;
-    viewport_state.scissorCount = 1;
-    viewport_state.pScissors = &scissor;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer = {};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    VkPipelineMultisampleStateCreateInfo multisampling = {};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-    colorBlendAttachment.colorWriteMask =
-            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo color_blending = {};
-    color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    color_blending.logicOpEnable = VK_FALSE;
-    color_blending.logicOp = VK_LOGIC_OP_COPY;
-    color_blending.attachmentCount = 1;
-    color_blending.pAttachments = &colorBlendAttachment;
-    color_blending.blendConstants[0] = 0.0f;
-    color_blending.blendConstants[1] = 0.0f;
-    color_blending.blendConstants[2] = 0.0f;
-    color_blending.blendConstants[3] = 0.0f;
-
-    auto descriptor_set_Layout = descriptorSetLayout->getDescriptorSetLayout();
-    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
-    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipeline_layout_info.setLayoutCount = 1;
-    pipeline_layout_info.pSetLayouts = &descriptor_set_Layout;
-    // pipeline_layout_info.pushConstantRangeCount = 0;
-
-    if (vkCreatePipelineLayout(context.GetContext().device.device, &pipeline_layout_info, nullptr, &pipeline_layout)
-        != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout\n");
-    }
+    acquirePipeline(desc);
+}
 
-    std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
-
-    VkPipelineDynamicStateCreateInfo dynamic_info = {};
-    dynamic_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamic_info.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
-    dynamic_info.pDynamicStates = dynamic_states.data();
-
-    VkGraphicsPipelineCreateInfo pipeline_info = {};
-    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipeline_info.stageCount = 2;
-    pipeline_info.pStages = shader_stages;
-    pipeline_info.pVertexInputState = &vertex_input_info;
-    pipeline_info.pInputAssemblyState = &input_assembly;
-    pipeline_info.pViewportState = &viewport_state;
-    pipeline_info.pRasterizationState = &rasterizer;
-    pipeline_info.pMultisampleState = &multisampling;
-    pipeline_info.pColorBlendState = &color_blending;
-    pipeline_info.pDynamicState = &dynamic_info;
-    pipeline_info.layout = pipeline_layout;
-    pipeline_info.renderPass = render_pass;
-    pipeline_info.subpass = 0;
-    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
-
-    if (vkCreateGraphicsPipelines(context.GetContext().device.device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr,
-                                  &graphics_pipeline) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipline\n");
+GraphicsPipelineDesc DrawModel::uboPipelineDesc(const VertexFormat &format) const {
+    auto desc = defaultPipelineDesc(UBO_VERT, UBO_FRAG);
+    reflectPipeline(desc, VertexPacker::ForVertex2(format));
+    desc.set_layouts = {descriptorSetLayout->getDescriptorSetLayout()};
+    return desc;
+}
+
+GraphicsPipelineDesc DrawModel::texturePipelineDesc(const std::string &vert_file, const std::string &frag_file,
+                                                    const VertexFormat &format) const {
+    auto desc = defaultPipelineDesc(vert_file, frag_file);
+    reflectPipeline(desc, VertexPacker::ForVertex3(format));
+    desc.set_layouts = {descriptorSetLayout->getDescriptorSetLayout()};
+    if (auto *heap = context.GetBindlessHeap()) {
+        desc.set_layouts.push_back(heap->GetLayout());
     }
+    return desc;
+}
 
-    vkDestroyShaderModule(context.GetContext().device.device, frag_module, nullptr);
-    vkDestroyShaderModule(context.GetContext().device.device, vert_module, nullptr);
+const char *DrawModel::textureFrag() const {
+    return context.GetBindlessHeap() ? TEXTURE_BINDLESS_FRAG : TEXTURE_FRAG;
 }
 
-void DrawModel::UpdateUniform(GlobalUbo &ubo) {
-    for (int i = 0; i < ubo_buffers.size(); i++) {
-        ubo_buffers[i]->CopyData(sizeof(GlobalUbo), (void *) &ubo);
-        ubo_buffers[i]->Flush();
-    }
+void DrawModel::CreateGraphicsPipeline2() {
+    acquirePipeline(uboPipelineDesc());
 }
 
-void DrawModel::UpdateUniform2(VkCommandBuffer command_buffer, GlobalUbo &ubo) {
-    for (int i = 0; i < ubo_buffers.size(); i++) {
-        ubo_buffers[i]->CopyData(sizeof(GlobalUbo), (void *) &ubo);
-        ubo_buffers[i]->Flush();
-
-        VkBufferMemoryBarrier bufMemBarrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
-        bufMemBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-        bufMemBarrier.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT;
-        bufMemBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        bufMemBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        bufMemBarrier.buffer = ubo_buffers[i]->buffer;
-        bufMemBarrier.offset = 0;
-        bufMemBarrier.size = VK_WHOLE_SIZE;
-
-        // It's important to insert a buffer memory barrier here to ensure writing to the buffer has finished.
-        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-                             0, 0, nullptr, 1, &bufMemBarrier, 0, nullptr);
-    }
+
+void DrawModel::CreateGraphicsPipeline3(const std::string &vert_file, const std::string &frag_file) {
+    acquirePipeline(texturePipelineDesc(vert_file, frag_file));
+}
+
+void DrawModel::UpdateUniform(GlobalUbo &ubo) {
+    // pushed into the frame ring by Draw()
+    globalUbo = ubo;
 }
 
 
 void DrawModel::createDescriptorSet() {
-    descriptorPool =
-            DescriptorPool::Builder(context.GetContext().device)
-            .SetMaxSets(Swapchain::MAX_FRAMES_IN_FLIGHT * 6)
-            .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, Swapchain::MAX_FRAMES_IN_FLIGHT * 3)
-            .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, Swapchain::MAX_FRAMES_IN_FLIGHT * 3)
-            .Build();
-
-    descriptorSetLayout =
-            DescriptorSetLayout::Builder(context.GetContext().device)
-            .AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
-            .AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-            .Build();
+    // one set 0 layout for every pipeline of the model: the union of what their shaders declare.
+    // Set 1 of the bindless texture shader is the heap's own layout.
+    auto reflection = context.GetPipelineRegistry().Reflect({UBO_VERT, UBO_FRAG, TEXTURE_VERT, textureFrag()});
+
+    // sets come from the context's DescriptorPoolManager, which grows its pools with the scene
+    auto layout_builder = DescriptorSetLayout::Builder(context.GetContext().device);
+    for (auto const &binding: reflection.GetSetBindings(0)) {
+        // the GlobalUbo lives in the frame ring, a new offset each frame
+        auto type = binding.binding == 0 && binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+                        ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+                        : binding.descriptorType;
+        layout_builder.AddBinding(binding.binding, type, binding.stageFlags, binding.descriptorCount);
+    }
+    descriptorSetLayout = layout_builder.Build();
 
     descriptorSets.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
 }
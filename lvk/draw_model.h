@@ -13,6 +13,8 @@
 #include "render_context.h"
 #include "descriptor.h"
 #include "draw_object.h"
+#include "quadtree.h"
+#include "transform_hierarchy.h"
 #include "Vertex.h"
 
 namespace lvk {
@@ -21,6 +23,15 @@ struct GlobalUbo {
     glm::mat4 mvp{1.f};
 };
 
+struct DrawModelStats {
+    uint32_t primitives = 0;
+    uint32_t visible = 0; // primitives submitted, all of them without a view rect
+    uint32_t draws = 0;
+    double cull_ms = 0.0; // quadtree query and range merge
+    uint32_t transforms = 0; // world matrices written to this frame's transform buffer
+    double transform_ms = 0.0; // TransformHierarchy::Update() and the buffer writes
+};
+
 class DrawModel {
 public:
     explicit DrawModel(RenderContext &context);
@@ -29,9 +40,22 @@ public:
 
     void load2();
 
-    void AddDrawObject();
+    // Each returns the object's transform id in GetTransforms(), a root with the identity transform
+    // until it is moved or parented.
+
+    // Objects drawn with a packed VertexFormat get their own pipeline variant.
+    uint32_t AddDrawObject(const VertexFormat &format = {});
+
+    uint32_t AddDrawTextureObject(const std::string &image_path, const VertexFormat &format = {});
 
-    void AddDrawTextureObject(const std::string &image_path);
+    // A textured mesh loaded on the MeshLoader's workers, .lmsh files from mesh_cook carry their own
+    // format and `format` has to match it.
+    uint32_t AddDrawMesh(const std::string &mesh_path, const std::string &image_path,
+                         const VertexFormat &format = {});
+
+    // Updated on the context's workers by Draw(), which copies the world matrices that changed into
+    // the frame's transform buffer, read by the vertex shaders at the object's transform id.
+    [[nodiscard]] TransformHierarchy &GetTransforms() { return transforms; }
 
     void LoadVertex();
 
@@ -43,12 +67,29 @@ public:
 
     void Destroy();
 
-    void DrawTriangle(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec3 color);
-    void DrawRectangle(glm::vec2 pos, glm::vec2 size, glm::vec3 color);
-    void DrawRectangleUv(glm::vec2 pos, glm::vec2 size, glm::vec3 color);
+    // Add a primitive to the last draw object and return its id for HitTest().
+    uint32_t DrawTriangle(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::vec3 color);
+    uint32_t DrawRectangle(glm::vec2 pos, glm::vec2 size, glm::vec3 color);
+    uint32_t DrawRectangleUv(glm::vec2 pos, glm::vec2 size, glm::vec3 color);
+
+    // The world space area the camera shows. Once set, Draw() only submits the primitives whose
+    // bounds overlap it, found through a LooseQuadtree built by LoadVertex(); mesh objects and
+    // objects whose transform is not the identity are always drawn.
+    void SetViewRect(const Rect &rect) {
+        view_rect = rect;
+        cull = true;
+    }
+
+    // Ids of the primitives whose bounds contain `point` / overlap `area`, after LoadVertex().
+    void HitTest(glm::vec2 point, std::vector<uint32_t> &out) const;
+    void HitTest(const Rect &area, std::vector<uint32_t> &out) const;
 
     void Draw();
 
+    [[nodiscard]] const DrawModelStats &GetStats() const { return stats; }
+
+    void PrintStats() const;
+
     void create_render_pass();
 
     void CreateGraphicsPipeline();
@@ -57,10 +98,9 @@ public:
 
     void CreateGraphicsPipeline3(const std::string &vert_file, const std::string &frag_file);
 
+    // Kept until the next call, Draw() copies it into the frame ring.
     void UpdateUniform(GlobalUbo &ubo);
 
-    void UpdateUniform2(VkCommandBuffer command_buffer, GlobalUbo &ubo);
-
 
     // VulkanContext &context;
     RenderContext &context;
@@ -74,8 +114,62 @@ public:
 private:
     void createDescriptorSet();
 
+    [[nodiscard]] GraphicsPipelineDesc defaultPipelineDesc(const std::string &vert_file,
+                                                           const std::string &frag_file) const;
+
+    void reflectPipeline(GraphicsPipelineDesc &desc, const VertexPacker &packer) const;
+
+    void acquirePipeline(const GraphicsPipelineDesc &desc);
+
+    [[nodiscard]] GraphicsPipelineDesc uboPipelineDesc(const VertexFormat &format = {}) const;
+
+    [[nodiscard]] GraphicsPipelineDesc texturePipelineDesc(const std::string &vert_file,
+                                                           const std::string &frag_file,
+                                                           const VertexFormat &format = {}) const;
+
+    // the bindless variant when the context has a BindlessTextureHeap
+    [[nodiscard]] const char *textureFrag() const;
+
+    struct DrawPrimitive {
+        Rect bounds;
+        uint32_t object;
+        uint32_t first_index;
+        uint32_t index_count;
+    };
+
+    // consecutive visible primitives of one object, drawn with one vkCmdDrawIndexed
+    struct DrawRange {
+        uint32_t object;
+        uint32_t first_index;
+        uint32_t index_count;
+    };
+
+    uint32_t addPrimitive(const Rect &bounds, uint32_t first_index);
+
+    // fills draw_ranges with the primitives overlapping view_rect, in object and index order
+    void buildDrawRanges();
+
+    // Ids changed since a frame's buffer was last written, each listed once however many frames
+    // go by without that frame being drawn. Past a quarter of the matrices the list is dropped
+    // for `all`, the next sync copies everything anyway.
+    struct PendingTransforms {
+        std::vector<uint32_t> ids;
+        std::vector<uint8_t> marked; // by id
+        bool all = false;
+
+        void Add(const std::vector<uint32_t> &changed, uint32_t count);
+
+        void Clear();
+    };
+
+    // brings the frame's transform buffer up to date, growing it re-acquires the frame's sets
+    void syncTransforms(uint32_t frame);
+
+    void acquireDescriptorSets(uint32_t frame);
+
+    static constexpr uint32_t MIN_TRANSFORM_CAPACITY = 64;
+
     std::unique_ptr<DescriptorSetLayout> descriptorSetLayout;
-    std::unique_ptr<DescriptorPool> descriptorPool;
     std::vector<VkDescriptorSet> descriptorSets;
 
     // std::vector<Vertex> vertices{};
@@ -83,16 +177,31 @@ private:
 
     std::vector<std::unique_ptr<BaseDrawObject>> draw_objects{};
 
+    // ids are assigned in the order primitives are added, which is also object and index order
+    std::vector<DrawPrimitive> primitives;
+    std::vector<uint32_t> object_primitives; // primitive count of each draw object
+    std::unique_ptr<LooseQuadtree> primitive_index;
+    Rect view_rect{};
+    bool cull = false;
+    std::vector<uint32_t> visible_primitives;
+    std::vector<DrawRange> draw_ranges;
+    DrawModelStats stats{};
+
     GlobalUbo globalUbo{};
 
 
     // std::unique_ptr<Allocator> allocator;
     //
-    std::unordered_map<uint32_t, std::unique_ptr<Buffer>> vertex_buffers;
-    std::unordered_map<uint32_t, std::unique_ptr<Buffer>> indices_buffers;
+    std::unique_ptr<BufferPool> geometry_pool;
+    std::unordered_map<uint32_t, BufferSlice> vertex_buffers;
+    std::unordered_map<uint32_t, BufferSlice> indices_buffers;
     std::unordered_map<uint32_t, std::vector<VkDescriptorSet>> descriptor_sets;
-    //
-    std::vector<std::unique_ptr<Buffer> > ubo_buffers;
+
+    TransformHierarchy transforms;
+    // by frame, with the ids changed since the frame's buffer was last written
+    std::vector<std::unique_ptr<Buffer> > transform_buffers;
+    std::vector<uint32_t> transform_capacity; // in matrices
+    std::vector<PendingTransforms> pending_transforms;
     // std::unique_ptr<Image> texture{};
 };
 
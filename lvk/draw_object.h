@@ -4,13 +4,18 @@
 
 #ifndef LYH_DRAW_OBJECT_H
 #define LYH_DRAW_OBJECT_H
+#include <stdexcept>
 #include <variant>
 #include <vector>
 #include <glm/vec3.hpp>
 
 #include "image.h"
+#include "pipeline_compiler.h"
 #include "Texture.h"
+#include "mesh_loader.h"
+#include "mesh_optimizer.h"
 #include "Vertex.h"
+#include "vertex_format.h"
 
 namespace lvk {
 struct BaseDrawObject {
@@ -32,13 +37,40 @@ struct BaseDrawObject {
         return *this;
     };
 
+    // Pipeline and layout are taken from the request once it has been compiled.
+    BaseDrawObject &WithPipelineRequest(PipelineRequest request) {
+        pipeline_request = std::move(request);
+        return *this;
+    };
+
     BaseDrawObject &WithTexture(std::unique_ptr<Texture> &p_texture) {
         texture = std::move(p_texture);
         return *this;
     };
 
+    // Precision the vertices are uploaded with, the pipeline's vertex input has to use the same.
+    BaseDrawObject &WithVertexFormat(const VertexFormat &format) {
+        vertex_format = format;
+        clearPacked();
+        return *this;
+    };
+
+    // Geometry loaded by the MeshLoader, uploaded with UploadMesh() instead of the triangles
+    // added below. The request's format has to match WithVertexFormat().
+    BaseDrawObject &WithMesh(MeshRequest request) {
+        mesh_request = std::move(request);
+        return *this;
+    };
+
+    // Id in the model's TransformHierarchy, the vertex shader picks the world matrix with it.
+    BaseDrawObject &WithTransform(uint32_t id) {
+        transform = id;
+        return *this;
+    };
+
     void AddTriangle(const Vertex2 &t1, const Vertex2 &t2, const Vertex2 &t3) {
         uint32_t size = vertexes2.size();
+        clearPacked();
         vertexes2.emplace_back(t1);
         vertexes2.emplace_back(t2);
         vertexes2.emplace_back(t3);
@@ -50,6 +82,7 @@ struct BaseDrawObject {
 
     void AddTriangle(const Vertex3 &t1, const Vertex3 &t2, const Vertex3 &t3) {
         uint32_t size = vertexes3.size();
+        clearPacked();
         vertexes3.emplace_back(t1);
         vertexes3.emplace_back(t2);
         vertexes3.emplace_back(t3);
@@ -62,6 +95,7 @@ struct BaseDrawObject {
 
     void AddRectangle(const Vertex2 &t1, const Vertex2 &t2, const Vertex2 &t3, const Vertex2 &t4) {
         uint32_t size = vertexes2.size();
+        clearPacked();
         vertexes2.emplace_back(t1);
         vertexes2.emplace_back(t2);
         vertexes2.emplace_back(t3);
@@ -77,6 +111,7 @@ struct BaseDrawObject {
 
     void AddRectangle(const Vertex3 &t1, const Vertex3 &t2, const Vertex3 &t3, const Vertex3 &t4) {
         uint32_t size = vertexes3.size();
+        clearPacked();
         vertexes3.emplace_back(t1);
         vertexes3.emplace_back(t2);
         vertexes3.emplace_back(t3);
@@ -93,30 +128,83 @@ struct BaseDrawObject {
     virtual ~BaseDrawObject() = default;
 
 
+    // In the object's VertexFormat.
     virtual const void *GetVertexData() const = 0;
 
     virtual uint32_t GetVertexDataSize() const = 0;
 
+    virtual uint32_t GetVertexCount() const = 0;
+
+    const VertexFormat &GetVertexFormat() const { return vertex_format; };
+
+    // uint16 up to 65536 vertices, uint32 past that
+    VkIndexType GetIndexType() const {
+        return HasMesh() ? gpu_mesh.index_type : SelectIndexType(GetVertexCount());
+    };
+
+    // In GetIndexType().
     const void *GetIndicesData() const {
         assert(!indices.empty() && "indices is empty");
-        return indices.data();
+        if (GetIndexType() == VK_INDEX_TYPE_UINT32) {
+            return indices.data();
+        }
+        if (indices16.empty()) {
+            indices16.assign(indices.begin(), indices.end());
+        }
+        return indices16.data();
     };
 
     uint32_t GetIndicesDataSize() const {
         assert(!indices.empty() && "indices is empty");
-        return indices.size() * sizeof(uint16_t);
+        return indices.size() * (GetIndexType() == VK_INDEX_TYPE_UINT32 ? sizeof(uint32_t) : sizeof(uint16_t));
+    };
+
+    uint32_t GetIndicesSize() const { return HasMesh() ? gpu_mesh.index_count : indices.size(); };
+
+    bool HasMesh() const { return mesh_request.valid(); };
+
+    // Waits for the mesh and queues its copy into the loader's geometry buffers.
+    const GpuMesh &UploadMesh(MeshLoader &loader) {
+        auto const &mesh = mesh_request.get();
+        if (mesh.format != vertex_format) {
+            throw std::runtime_error("failed to upload mesh, its vertex format differs from the object's!");
+        }
+        gpu_mesh = loader.Upload(mesh);
+        return gpu_mesh;
     };
 
-    uint32_t GetIndicesSize() const { return indices.size(); };
+    const GpuMesh &GetMesh() const { return gpu_mesh; };
 
     bool HasTexture() const { return texture != nullptr; };
 
+    uint32_t GetTransform() const { return transform; };
+
     Texture &GetTexture() const { return *texture; };
 
     VkPipeline GetPipeline() const { return graphics_pipeline; };
 
     VkPipelineLayout GetPipelineLayout() const { return pipeline_layout; };
 
+    // Picks up the compiled pipeline without blocking, false while it is still being compiled.
+    bool ResolvePipeline() {
+        if (pipeline_request.valid() && PipelineCompiler::IsReady(pipeline_request)) {
+            PipelineRequest request = std::move(pipeline_request);
+            pipeline_request = {};
+            auto handle = request.get();
+            graphics_pipeline = handle.pipeline;
+            pipeline_layout = handle.layout;
+        }
+        return graphics_pipeline != VK_NULL_HANDLE;
+    };
+
+    // Blocking variant, for teardown.
+    void WaitPipeline() {
+        if (pipeline_request.valid()) {
+            pipeline_request.wait();
+            ResolvePipeline();
+        }
+    };
+
     void Cleanup() const {
         if (texture) {
             texture->Destroy();
@@ -124,13 +212,43 @@ struct BaseDrawObject {
     };
 
 protected:
+    // Full format vertices are uploaded as they are, others are packed once on first use.
+    template<typename V>
+    const void *vertexData(const std::vector<V> &vertexes, const VertexPacker &packer) const {
+        assert(!vertexes.empty() && "vertexes is empty");
+        if (vertex_format.IsFull()) {
+            return vertexes.data();
+        }
+        if (packed_vertexes.empty()) {
+            packed_vertexes.resize(static_cast<size_t>(packer.GetStride()) * vertexes.size());
+            packer.Pack(vertexes.data(), vertexes.size(), packed_vertexes.data());
+        }
+        return packed_vertexes.data();
+    };
+
+    void clearPacked() {
+        packed_vertexes.clear();
+        indices16.clear();
+    };
+
     VkPipeline graphics_pipeline{};
     VkPipelineLayout pipeline_layout{};
+    PipelineRequest pipeline_request{};
 
     std::vector<Vertex2> vertexes2{};
     std::vector<Vertex3> vertexes3{};
 
-    std::vector<uint16_t> indices{};
+    // built at full width, narrowed to indices16 when uploaded as uint16
+    std::vector<uint32_t> indices{};
+    mutable std::vector<uint16_t> indices16{};
+
+    VertexFormat vertex_format{};
+    mutable std::vector<uint8_t> packed_vertexes{};
+
+    MeshRequest mesh_request{};
+    GpuMesh gpu_mesh{};
+
+    uint32_t transform = 0;
 
     // VkImageView view = VK_NULL_HANDLE;
     std::unique_ptr<Texture> texture{};
@@ -138,25 +256,27 @@ protected:
 
 class DrawObjectV2 : public BaseDrawObject {
     const void *GetVertexData() const override {
-        assert(!vertexes2.empty() && "vertexes is empty");
-        return vertexes2.data();
+        return vertexData(vertexes2, VertexPacker::ForVertex2(vertex_format));
     };
 
     uint32_t GetVertexDataSize() const override {
-        return vertexes2.size() * sizeof(Vertex2);
+        return vertexes2.size() * VertexPacker::ForVertex2(vertex_format).GetStride();
     };
 
+    uint32_t GetVertexCount() const override { return vertexes2.size(); };
+
 };
 
 class DrawObjectV3 : public BaseDrawObject {
     const void *GetVertexData() const override {
-        assert(!vertexes3.empty() && "vertexes is empty");
-        return vertexes3.data();
+        return vertexData(vertexes3, VertexPacker::ForVertex3(vertex_format));
     };
 
     uint32_t GetVertexDataSize() const override {
-        return vertexes3.size() * sizeof(Vertex3);
+        return vertexes3.size() * VertexPacker::ForVertex3(vertex_format).GetStride();
     };
+
+    uint32_t GetVertexCount() const override { return vertexes3.size(); };
 };
 
 /*
@@ -0,0 +1,91 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "frame_ring_allocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace lvk {
+static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+FrameRingAllocator::FrameRingAllocator(Allocator &allocator, VkDeviceSize frame_size_, uint32_t frame_count_)
+    : frame_count(frame_count_) {
+    auto const &limits = allocator.GetLimits();
+    uniform_alignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 16);
+    // keep every region start aligned so offsets handed out stay valid for dynamic UBO binding
+    frame_size = align_up(frame_size_, std::max<VkDeviceSize>(uniform_alignment, limits.nonCoherentAtomSize));
+
+    buffer = allocator.CreateBuffer2(frame_size * frame_count,
+                                     VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                     VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                     VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                                     VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                     VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+    mapped = static_cast<uint8_t *>(buffer->GetMappedData());
+    if (mapped == nullptr) {
+        throw std::runtime_error("failed to map frame ring buffer!");
+    }
+}
+
+void FrameRingAllocator::Destroy() const {
+    buffer->Destroy();
+}
+
+void FrameRingAllocator::BeginFrame(uint32_t frame_index_) {
+    assert(frame_index_ < frame_count && "frame index out of range");
+    frame_index = frame_index_;
+    head = 0;
+}
+
+FrameAllocation FrameRingAllocator::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    auto allocation = TryAllocate(size, alignment);
+    if (allocation.buffer == VK_NULL_HANDLE) {
+        throw std::runtime_error("frame ring allocator out of memory!");
+    }
+    return allocation;
+}
+
+FrameAllocation FrameRingAllocator::TryAllocate(VkDeviceSize size, VkDeviceSize alignment) {
+    assert((alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+
+    VkDeviceSize offset = align_up(head, std::max<VkDeviceSize>(alignment, 4));
+    if (offset + size > frame_size) {
+        return {};
+    }
+    head = offset + size;
+
+    VkDeviceSize absolute = static_cast<VkDeviceSize>(frame_index) * frame_size + offset;
+    return FrameAllocation{buffer->buffer, absolute, size, mapped + absolute};
+}
+
+FrameAllocation FrameRingAllocator::AllocateUniform(VkDeviceSize size) {
+    return Allocate(size, uniform_alignment);
+}
+
+FrameAllocation FrameRingAllocator::Push(const void *data, VkDeviceSize size, VkDeviceSize alignment) {
+    auto allocation = Allocate(size, alignment);
+    memcpy(allocation.data, data, size);
+    return allocation;
+}
+
+FrameAllocation FrameRingAllocator::PushUniform(const void *data, VkDeviceSize size) {
+    return Push(data, size, uniform_alignment);
+}
+
+void FrameRingAllocator::Flush() const {
+    if (head == 0) {
+        return;
+    }
+    buffer->Flush(static_cast<VkDeviceSize>(frame_index) * frame_size, head);
+}
+
+} // end namespace lvk
@@ -0,0 +1,75 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_FRAME_RING_ALLOCATOR_H
+#define LYH_FRAME_RING_ALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <memory>
+
+#include "allocator.h"
+#include "buffer.h"
+#include "swapchain.h"
+
+namespace lvk {
+
+struct FrameAllocation {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void *data = nullptr;
+};
+
+// One persistently mapped buffer split into `frame_count` equal regions. Each frame
+// bump-allocates transient UBO / vertex / index data from its own region, the region is
+// reclaimed by BeginFrame() once the fence of the frame that last used it has signaled.
+class FrameRingAllocator {
+public:
+    explicit FrameRingAllocator(Allocator &allocator, VkDeviceSize frame_size,
+                                uint32_t frame_count = Swapchain::MAX_FRAMES_IN_FLIGHT);
+
+    FrameRingAllocator(const FrameRingAllocator &) = delete;
+
+    FrameRingAllocator &operator=(const FrameRingAllocator &) = delete;
+
+    void Destroy() const;
+
+    // Must only be called after the in-flight fence of `frame_index` has been waited on.
+    void BeginFrame(uint32_t frame_index);
+
+    // Throws when the frame's region is full.
+    FrameAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+    // A null buffer instead of throwing, for callers with somewhere else to put large data.
+    FrameAllocation TryAllocate(VkDeviceSize size, VkDeviceSize alignment);
+
+    FrameAllocation AllocateUniform(VkDeviceSize size);
+
+    FrameAllocation Push(const void *data, VkDeviceSize size, VkDeviceSize alignment);
+
+    FrameAllocation PushUniform(const void *data, VkDeviceSize size);
+
+    // Flush what the current frame has written so far (no-op on host coherent memory).
+    void Flush() const;
+
+    [[nodiscard]] VkBuffer GetBuffer() const { return buffer->buffer; }
+    [[nodiscard]] VkDeviceSize GetFrameSize() const { return frame_size; }
+    [[nodiscard]] VkDeviceSize GetUsedSize() const { return head; }
+    [[nodiscard]] uint32_t GetFrameIndex() const { return frame_index; }
+
+private:
+    std::unique_ptr<Buffer> buffer;
+    uint8_t *mapped = nullptr;
+
+    VkDeviceSize frame_size = 0;
+    uint32_t frame_count = 0;
+    uint32_t frame_index = 0;
+    VkDeviceSize head = 0;
+
+    VkDeviceSize uniform_alignment = 1;
+};
+
+} // end namespace lvk
+
+#endif //LYH_FRAME_RING_ALLOCATOR_H
@@ -217,4 +217,14 @@ std::vector<char> ReadFile(const std::string &filename) {
     return buffer;
 }
 
+uint64_t Fnv1a64(const void *data, size_t size, uint64_t seed) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 } // end namespace lvk
@@ -206,5 +206,8 @@ VulkanFunctions& vulkan_functions();
 VkShaderModule CreateShaderModule(VkDevice device_, const std::vector<char> &code);
 std::vector<char> ReadFile(const std::string &filename);
 
+// 64 bit FNV-1a, pass the previous result as `seed` to hash several ranges as one
+uint64_t Fnv1a64(const void *data, size_t size, uint64_t seed = 14695981039346656037ull);
+
 } // end of namespace lvk
 #endif //LVK_FUNCTIONS_H
@@ -0,0 +1,48 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_MAPPED_FILE_H
+#define LYH_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lvk {
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    // Throws std::runtime_error when the file can't be opened or mapped.
+    explicit MappedFile(const std::string &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    [[nodiscard]] const uint8_t *GetData() const { return data; }
+    [[nodiscard]] size_t GetSize() const { return size; }
+
+    void Close();
+
+private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+};
+
+} // end namespace lvk
+
+#endif //LYH_MAPPED_FILE_H
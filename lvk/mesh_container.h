@@ -0,0 +1,98 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_MESH_CONTAINER_H
+#define LYH_MESH_CONTAINER_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace lvk {
+// Cooked mesh file written by mesh_cook:
+//   MeshContainerHeader
+//   vertex data at vertex_offset, Vertex3 packed with the header's precisions
+//   index data at index_offset, index_type wide
+// Both offsets are MESH_CONTAINER_ALIGNMENT aligned and the data is laid out exactly as MeshLoader
+// stages it, so loading is one copy from the mapping into staging memory.
+constexpr uint32_t MESH_CONTAINER_MAGIC = 0x48534D4C; // "LMSH"
+constexpr uint32_t MESH_CONTAINER_VERSION = 1;
+constexpr uint64_t MESH_CONTAINER_ALIGNMENT = 16;
+constexpr const char *MESH_CONTAINER_EXTENSION = ".lmsh";
+
+struct MeshContainerHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t vertex_stride;
+    uint32_t index_type; // VkIndexType
+    uint8_t position_precision; // AttributePrecision
+    uint8_t color_precision;
+    uint8_t uv_precision;
+    uint8_t reserved;
+    float bounds_min[3];
+    float bounds_max[3];
+    uint64_t vertex_offset; // from the start of the file
+    uint64_t index_offset; // index data ends data_size bytes after vertex_offset
+    uint64_t data_size;
+};
+
+static_assert(sizeof(MeshContainerHeader) == 80, "mesh container header layout changed");
+
+// Checks a mapped container before anything is read from it, throws on malformed files.
+inline const MeshContainerHeader *ParseMeshContainer(const uint8_t *data, size_t size) {
+    if (size < sizeof(MeshContainerHeader)) {
+        throw std::runtime_error("mesh container is truncated!");
+    }
+
+    auto header = reinterpret_cast<const MeshContainerHeader *>(data);
+    if (header->magic != MESH_CONTAINER_MAGIC || header->version != MESH_CONTAINER_VERSION) {
+        throw std::runtime_error("not a mesh container or unsupported version!");
+    }
+    if (header->index_type != VK_INDEX_TYPE_UINT16 && header->index_type != VK_INDEX_TYPE_UINT32) {
+        throw std::runtime_error("mesh container has a bad index type!");
+    }
+
+    uint64_t index_size = static_cast<uint64_t>(header->index_count) *
+                          (header->index_type == VK_INDEX_TYPE_UINT16 ? 2 : 4);
+    uint64_t vertex_size = static_cast<uint64_t>(header->vertex_count) * header->vertex_stride;
+    if (header->vertex_offset % MESH_CONTAINER_ALIGNMENT != 0 || header->index_offset % MESH_CONTAINER_ALIGNMENT != 0 ||
+        header->vertex_offset < sizeof(MeshContainerHeader) || header->index_offset < header->vertex_offset) {
+        throw std::runtime_error("mesh container has a bad layout!");
+    }
+    // compared by subtracting from bounds already checked, offsets near 2^64 must not wrap around
+    if (header->vertex_offset > size || header->data_size > size - header->vertex_offset) {
+        throw std::runtime_error("mesh container is truncated!");
+    }
+    uint64_t index_begin = header->index_offset - header->vertex_offset;
+    if (index_begin < vertex_size || index_begin > header->data_size ||
+        header->data_size - index_begin != index_size) {
+        throw std::runtime_error("mesh container has a bad layout!");
+    }
+
+    // the GPU would read past the vertex buffer, one pass over the indices is cheap next to the copy
+    const uint8_t *indices = data + header->index_offset;
+    uint32_t max_index = 0;
+    if (header->index_type == VK_INDEX_TYPE_UINT16) {
+        for (uint32_t i = 0; i < header->index_count; i++) {
+            max_index = std::max<uint32_t>(max_index, reinterpret_cast<const uint16_t *>(indices)[i]);
+        }
+    } else {
+        for (uint32_t i = 0; i < header->index_count; i++) {
+            max_index = std::max(max_index, reinterpret_cast<const uint32_t *>(indices)[i]);
+        }
+    }
+    if (header->index_count > 0 && max_index >= header->vertex_count) {
+        throw std::runtime_error("mesh container has an index past its vertices!");
+    }
+
+    return header;
+}
+
+} // end namespace lvk
+
+#endif //LYH_MESH_CONTAINER_H
@@ -0,0 +1,1197 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "mesh_loader.h"
+
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mesh_container.h"
+#include "mesh_optimizer.h"
+#include "Vertex.h"
+
+namespace lvk {
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool has_extension(const std::string &file, const std::string &extension) {
+    if (file.size() < extension.size()) {
+        return false;
+    }
+    return std::equal(extension.begin(), extension.end(), file.end() - static_cast<ptrdiff_t>(extension.size()),
+                      [](char a, char b) {
+                          return std::tolower(static_cast<unsigned char>(a)) ==
+                                 std::tolower(static_cast<unsigned char>(b));
+                      });
+}
+
+// ********************** numbers **********************
+
+// exact in a double, a mantissa of up to 53 bits scaled by one of them rounds correctly
+constexpr double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+constexpr uint32_t MAX_MANTISSA_DIGITS = 19;
+
+inline bool is_digit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// SWAR over eight bytes read as one little endian word: true when all of them are ASCII digits
+inline bool is_eight_digits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ull) |
+            (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+// the eight digits as a number, pairs, then quads, then the halves are combined with one multiply each
+inline uint32_t parse_eight_digits(uint64_t chunk) {
+    chunk = (chunk & 0x0F0F0F0F0F0F0F0Full) * 2561 >> 8;
+    chunk = (chunk & 0x00FF00FF00FF00FFull) * 6553601 >> 16;
+    return static_cast<uint32_t>((chunk & 0x0000FFFF0000FFFFull) * 42949672960001ull >> 32);
+}
+
+// Decimal number without strtod: no locale, no terminator needed, digits of the fraction are
+// taken eight at a time. Digits past the 19th only move the exponent.
+bool parse_number(const char *&p, const char *end, double &out) {
+    const char *start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int32_t exponent = 0;
+    uint32_t digits = 0;
+    const char *integer = p;
+    for (; p < end && is_digit(*p); p++) {
+        if (digits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + static_cast<uint32_t>(*p - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+        }
+    }
+    bool any = p != integer;
+
+    if (p < end && *p == '.') {
+        p++;
+        const char *fraction = p;
+        while (end - p >= 8 && digits + 8 <= MAX_MANTISSA_DIGITS) {
+            uint64_t chunk;
+            memcpy(&chunk, p, sizeof(chunk));
+            if (!is_eight_digits(chunk)) {
+                break;
+            }
+            mantissa = mantissa * 100000000 + parse_eight_digits(chunk);
+            digits = mantissa != 0 ? digits + 8 : 0;
+            exponent -= 8;
+            p += 8;
+        }
+        for (; p < end && is_digit(*p); p++) {
+            if (digits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + static_cast<uint32_t>(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+        any = any || p != fraction;
+    }
+    if (!any) {
+        p = start;
+        return false;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *e = p + 1;
+        bool negative_exponent = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            negative_exponent = *e == '-';
+            e++;
+        }
+        if (e < end && is_digit(*e)) {
+            int32_t value = 0;
+            for (; e < end && is_digit(*e); e++) {
+                value = std::min(value * 10 + (*e - '0'), 100000);
+            }
+            exponent += negative_exponent ? -value : value;
+            p = e;
+        }
+    }
+
+    auto value = static_cast<double>(mantissa);
+    if (exponent < 0) {
+        value = exponent >= -22 ? value / POWERS_OF_TEN[-exponent] : value * std::pow(10.0, exponent);
+    } else if (exponent > 0) {
+        value = exponent <= 22 ? value * POWERS_OF_TEN[exponent] : value * std::pow(10.0, exponent);
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+bool parse_float(const char *&p, const char *end, float &out) {
+    double value;
+    if (!parse_number(p, end, value)) {
+        return false;
+    }
+    out = static_cast<float>(value);
+    return true;
+}
+
+bool parse_int(const char *&p, const char *end, int64_t &out) {
+    const char *start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    const char *digits = p;
+    int64_t value = 0;
+    for (; p < end && is_digit(*p); p++) {
+        value = std::min<int64_t>(value * 10 + (*p - '0'), std::numeric_limits<int32_t>::max());
+    }
+    if (p == digits) {
+        p = start;
+        return false;
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+inline void skip_spaces(const char *&p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+}
+
+inline bool at_line_end(const char *p, const char *end) {
+    return p >= end || *p == '\n' || *p == '\r' || *p == '#';
+}
+
+// memchr is vectorized by every C runtime, it does the bulk of the skipping
+inline const char *next_line(const char *p, const char *end) {
+    auto *newline = static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+    return newline ? newline + 1 : end;
+}
+
+// ********************** OBJ **********************
+
+// Corner indices as the chunk saw them. Negative OBJ indices count back from the elements read so
+// far and are stored relative to the chunk, biased below zero, until the chunk's base is known.
+constexpr int32_t NO_INDEX = std::numeric_limits<int32_t>::max();
+constexpr int32_t RELATIVE_BIAS = 1 << 30;
+
+struct ObjCorner {
+    int32_t position;
+    int32_t uv;
+};
+
+struct ObjChunk {
+    std::vector<glm::vec3> positions;
+    // only as long as the last position that had a color, the rest are white
+    std::vector<glm::vec3> colors;
+    std::vector<glm::vec2> uvs;
+    // three per triangle
+    std::vector<ObjCorner> corners;
+};
+
+int32_t parse_obj_index(const char *&p, const char *end, size_t local_count) {
+    int64_t index;
+    if (!parse_int(p, end, index) || index == 0) {
+        throw std::runtime_error("failed to parse OBJ, bad face index!");
+    }
+    if (index > 0) {
+        return static_cast<int32_t>(std::min<int64_t>(index - 1, NO_INDEX - 1));
+    }
+    int64_t relative = static_cast<int64_t>(local_count) + index;
+    if (relative < -RELATIVE_BIAS) {
+        throw std::runtime_error("failed to parse OBJ, face index out of range!");
+    }
+    return static_cast<int32_t>(relative - RELATIVE_BIAS);
+}
+
+void parse_obj_face(const char *&p, const char *end, ObjChunk &chunk) {
+    ObjCorner first{};
+    ObjCorner previous{};
+    uint32_t count = 0;
+    for (skip_spaces(p, end); !at_line_end(p, end); skip_spaces(p, end)) {
+        ObjCorner corner{parse_obj_index(p, end, chunk.positions.size()), NO_INDEX};
+        if (p < end && *p == '/') {
+            p++;
+            if (p < end && *p != '/') {
+                corner.uv = parse_obj_index(p, end, chunk.uvs.size());
+            }
+            if (p < end && *p == '/') {
+                // normals are not kept, only skipped
+                p++;
+                int64_t normal;
+                parse_int(p, end, normal);
+            }
+        }
+
+        // polygons are fanned around their first corner
+        if (count == 0) {
+            first = corner;
+        } else if (count >= 2) {
+            chunk.corners.push_back(first);
+            chunk.corners.push_back(previous);
+            chunk.corners.push_back(corner);
+        }
+        previous = corner;
+        count++;
+    }
+    if (count < 3) {
+        throw std::runtime_error("failed to parse OBJ, face with less than 3 corners!");
+    }
+}
+
+void parse_obj_vertex(const char *&p, const char *end, ObjChunk &chunk) {
+    // x y z, then either w or the r g b vertex color extension
+    float values[6];
+    uint32_t count = 0;
+    for (skip_spaces(p, end); count < 6 && parse_float(p, end, values[count]); skip_spaces(p, end)) {
+        count++;
+    }
+    if (count < 3) {
+        throw std::runtime_error("failed to parse OBJ, vertex with less than 3 coordinates!");
+    }
+    chunk.positions.emplace_back(values[0], values[1], values[2]);
+    if (count == 6) {
+        chunk.colors.resize(chunk.positions.size() - 1, glm::vec3(1.0f));
+        chunk.colors.emplace_back(values[3], values[4], values[5]);
+    }
+}
+
+void parse_obj_uv(const char *&p, const char *end, ObjChunk &chunk) {
+    float values[2] = {0.0f, 0.0f};
+    skip_spaces(p, end);
+    if (!parse_float(p, end, values[0])) {
+        throw std::runtime_error("failed to parse OBJ, texture coordinate without value!");
+    }
+    skip_spaces(p, end);
+    parse_float(p, end, values[1]);
+    // OBJ puts v = 0 at the bottom of the image, Vulkan samples row 0 at the top
+    chunk.uvs.emplace_back(values[0], 1.0f - values[1]);
+}
+
+// Open addressing from (position, uv) to the welded vertex, grown at half load.
+class CornerMap {
+public:
+    explicit CornerMap(size_t expected) {
+        size_t capacity = 64;
+        while (capacity < expected * 2) {
+            capacity *= 2;
+        }
+        keys.assign(capacity, EMPTY);
+        values.resize(capacity);
+    }
+
+    // the vertex of `key`, `next` when it is new
+    uint32_t Insert(uint64_t key, uint32_t next) {
+        if ((count + 1) * 2 > keys.size()) {
+            grow();
+        }
+        size_t mask = keys.size() - 1;
+        for (size_t slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+            if (keys[slot] == key) {
+                return values[slot];
+            }
+            if (keys[slot] == EMPTY) {
+                keys[slot] = key;
+                values[slot] = next;
+                count++;
+                return next;
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t EMPTY = std::numeric_limits<uint64_t>::max();
+
+    static size_t hash(uint64_t key) {
+        // the high bits of a multiplicative hash, folded down
+        key *= 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(key ^ (key >> 32));
+    }
+
+    void grow() {
+        std::vector<uint64_t> old_keys(keys.size() * 2, EMPTY);
+        std::vector<uint32_t> old_values(values.size() * 2);
+        std::swap(old_keys, keys);
+        std::swap(old_values, values);
+        size_t mask = keys.size() - 1;
+        for (size_t i = 0; i < old_keys.size(); i++) {
+            if (old_keys[i] == EMPTY) {
+                continue;
+            }
+            size_t slot = hash(old_keys[i]) & mask;
+            while (keys[slot] != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+            keys[slot] = old_keys[i];
+            values[slot] = old_values[i];
+        }
+    }
+
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> values;
+    size_t count = 0;
+};
+
+// ********************** glTF **********************
+
+struct JsonValue {
+    enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    [[nodiscard]] const JsonValue *Find(const char *key) const {
+        for (auto const &[name, value]: object) {
+            if (name == key) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] const JsonValue &At(const char *key) const {
+        auto *value = Find(key);
+        if (value == nullptr) {
+            throw std::runtime_error(std::string("failed to load glTF, missing \"") + key + "\"!");
+        }
+        return *value;
+    }
+
+    [[nodiscard]] const JsonValue &At(size_t index) const {
+        if (type != Type::Array || index >= array.size()) {
+            throw std::runtime_error("failed to load glTF, index out of range!");
+        }
+        return array[index];
+    }
+
+    [[nodiscard]] uint64_t Uint(const char *key, uint64_t fallback) const {
+        auto *value = Find(key);
+        return value && value->type == Type::Number ? static_cast<uint64_t>(value->number) : fallback;
+    }
+};
+
+// Just enough JSON for glTF: no surrogate pairs, \u escapes outside ASCII become '?'.
+class JsonReader {
+public:
+    JsonReader(const char *begin, const char *end) : p(begin), end(end) {
+    }
+
+    JsonValue Read() {
+        auto value = readValue(0);
+        skipSpaces();
+        if (p != end) {
+            fail();
+        }
+        return value;
+    }
+
+private:
+    static constexpr uint32_t MAX_DEPTH = 64;
+
+    [[noreturn]] static void fail() {
+        throw std::runtime_error("failed to load glTF, malformed JSON!");
+    }
+
+    void skipSpaces() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            p++;
+        }
+    }
+
+    void expect(char c) {
+        skipSpaces();
+        if (p >= end || *p != c) {
+            fail();
+        }
+        p++;
+    }
+
+    bool consumeComma() {
+        skipSpaces();
+        if (p < end && *p == ',') {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consume(const char *word) {
+        size_t length = strlen(word);
+        if (static_cast<size_t>(end - p) >= length && memcmp(p, word, length) == 0) {
+            p += length;
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue readValue(uint32_t depth) {
+        if (depth > MAX_DEPTH) {
+            fail();
+        }
+        skipSpaces();
+        if (p >= end) {
+            fail();
+        }
+
+        JsonValue value{};
+        switch (*p) {
+            case '{':
+                p++;
+                value.type = JsonValue::Type::Object;
+                skipSpaces();
+                if (p < end && *p == '}') {
+                    p++;
+                    return value;
+                }
+                do {
+                    skipSpaces();
+                    auto key = readString();
+                    expect(':');
+                    value.object.emplace_back(std::move(key), readValue(depth + 1));
+                } while (consumeComma());
+                expect('}');
+                return value;
+            case '[':
+                p++;
+                value.type = JsonValue::Type::Array;
+                skipSpaces();
+                if (p < end && *p == ']') {
+                    p++;
+                    return value;
+                }
+                do {
+                    value.array.push_back(readValue(depth + 1));
+                } while (consumeComma());
+                expect(']');
+                return value;
+            case '"':
+                value.type = JsonValue::Type::String;
+                value.string = readString();
+                return value;
+            case 't':
+            case 'f':
+                value.type = JsonValue::Type::Bool;
+                value.boolean = *p == 't';
+                if (!consume(value.boolean ? "true" : "false")) {
+                    fail();
+                }
+                return value;
+            case 'n':
+                if (!consume("null")) {
+                    fail();
+                }
+                return value;
+            default:
+                if (!parse_number(p, end, value.number)) {
+                    fail();
+                }
+                value.type = JsonValue::Type::Number;
+                return value;
+        }
+    }
+
+    std::string readString() {
+        if (p >= end || *p != '"') {
+            fail();
+        }
+        p++;
+        std::string result;
+        while (p < end && *p != '"') {
+            if (*p != '\\') {
+                result.push_back(*p++);
+                continue;
+            }
+            if (++p >= end) {
+                fail();
+            }
+            switch (*p++) {
+                case 'b': result.push_back('\b'); break;
+                case 'f': result.push_back('\f'); break;
+                case 'n': result.push_back('\n'); break;
+                case 'r': result.push_back('\r'); break;
+                case 't': result.push_back('\t'); break;
+                case 'u': {
+                    if (end - p < 4) {
+                        fail();
+                    }
+                    uint32_t code = 0;
+                    for (int i = 0; i < 4; i++, p++) {
+                        char c = static_cast<char>(std::tolower(static_cast<unsigned char>(*p)));
+                        code = code * 16 + (is_digit(c) ? c - '0' : c - 'a' + 10);
+                    }
+                    result.push_back(code < 0x80 ? static_cast<char>(code) : '?');
+                    break;
+                }
+                default: result.push_back(p[-1]);
+            }
+        }
+        if (p >= end) {
+            fail();
+        }
+        p++;
+        return result;
+    }
+
+    const char *p;
+    const char *end;
+};
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+constexpr uint64_t GLTF_TRIANGLES = 4;
+
+enum GltfComponentType : uint32_t {
+    GLTF_BYTE = 5120,
+    GLTF_UNSIGNED_BYTE = 5121,
+    GLTF_SHORT = 5122,
+    GLTF_UNSIGNED_SHORT = 5123,
+    GLTF_UNSIGNED_INT = 5125,
+    GLTF_FLOAT = 5126,
+};
+
+struct ByteSpan {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+};
+
+// One accessor resolved down to its bytes.
+struct GltfAccessor {
+    const uint8_t *data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    uint32_t component_type = GLTF_FLOAT;
+    uint32_t components = 1;
+    bool normalized = false;
+
+    [[nodiscard]] float Component(size_t element, uint32_t component) const {
+        const uint8_t *source = data + element * stride;
+        switch (component_type) {
+            case GLTF_FLOAT: {
+                float value;
+                memcpy(&value, source + component * 4, sizeof(value));
+                return value;
+            }
+            case GLTF_UNSIGNED_BYTE: {
+                float value = source[component];
+                return normalized ? value / 255.0f : value;
+            }
+            case GLTF_BYTE: {
+                float value = static_cast<int8_t>(source[component]);
+                return normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t bits;
+                memcpy(&bits, source + component * 2, sizeof(bits));
+                return normalized ? bits / 65535.0f : static_cast<float>(bits);
+            }
+            case GLTF_SHORT: {
+                int16_t bits;
+                memcpy(&bits, source + component * 2, sizeof(bits));
+                return normalized ? std::max(bits / 32767.0f, -1.0f) : static_cast<float>(bits);
+            }
+            default: {
+                uint32_t bits;
+                memcpy(&bits, source + component * 4, sizeof(bits));
+                return static_cast<float>(bits);
+            }
+        }
+    }
+
+    [[nodiscard]] uint32_t Index(size_t element) const {
+        const uint8_t *source = data + element * stride;
+        switch (component_type) {
+            case GLTF_UNSIGNED_BYTE: return *source;
+            case GLTF_UNSIGNED_SHORT: {
+                uint16_t index;
+                memcpy(&index, source, sizeof(index));
+                return index;
+            }
+            case GLTF_UNSIGNED_INT: {
+                uint32_t index;
+                memcpy(&index, source, sizeof(index));
+                return index;
+            }
+            default:
+                throw std::runtime_error("failed to load glTF, indices are not unsigned integers!");
+        }
+    }
+};
+
+uint32_t gltf_component_size(uint32_t component_type) {
+    switch (component_type) {
+        case GLTF_BYTE:
+        case GLTF_UNSIGNED_BYTE: return 1;
+        case GLTF_SHORT:
+        case GLTF_UNSIGNED_SHORT: return 2;
+        case GLTF_UNSIGNED_INT:
+        case GLTF_FLOAT: return 4;
+        default:
+            throw std::runtime_error("failed to load glTF, unknown component type!");
+    }
+}
+
+uint32_t gltf_component_count(const std::string &type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    throw std::runtime_error("failed to load glTF, unsupported accessor type " + type + "!");
+}
+
+GltfAccessor gltf_accessor(const JsonValue &gltf, const std::vector<ByteSpan> &buffers, uint64_t index) {
+    auto const &accessor = gltf.At("accessors").At(index);
+    if (accessor.Find("sparse") || !accessor.Find("bufferView")) {
+        throw std::runtime_error("failed to load glTF, sparse accessors are not supported!");
+    }
+    auto const &view = gltf.At("bufferViews").At(accessor.Uint("bufferView", 0));
+    uint64_t buffer = view.Uint("buffer", 0);
+    if (buffer >= buffers.size()) {
+        throw std::runtime_error("failed to load glTF, buffer index out of range!");
+    }
+
+    GltfAccessor result{};
+    result.count = accessor.Uint("count", 0);
+    result.component_type = static_cast<uint32_t>(accessor.Uint("componentType", GLTF_FLOAT));
+    result.components = gltf_component_count(accessor.At("type").string);
+    auto *normalized = accessor.Find("normalized");
+    result.normalized = normalized && normalized->boolean;
+
+    size_t element_size = static_cast<size_t>(gltf_component_size(result.component_type)) * result.components;
+    result.stride = view.Uint("byteStride", element_size);
+    size_t view_offset = view.Uint("byteOffset", 0);
+    size_t view_size = view.Uint("byteLength", 0);
+    size_t offset = accessor.Uint("byteOffset", 0);
+    if (view_offset + view_size > buffers[buffer].size ||
+        (result.count > 0 && offset + (result.count - 1) * result.stride + element_size > view_size)) {
+        throw std::runtime_error("failed to load glTF, accessor out of buffer bounds!");
+    }
+    result.data = buffers[buffer].data + view_offset + offset;
+    return result;
+}
+
+uint32_t read_u32(const uint8_t *data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// ********************** parsing **********************
+
+struct ObjJob {
+    MappedFile file;
+    Clock::time_point start;
+    // [begin, end) byte ranges, each ends after a newline or at the end of the file
+    std::vector<std::pair<size_t, size_t>> ranges;
+    std::vector<ObjChunk> chunks;
+
+    std::atomic<uint32_t> remaining{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    // runs once, on the worker that parsed the last chunk, `error` is set when any chunk failed
+    std::function<void(ObjJob &)> finish;
+};
+
+void parse_obj_chunk(ObjJob &job, uint32_t index) {
+    auto *text = reinterpret_cast<const char *>(job.file.GetData());
+    const char *p = text + job.ranges[index].first;
+    const char *end = text + job.ranges[index].second;
+    auto &chunk = job.chunks[index];
+
+    // a rough guess from typical line lengths, saves most of the regrowth
+    size_t lines = (end - p) / 32;
+    chunk.positions.reserve(lines / 3);
+    chunk.uvs.reserve(lines / 3);
+    chunk.corners.reserve(lines);
+
+    while (p < end) {
+        skip_spaces(p, end);
+        if (end - p >= 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            p++;
+            parse_obj_vertex(p, end, chunk);
+        } else if (end - p >= 3 && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+            p += 2;
+            parse_obj_uv(p, end, chunk);
+        } else if (end - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            p++;
+            parse_obj_face(p, end, chunk);
+        }
+        // vn, comments, groups, materials, smoothing, lines and points are skipped
+        p = next_line(p, end);
+    }
+}
+
+// Maps the file and splits it into line aligned chunks parsed on `workers`. No task waits on
+// another, the last chunk to finish calls job->finish, so any number of files can be in flight
+// on any number of workers. Throws when the file can't be mapped, before anything is queued.
+void start_obj(const std::shared_ptr<ObjJob> &job, const std::string &file, ThreadPool &workers) {
+    job->start = Clock::now();
+    job->file = MappedFile(file);
+
+    // cut every CHUNK_SIZE bytes, moved forward to the next line so no line is split
+    auto *text = reinterpret_cast<const char *>(job->file.GetData());
+    size_t size = job->file.GetSize();
+    for (size_t begin = 0; begin < size;) {
+        size_t end = begin + MeshLoader::CHUNK_SIZE;
+        end = end >= size ? size : static_cast<size_t>(next_line(text + end, text + size) - text);
+        job->ranges.emplace_back(begin, end);
+        begin = end;
+    }
+    if (job->ranges.empty()) {
+        job->ranges.emplace_back(0, 0);
+    }
+    job->chunks.resize(job->ranges.size());
+    job->remaining = static_cast<uint32_t>(job->ranges.size());
+
+    for (uint32_t i = 0; i < job->ranges.size(); i++) {
+        workers.Submit([job, i] {
+            try {
+                parse_obj_chunk(*job, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job->error_mutex);
+                if (!job->error) {
+                    job->error = std::current_exception();
+                }
+            }
+            if (job->remaining.fetch_sub(1) == 1) {
+                job->finish(*job);
+            }
+        });
+    }
+}
+
+MeshGeometry merge_obj(ObjJob &job) {
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+
+    MeshGeometry geometry{};
+    geometry.stats.file_size = job.file.GetSize();
+    geometry.stats.chunk_count = static_cast<uint32_t>(job.chunks.size());
+    job.file.Close();
+
+    size_t position_count = 0;
+    size_t uv_count = 0;
+    size_t corner_count = 0;
+    bool has_colors = false;
+    for (auto const &chunk: job.chunks) {
+        position_count += chunk.positions.size();
+        uv_count += chunk.uvs.size();
+        corner_count += chunk.corners.size();
+        has_colors = has_colors || !chunk.colors.empty();
+    }
+    if (position_count >= static_cast<size_t>(NO_INDEX) || uv_count >= static_cast<size_t>(NO_INDEX)) {
+        throw std::runtime_error("failed to load OBJ, too many vertices!");
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> colors;
+    std::vector<glm::vec2> uvs;
+    positions.reserve(position_count);
+    uvs.reserve(uv_count);
+    if (has_colors) {
+        colors.reserve(position_count);
+    }
+
+    // corners sharing position and uv become one vertex
+    std::vector<uint64_t> keys;
+    auto &indices = geometry.indices;
+    keys.reserve(position_count);
+    indices.reserve(corner_count);
+    CornerMap welded(position_count);
+
+    for (auto &chunk: job.chunks) {
+        auto position_base = static_cast<int64_t>(positions.size());
+        auto uv_base = static_cast<int64_t>(uvs.size());
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        if (has_colors) {
+            colors.insert(colors.end(), chunk.colors.begin(), chunk.colors.end());
+            colors.resize(positions.size(), glm::vec3(1.0f));
+        }
+        auto resolve = [](int32_t index, int64_t base) -> int64_t {
+            return index >= 0 ? index : base + index + RELATIVE_BIAS;
+        };
+
+        // references may point forward into later chunks, so checked against the whole file
+        for (auto const &corner: chunk.corners) {
+            int64_t position = resolve(corner.position, position_base);
+            int64_t uv = corner.uv == NO_INDEX ? NO_INDEX : resolve(corner.uv, uv_base);
+            if (position < 0 || position >= static_cast<int64_t>(position_count) ||
+                uv < 0 || (uv != NO_INDEX && uv >= static_cast<int64_t>(uv_count))) {
+                throw std::runtime_error("failed to load OBJ, face index out of range!");
+            }
+
+            uint64_t key = static_cast<uint64_t>(position) << 32 | static_cast<uint64_t>(uv);
+            auto next = static_cast<uint32_t>(keys.size());
+            uint32_t vertex = welded.Insert(key, next);
+            if (vertex == next) {
+                keys.push_back(key);
+            }
+            indices.push_back(vertex);
+        }
+        chunk = {};
+    }
+
+    // built once every position has been read
+    geometry.vertices.reserve(keys.size());
+    for (auto key: keys) {
+        auto position = static_cast<size_t>(key >> 32);
+        auto uv = static_cast<size_t>(key & 0xFFFFFFFF);
+        geometry.vertices.emplace_back(positions[position], has_colors ? colors[position] : glm::vec3(1.0f),
+                                       uv == static_cast<size_t>(NO_INDEX) ? glm::vec2(0.0f) : uvs[uv]);
+    }
+
+    geometry.stats.parse_seconds = seconds_since(job.start);
+    return geometry;
+}
+
+MeshGeometry parse_gltf(const std::string &file) {
+    auto start = Clock::now();
+    MeshGeometry geometry{};
+    geometry.stats.chunk_count = 1;
+
+    MappedFile mapped(file);
+    geometry.stats.file_size = mapped.GetSize();
+    const uint8_t *json_begin = mapped.GetData();
+    const uint8_t *json_end = mapped.GetData() + mapped.GetSize();
+    ByteSpan embedded{};
+
+    if (mapped.GetSize() >= 12 && read_u32(mapped.GetData()) == GLB_MAGIC) {
+        // 12 byte header, then the JSON chunk and an optional BIN chunk
+        const uint8_t *data = mapped.GetData();
+        size_t size = std::min<size_t>(read_u32(data + 8), mapped.GetSize());
+        size_t offset = 12;
+        json_begin = json_end = nullptr;
+        while (offset + 8 <= size) {
+            uint32_t length = read_u32(data + offset);
+            uint32_t type = read_u32(data + offset + 4);
+            offset += 8;
+            if (offset + length > size) {
+                throw std::runtime_error("failed to load glTF, truncated GLB chunk!");
+            }
+            if (type == GLB_CHUNK_JSON && json_begin == nullptr) {
+                json_begin = data + offset;
+                json_end = data + offset + length;
+            } else if (type == GLB_CHUNK_BIN && embedded.data == nullptr) {
+                embedded = {data + offset, length};
+            }
+            offset += length;
+        }
+        if (json_begin == nullptr) {
+            throw std::runtime_error("failed to load glTF, GLB without JSON chunk!");
+        }
+    }
+
+    auto gltf = JsonReader(reinterpret_cast<const char *>(json_begin),
+                           reinterpret_cast<const char *>(json_end)).Read();
+
+    // external buffers are relative to the .gltf, a buffer without uri is the GLB's BIN chunk
+    std::string directory = file.substr(0, file.find_last_of("/\\") + 1);
+    std::vector<MappedFile> buffer_files;
+    std::vector<ByteSpan> buffers;
+    if (auto *list = gltf.Find("buffers")) {
+        buffer_files.reserve(list->array.size());
+        for (auto const &buffer: list->array) {
+            auto *uri = buffer.Find("uri");
+            if (uri == nullptr) {
+                buffers.push_back(embedded);
+                continue;
+            }
+            if (uri->string.rfind("data:", 0) == 0) {
+                throw std::runtime_error("failed to load glTF, data URIs are not supported: " + file);
+            }
+            buffer_files.emplace_back(directory + uri->string);
+            geometry.stats.file_size += buffer_files.back().GetSize();
+            buffers.push_back({buffer_files.back().GetData(), buffer_files.back().GetSize()});
+        }
+    }
+
+    auto &vertices = geometry.vertices;
+    auto &indices = geometry.indices;
+    for (auto const &gltf_mesh: gltf.At("meshes").array) {
+        for (auto const &primitive: gltf_mesh.At("primitives").array) {
+            if (primitive.Uint("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES) {
+                throw std::runtime_error("failed to load glTF, only triangle lists are supported: " + file);
+            }
+            auto const &attributes = primitive.At("attributes");
+            auto positions = gltf_accessor(gltf, buffers, attributes.Uint("POSITION", UINT64_MAX));
+            GltfAccessor colors{};
+            GltfAccessor uvs{};
+            bool has_colors = attributes.Find("COLOR_0") != nullptr;
+            bool has_uvs = attributes.Find("TEXCOORD_0") != nullptr;
+            if (has_colors) {
+                colors = gltf_accessor(gltf, buffers, attributes.Uint("COLOR_0", 0));
+            }
+            if (has_uvs) {
+                uvs = gltf_accessor(gltf, buffers, attributes.Uint("TEXCOORD_0", 0));
+            }
+            if (positions.components < 3 || (has_colors && (colors.count < positions.count || colors.components < 3)) ||
+                (has_uvs && (uvs.count < positions.count || uvs.components < 2))) {
+                throw std::runtime_error("failed to load glTF, attribute layout not supported: " + file);
+            }
+
+            auto base = static_cast<uint32_t>(vertices.size());
+            vertices.reserve(vertices.size() + positions.count);
+            for (size_t i = 0; i < positions.count; i++) {
+                glm::vec3 color(1.0f);
+                glm::vec2 uv(0.0f);
+                if (has_colors) {
+                    color = {colors.Component(i, 0), colors.Component(i, 1), colors.Component(i, 2)};
+                }
+                if (has_uvs) {
+                    uv = {uvs.Component(i, 0), uvs.Component(i, 1)};
+                }
+                vertices.emplace_back(glm::vec3(positions.Component(i, 0), positions.Component(i, 1),
+                                                positions.Component(i, 2)), color, uv);
+            }
+
+            if (primitive.Find("indices")) {
+                auto source = gltf_accessor(gltf, buffers, primitive.Uint("indices", 0));
+                indices.reserve(indices.size() + source.count);
+                for (size_t i = 0; i < source.count; i++) {
+                    uint32_t index = source.Index(i);
+                    if (index >= positions.count) {
+                        throw std::runtime_error("failed to load glTF, index out of range: " + file);
+                    }
+                    indices.push_back(base + index);
+                }
+            } else {
+                for (uint32_t i = 0; i < positions.count; i++) {
+                    indices.push_back(base + i);
+                }
+            }
+        }
+    }
+
+    geometry.stats.parse_seconds = seconds_since(start);
+    return geometry;
+}
+
+// ********************** staging **********************
+
+// Packs in cached memory a block at a time and copies whole blocks out: the packer writes one
+// attribute at a time, which would turn into partial line writes on write combined memory.
+constexpr size_t STAGING_BLOCK_VERTICES = 1024;
+
+LoadedMesh stage_mesh(StagingPool &staging_pool, MeshGeometry &geometry, const MeshLoadOptions &options) {
+    auto start = Clock::now();
+    auto &vertices = geometry.vertices;
+    auto &indices = geometry.indices;
+    if (vertices.empty() || indices.empty()) {
+        throw std::runtime_error("failed to load mesh, no triangles!");
+    }
+    if (indices.size() % 3 != 0) {
+        throw std::runtime_error("failed to load mesh, index count is not a multiple of 3!");
+    }
+    if (options.optimize) {
+        OptimizeVertexCache(indices.data(), indices.data(), indices.size(), vertices.size());
+        OptimizeVertexFetch(vertices, indices);
+    }
+
+    auto packer = VertexPacker::ForVertex3(options.format);
+    LoadedMesh mesh{};
+    mesh.format = options.format;
+    mesh.vertex_count = static_cast<uint32_t>(vertices.size());
+    mesh.index_count = static_cast<uint32_t>(indices.size());
+    mesh.index_type = SelectIndexType(vertices.size());
+    mesh.vertex_size = static_cast<VkDeviceSize>(packer.GetStride()) * vertices.size();
+    mesh.index_offset = (mesh.vertex_size + 3) & ~VkDeviceSize(3);
+    mesh.index_size = indices.size() * (mesh.index_type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    mesh.bounds_min = glm::vec3(std::numeric_limits<float>::max());
+    mesh.bounds_max = glm::vec3(std::numeric_limits<float>::lowest());
+    for (auto const &vertex: vertices) {
+        mesh.bounds_min = glm::min(mesh.bounds_min, vertex.pos);
+        mesh.bounds_max = glm::max(mesh.bounds_max, vertex.pos);
+    }
+
+    VkDeviceSize size = mesh.index_offset + mesh.index_size;
+    mesh.staging = staging_pool.Acquire(size);
+    auto *mapped = static_cast<uint8_t *>(mesh.staging->GetMappedData());
+
+    std::vector<uint8_t> block(STAGING_BLOCK_VERTICES * packer.GetStride());
+    for (size_t first = 0; first < vertices.size(); first += STAGING_BLOCK_VERTICES) {
+        size_t count = std::min(vertices.size() - first, STAGING_BLOCK_VERTICES);
+        packer.Pack(vertices.data() + first, count, block.data());
+        memcpy(mapped + first * packer.GetStride(), block.data(), count * packer.GetStride());
+    }
+
+    if (mesh.index_type == VK_INDEX_TYPE_UINT16) {
+        std::vector<uint16_t> narrow(indices.begin(), indices.end());
+        memcpy(mapped + mesh.index_offset, narrow.data(), mesh.index_size);
+    } else {
+        memcpy(mapped + mesh.index_offset, indices.data(), mesh.index_size);
+    }
+    mesh.staging->Flush(0, size);
+
+    mesh.stats = geometry.stats;
+    mesh.stats.total_seconds = geometry.stats.parse_seconds + seconds_since(start);
+    return mesh;
+}
+} // namespace
+
+MeshGeometry ParseMeshFile(const std::string &file, ThreadPool &workers) {
+    if (has_extension(file, ".gltf") || has_extension(file, ".glb")) {
+        return parse_gltf(file);
+    }
+    if (!has_extension(file, ".obj")) {
+        throw std::runtime_error("failed to load mesh, unknown format: " + file);
+    }
+
+    auto promise = std::make_shared<std::promise<MeshGeometry>>();
+    auto result = promise->get_future();
+    auto job = std::make_shared<ObjJob>();
+    job->finish = [promise](ObjJob &job) {
+        try {
+            promise->set_value(merge_obj(job));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    };
+    start_obj(job, file, workers);
+    return result.get();
+}
+
+MeshLoader::MeshLoader(Allocator &allocator, UploadManager &upload_manager, uint32_t thread_count)
+    : upload_manager(upload_manager), staging_pool(allocator, upload_manager), workers(thread_count) {
+    geometry_pool = std::make_unique<BufferPool>(allocator, &upload_manager,
+                                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+}
+
+MeshRequest MeshLoader::Load(const std::string &file, const MeshLoadOptions &options) {
+    if (has_extension(file, MESH_CONTAINER_EXTENSION)) {
+        return workers.Submit([this, file] { return loadCooked(file); }).share();
+    }
+    if (has_extension(file, ".gltf") || has_extension(file, ".glb")) {
+        return workers.Submit([this, file, options] {
+            auto geometry = parse_gltf(file);
+            return stage_mesh(staging_pool, geometry, options);
+        }).share();
+    }
+
+    auto promise = std::make_shared<std::promise<LoadedMesh>>();
+    MeshRequest result = promise->get_future().share();
+    if (!has_extension(file, ".obj")) {
+        promise->set_exception(std::make_exception_ptr(
+            std::runtime_error("failed to load mesh, unknown format: " + file)));
+        return result;
+    }
+
+    auto job = std::make_shared<ObjJob>();
+    job->finish = [this, promise, options](ObjJob &job) {
+        try {
+            auto geometry = merge_obj(job);
+            promise->set_value(stage_mesh(staging_pool, geometry, options));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    };
+    try {
+        start_obj(job, file, workers);
+    } catch (...) {
+        promise->set_exception(std::current_exception());
+    }
+    return result;
+}
+
+LoadedMesh MeshLoader::loadCooked(const std::string &file) {
+    auto start = Clock::now();
+    MappedFile mapped(file);
+    auto header = ParseMeshContainer(mapped.GetData(), mapped.GetSize());
+
+    LoadedMesh mesh{};
+    uint8_t precisions[] = {header->position_precision, header->color_precision, header->uv_precision};
+    for (auto precision: precisions) {
+        if (precision > static_cast<uint8_t>(AttributePrecision::Unorm8)) {
+            throw std::runtime_error("failed to load cooked mesh, unknown precision: " + file);
+        }
+    }
+    mesh.format = {static_cast<AttributePrecision>(precisions[0]), static_cast<AttributePrecision>(precisions[1]),
+                   static_cast<AttributePrecision>(precisions[2])};
+    if (VertexPacker::ForVertex3(mesh.format).GetStride() != header->vertex_stride) {
+        throw std::runtime_error("failed to load cooked mesh, stride does not match its format: " + file);
+    }
+
+    mesh.vertex_count = header->vertex_count;
+    mesh.index_count = header->index_count;
+    mesh.index_type = static_cast<VkIndexType>(header->index_type);
+    mesh.vertex_size = static_cast<VkDeviceSize>(header->vertex_count) * header->vertex_stride;
+    mesh.index_offset = header->index_offset - header->vertex_offset;
+    mesh.index_size = header->data_size - mesh.index_offset;
+    mesh.bounds_min = {header->bounds_min[0], header->bounds_min[1], header->bounds_min[2]};
+    mesh.bounds_max = {header->bounds_max[0], header->bounds_max[1], header->bounds_max[2]};
+
+    // vertices, padding and indices in one copy
+    mesh.staging = staging_pool.Acquire(header->data_size);
+    memcpy(mesh.staging->GetMappedData(), mapped.GetData() + header->vertex_offset, header->data_size);
+    mesh.staging->Flush(0, header->data_size);
+
+    mesh.stats.file_size = mapped.GetSize();
+    mesh.stats.chunk_count = 1;
+    mesh.stats.parse_seconds = seconds_since(start);
+    mesh.stats.total_seconds = mesh.stats.parse_seconds;
+    return mesh;
+}
+
+GpuMesh MeshLoader::Upload(const LoadedMesh &mesh) {
+    GpuMesh gpu{};
+    gpu.index_count = mesh.index_count;
+    gpu.index_type = mesh.index_type;
+    gpu.vertices = geometry_pool->Allocate(mesh.vertex_size);
+    gpu.indices = geometry_pool->Allocate(mesh.index_size, 4);
+
+    upload_manager.EnqueueBufferCopy(mesh.staging->buffer, 0, mesh.vertex_size, gpu.vertices.buffer,
+                                     gpu.vertices.offset);
+    upload_manager.EnqueueBufferCopy(mesh.staging->buffer, mesh.index_offset, mesh.index_size, gpu.indices.buffer,
+                                     gpu.indices.offset);
+    staging_pool.Release(mesh.staging, upload_manager.GetRecordingTicket());
+    return gpu;
+}
+
+void MeshLoader::Free(const GpuMesh &mesh) {
+    geometry_pool->Free(mesh.vertices);
+    geometry_pool->Free(mesh.indices);
+}
+
+void MeshLoader::Collect() {
+    staging_pool.Collect();
+}
+
+void MeshLoader::Destroy() {
+    upload_manager.WaitIdle();
+    staging_pool.Destroy();
+    geometry_pool->Destroy();
+}
+
+} // end namespace lvk
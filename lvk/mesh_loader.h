@@ -0,0 +1,131 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_MESH_LOADER_H
+#define LYH_MESH_LOADER_H
+
+#include <vulkan/vulkan.h>
+#include <glm/vec3.hpp>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "allocator.h"
+#include "buffer.h"
+#include "staging_pool.h"
+#include "thread_pool.h"
+#include "upload_manager.h"
+#include "Vertex.h"
+#include "vertex_format.h"
+
+namespace lvk {
+
+struct MeshLoadOptions {
+    // precision the Vertex3 data is staged with, see VertexPacker
+    VertexFormat format{};
+    // OptimizeVertexCache() and OptimizeVertexFetch() before staging
+    bool optimize = true;
+};
+
+struct MeshLoadStats {
+    size_t file_size = 0; // bytes read, .bin included
+    uint32_t chunk_count = 0; // parse tasks the file was split into
+    double parse_seconds = 0.0; // mapping to resolved indices, across all chunks
+    double total_seconds = 0.0; // including dedup, optimization and staging
+
+    [[nodiscard]] double ParseMegabytesPerSecond() const {
+        return parse_seconds > 0.0 ? static_cast<double>(file_size) / (1024.0 * 1024.0) / parse_seconds : 0.0;
+    }
+};
+
+// A parsed mesh before optimization and packing, corners sharing position and uv already welded.
+struct MeshGeometry {
+    std::vector<Vertex3> vertices;
+    std::vector<uint32_t> indices;
+    MeshLoadStats stats{};
+};
+
+// Parses an .obj, .gltf or .glb file with the loader's parsers, OBJ chunks spread over `workers`.
+// Blocks until done, so it must not be called from a task on `workers`.
+MeshGeometry ParseMeshFile(const std::string &file, ThreadPool &workers);
+
+// Vertices packed in `format` at offset 0 of a staging buffer borrowed from the loader's pool,
+// followed by `index_count` indices of `index_type` at `index_offset`.
+struct LoadedMesh {
+    VertexFormat format{};
+    uint32_t vertex_count = 0;
+    uint32_t index_count = 0;
+    VkIndexType index_type = VK_INDEX_TYPE_UINT32;
+    VkDeviceSize vertex_size = 0;
+    VkDeviceSize index_offset = 0;
+    VkDeviceSize index_size = 0;
+    glm::vec3 bounds_min{0.0f};
+    glm::vec3 bounds_max{0.0f};
+    MeshLoadStats stats{};
+    Buffer *staging = nullptr;
+};
+
+// Where Upload() placed a mesh in the loader's shared geometry buffers.
+struct GpuMesh {
+    BufferSlice vertices{};
+    BufferSlice indices{};
+    uint32_t index_count = 0;
+    VkIndexType index_type = VK_INDEX_TYPE_UINT32;
+};
+
+using MeshRequest = std::shared_future<LoadedMesh>;
+
+// Loads Wavefront OBJ and glTF 2.0 (.gltf with external buffers, or .glb) meshes on a worker pool.
+// Files are memory mapped. OBJ text is split into line aligned chunks that are parsed on separate
+// workers, the last chunk to finish merges them, welds corners sharing position and uv, and
+// writes the packed vertices and narrowed indices straight into pooled staging memory. glTF
+// data is already binary and indexed, each file is converted on one worker.
+// Meshes cooked by mesh_cook (MESH_CONTAINER_EXTENSION) are already optimized and packed, they
+// are copied from the mapping into staging as they are, with the format they were cooked with.
+// All primitives of a glTF file are merged into one mesh in mesh space, node transforms and
+// materials are ignored. OBJ normals are skipped, Vertex3 has no slot for them; per vertex colors
+// (`v x y z r g b`) are kept, white otherwise.
+//
+// Upload() copies into device local buffers shared by every mesh, call it from the render thread.
+class MeshLoader {
+public:
+    // OBJ bytes per parse task
+    static constexpr size_t CHUNK_SIZE = 1024 * 1024;
+
+    explicit MeshLoader(Allocator &allocator, UploadManager &upload_manager, uint32_t thread_count = 0);
+
+    MeshLoader(const MeshLoader &) = delete;
+
+    MeshLoader &operator=(const MeshLoader &) = delete;
+
+    // Starts loading on the workers, get() on the result blocks until the mesh is staged and
+    // rethrows parse errors. The format is picked by extension: .obj, .gltf, .glb or .lmsh;
+    // `options` don't apply to cooked .lmsh meshes.
+    MeshRequest Load(const std::string &file, const MeshLoadOptions &options = {});
+
+    // Queue the copy of `mesh` into the shared geometry buffers and hand the staging buffer back
+    // to the pool once that upload has finished. Draws may use the result after the upload's
+    // ticket completes.
+    GpuMesh Upload(const LoadedMesh &mesh);
+
+    void Free(const GpuMesh &mesh);
+
+    // Move staging buffers of completed uploads back to the free list.
+    void Collect();
+
+    void Destroy();
+
+private:
+    LoadedMesh loadCooked(const std::string &file);
+
+    UploadManager &upload_manager;
+    StagingPool staging_pool;
+    std::unique_ptr<BufferPool> geometry_pool;
+    ThreadPool workers;
+};
+
+} // end namespace lvk
+
+#endif //LYH_MESH_LOADER_H
@@ -0,0 +1,445 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace lvk {
+namespace {
+// Forsyth's constants, tuned for caches of 16 to 32 entries
+constexpr uint32_t CACHE_SIZE = 32;
+constexpr uint32_t MAX_VALENCE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+constexpr uint32_t INVALID_TRIANGLE = std::numeric_limits<uint32_t>::max();
+
+struct ScoreTables {
+    float cache[CACHE_SIZE];
+    float valence[MAX_VALENCE + 1];
+
+    ScoreTables() {
+        for (uint32_t i = 0; i < CACHE_SIZE; i++) {
+            // the three vertices of the last triangle score the same, whatever order they went in
+            cache[i] = i < 3
+                           ? LAST_TRIANGLE_SCORE
+                           : std::pow(1.0f - static_cast<float>(i - 3) / (CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        valence[0] = 0.0f;
+        for (uint32_t i = 1; i <= MAX_VALENCE; i++) {
+            // finishing off vertices with few triangles left gets them out of the way
+            valence[i] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(i), -VALENCE_BOOST_POWER);
+        }
+    }
+};
+
+const ScoreTables &score_tables() {
+    static const ScoreTables tables;
+    return tables;
+}
+
+float vertex_score(int32_t cache_position, uint32_t valence) {
+    if (valence == 0) {
+        return -1.0f;
+    }
+    auto const &tables = score_tables();
+    float score = cache_position < 0 ? 0.0f : tables.cache[cache_position];
+    return score + tables.valence[std::min(valence, MAX_VALENCE)];
+}
+
+// cache OptimizeOverdraw() measures cluster ACMR with, the common hardware size
+constexpr uint32_t OVERDRAW_CACHE_SIZE = 16;
+// side of the square depth buffer AnalyzeOverdraw() renders into
+constexpr int32_t OVERDRAW_VIEWPORT = 256;
+
+// FIFO post-transform cache: a vertex is cached while fewer than `size` misses happened since its own.
+class FifoCache {
+public:
+    FifoCache(size_t vertex_count, uint32_t size) : timestamps(vertex_count, 0), timestamp(size + 1), size(size) {
+    }
+
+    // 1 on a miss
+    uint32_t Access(uint32_t vertex) {
+        if (timestamp - timestamps[vertex] > size) {
+            timestamps[vertex] = timestamp++;
+            return 1;
+        }
+        return 0;
+    }
+
+    uint32_t AccessTriangle(const uint32_t *triangle) {
+        return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+    }
+
+    // forget everything, as if a new draw started here
+    void Flush() {
+        timestamp += size + 1;
+    }
+
+private:
+    std::vector<uint32_t> timestamps;
+    uint32_t timestamp;
+    uint32_t size;
+};
+} // namespace
+
+void OptimizeVertexCache(uint32_t *destination, const uint32_t *indices, size_t index_count, size_t vertex_count) {
+    size_t triangle_count = index_count / 3;
+    std::vector<uint32_t> source(indices, indices + triangle_count * 3);
+
+    // the triangles of every vertex, the ones not emitted yet kept at the front of each range
+    std::vector<uint32_t> valence(vertex_count, 0);
+    for (auto index: source) {
+        valence[index]++;
+    }
+    std::vector<uint32_t> offsets(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] = offsets[v] + valence[v];
+    }
+    std::vector<uint32_t> adjacency(source.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < source.size(); i++) {
+        adjacency[fill[source[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<int32_t> cache_positions(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) {
+        vertex_scores[v] = vertex_score(-1, valence[v]);
+    }
+
+    std::vector<float> triangle_scores(triangle_count);
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    uint32_t best = INVALID_TRIANGLE;
+    float best_score = -std::numeric_limits<float>::max();
+    for (size_t t = 0; t < triangle_count; t++) {
+        triangle_scores[t] = vertex_scores[source[t * 3]] + vertex_scores[source[t * 3 + 1]] +
+                             vertex_scores[source[t * 3 + 2]];
+        if (triangle_scores[t] > best_score) {
+            best_score = triangle_scores[t];
+            best = static_cast<uint32_t>(t);
+        }
+    }
+
+    uint32_t cache[CACHE_SIZE + 3];
+    uint32_t cache_count = 0;
+    size_t cursor = 0;
+    for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+        if (best == INVALID_TRIANGLE) {
+            // nothing left around the cache, carry on with the next triangle in input order
+            while (emitted[cursor]) {
+                cursor++;
+            }
+            best = static_cast<uint32_t>(cursor);
+        }
+        const uint32_t *triangle = &source[best * 3];
+        memcpy(destination + emitted_count * 3, triangle, 3 * sizeof(uint32_t));
+        emitted[best] = 1;
+
+        // the triangle's vertices go to the front, the rest of the cache shifts back
+        uint32_t next_cache[CACHE_SIZE + 3];
+        uint32_t next_count = 0;
+        for (uint32_t k = 0; k < 3; k++) {
+            uint32_t v = triangle[k];
+            uint32_t *begin = &adjacency[offsets[v]];
+            uint32_t *end = begin + valence[v];
+            *std::find(begin, end, best) = *(end - 1);
+            valence[v]--;
+            if (std::find(next_cache, next_cache + next_count, v) == next_cache + next_count) {
+                next_cache[next_count++] = v;
+            }
+        }
+        for (uint32_t i = 0; i < cache_count; i++) {
+            uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                next_cache[next_count++] = v;
+            }
+        }
+
+        // rescore the vertices that moved, including the ones pushed out, and their triangles
+        for (uint32_t i = 0; i < next_count; i++) {
+            uint32_t v = next_cache[i];
+            cache_positions[v] = i < CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+            float score = vertex_score(cache_positions[v], valence[v]);
+            float delta = score - vertex_scores[v];
+            vertex_scores[v] = score;
+            for (uint32_t j = offsets[v]; j < offsets[v] + valence[v]; j++) {
+                triangle_scores[adjacency[j]] += delta;
+            }
+        }
+
+        best = INVALID_TRIANGLE;
+        best_score = -std::numeric_limits<float>::max();
+        cache_count = std::min(next_count, CACHE_SIZE);
+        for (uint32_t i = 0; i < cache_count; i++) {
+            uint32_t v = next_cache[i];
+            cache[i] = v;
+            for (uint32_t j = offsets[v]; j < offsets[v] + valence[v]; j++) {
+                if (triangle_scores[adjacency[j]] > best_score) {
+                    best_score = triangle_scores[adjacency[j]];
+                    best = adjacency[j];
+                }
+            }
+        }
+    }
+}
+
+size_t OptimizeVertexFetch(void *vertices, size_t vertex_count, size_t vertex_size, uint32_t *indices,
+                           size_t index_count) {
+    constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertex_count, UNUSED);
+    uint32_t next = 0;
+    for (size_t i = 0; i < index_count; i++) {
+        uint32_t &target = remap[indices[i]];
+        if (target == UNUSED) {
+            target = next++;
+        }
+        indices[i] = target;
+    }
+
+    auto *bytes = static_cast<uint8_t *>(vertices);
+    std::vector<uint8_t> original(bytes, bytes + vertex_count * vertex_size);
+    for (size_t v = 0; v < vertex_count; v++) {
+        if (remap[v] != UNUSED) {
+            memcpy(bytes + remap[v] * vertex_size, &original[v * vertex_size], vertex_size);
+        }
+    }
+    return next;
+}
+
+void OptimizeOverdraw(uint32_t *destination, const uint32_t *indices, size_t index_count, const float *positions,
+                      size_t vertex_count, size_t position_stride, float threshold) {
+    auto triangle_count = static_cast<uint32_t>(index_count / 3);
+    if (triangle_count == 0) {
+        return;
+    }
+    FifoCache cache(vertex_count, OVERDRAW_CACHE_SIZE);
+
+    // hard boundaries where all three vertices miss, the cache started over there anyway
+    std::vector<uint32_t> hard;
+    for (uint32_t t = 0; t < triangle_count; t++) {
+        if (cache.AccessTriangle(&indices[t * 3]) == 3 || t == 0) {
+            hard.push_back(t);
+        }
+    }
+    hard.push_back(triangle_count);
+
+    // soft boundaries inside each run, wherever the cluster so far is already within threshold of
+    // the run's ACMR: cutting there costs little vertex reuse
+    std::vector<uint32_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); h++) {
+        uint32_t begin = hard[h];
+        uint32_t end = hard[h + 1];
+
+        cache.Flush();
+        uint32_t misses = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            misses += cache.AccessTriangle(&indices[t * 3]);
+        }
+        float target = threshold * static_cast<float>(misses) / static_cast<float>(end - begin);
+
+        cache.Flush();
+        size_t first = clusters.size();
+        clusters.push_back(begin);
+        uint32_t running_misses = 0;
+        uint32_t running_triangles = 0;
+        for (uint32_t t = begin; t < end; t++) {
+            running_misses += cache.AccessTriangle(&indices[t * 3]);
+            running_triangles++;
+            if (static_cast<float>(running_misses) <= target * static_cast<float>(running_triangles) && t + 1 < end) {
+                clusters.push_back(t + 1);
+                cache.Flush();
+                running_misses = 0;
+                running_triangles = 0;
+            }
+        }
+        // a tail that never got there is folded into the cluster before it
+        if (clusters.size() - first > 1 &&
+            static_cast<float>(running_misses) > target * static_cast<float>(running_triangles)) {
+            clusters.pop_back();
+        }
+    }
+    clusters.push_back(triangle_count);
+    size_t cluster_count = clusters.size() - 1;
+
+    auto position = [&](uint32_t vertex) {
+        return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) +
+                                               vertex * position_stride);
+    };
+
+    float center[3] = {0.0f, 0.0f, 0.0f};
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        for (int k = 0; k < 3; k++) {
+            center[k] += position(v)[k] / static_cast<float>(vertex_count);
+        }
+    }
+
+    // clusters facing away from the centre go first, they are the ones in front from most views
+    std::vector<float> keys(cluster_count);
+    for (size_t c = 0; c < cluster_count; c++) {
+        float centroid[3] = {0.0f, 0.0f, 0.0f};
+        float normal[3] = {0.0f, 0.0f, 0.0f};
+        float area_sum = 0.0f;
+        for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const float *p0 = position(indices[t * 3]);
+            const float *p1 = position(indices[t * 3 + 1]);
+            const float *p2 = position(indices[t * 3 + 2]);
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int k = 0; k < 3; k++) {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+                normal[k] += n[k];
+            }
+            area_sum += area;
+        }
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (area_sum <= 0.0f || length <= 0.0f) {
+            keys[c] = 0.0f;
+            continue;
+        }
+        float key = 0.0f;
+        for (int k = 0; k < 3; k++) {
+            key += (centroid[k] / area_sum - center[k]) * normal[k];
+        }
+        keys[c] = key / length;
+    }
+
+    std::vector<uint32_t> order(cluster_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+    size_t written = 0;
+    for (auto c: order) {
+        size_t count = static_cast<size_t>(clusters[c + 1] - clusters[c]) * 3;
+        memcpy(destination + written, indices + static_cast<size_t>(clusters[c]) * 3, count * sizeof(uint32_t));
+        written += count;
+    }
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t *indices, size_t index_count, size_t vertex_count,
+                                    uint32_t cache_size) {
+    FifoCache cache(vertex_count, cache_size);
+    size_t misses = 0;
+    for (size_t i = 0; i < index_count; i++) {
+        misses += cache.Access(indices[i]);
+    }
+
+    VertexCacheStats stats{};
+    if (index_count >= 3) {
+        stats.acmr = static_cast<float>(misses) / static_cast<float>(index_count / 3);
+    }
+    if (vertex_count > 0) {
+        stats.atvr = static_cast<float>(misses) / static_cast<float>(vertex_count);
+    }
+    return stats;
+}
+
+OverdrawStats AnalyzeOverdraw(const uint32_t *indices, size_t index_count, const float *positions,
+                              size_t vertex_count, size_t position_stride) {
+    OverdrawStats stats{};
+    if (index_count < 3 || vertex_count == 0) {
+        return stats;
+    }
+
+    // into the unit cube, one scale for all axes so the views keep the mesh's proportions
+    float low[3];
+    float high[3];
+    for (int k = 0; k < 3; k++) {
+        low[k] = std::numeric_limits<float>::max();
+        high[k] = std::numeric_limits<float>::lowest();
+    }
+    for (size_t v = 0; v < vertex_count; v++) {
+        auto *p = reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + v * position_stride);
+        for (int k = 0; k < 3; k++) {
+            low[k] = std::min(low[k], p[k]);
+            high[k] = std::max(high[k], p[k]);
+        }
+    }
+    float extent = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2]});
+    float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+    std::vector<float> normalized(vertex_count * 3);
+    for (size_t v = 0; v < vertex_count; v++) {
+        auto *p = reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + v * position_stride);
+        for (int k = 0; k < 3; k++) {
+            normalized[v * 3 + k] = (p[k] - low[k]) * scale;
+        }
+    }
+
+    constexpr float FAR = std::numeric_limits<float>::max();
+    constexpr auto SIZE = static_cast<float>(OVERDRAW_VIEWPORT - 1);
+    std::vector<float> depth(static_cast<size_t>(OVERDRAW_VIEWPORT) * OVERDRAW_VIEWPORT);
+    for (int axis = 0; axis < 3; axis++) {
+        for (int direction = 0; direction < 2; direction++) {
+            std::fill(depth.begin(), depth.end(), FAR);
+
+            for (size_t i = 0; i + 2 < index_count; i += 3) {
+                float x[3];
+                float y[3];
+                float z[3];
+                for (int k = 0; k < 3; k++) {
+                    const float *p = &normalized[static_cast<size_t>(indices[i + k]) * 3];
+                    x[k] = p[(axis + 1) % 3] * SIZE;
+                    y[k] = p[(axis + 2) % 3] * SIZE;
+                    z[k] = direction == 0 ? p[axis] : 1.0f - p[axis];
+                }
+
+                // the area's sign is that of the normal along the axis: from the low side (direction
+                // 0) front faces have it negative, from the high side positive
+                float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+                if (direction == 0 ? area >= 0.0f : area <= 0.0f) {
+                    continue;
+                }
+
+                auto min_x = static_cast<int32_t>(std::floor(std::min({x[0], x[1], x[2]})));
+                auto max_x = static_cast<int32_t>(std::ceil(std::max({x[0], x[1], x[2]})));
+                auto min_y = static_cast<int32_t>(std::floor(std::min({y[0], y[1], y[2]})));
+                auto max_y = static_cast<int32_t>(std::ceil(std::max({y[0], y[1], y[2]})));
+                min_x = std::max(min_x, 0);
+                min_y = std::max(min_y, 0);
+                max_x = std::min(max_x, OVERDRAW_VIEWPORT - 1);
+                max_y = std::min(max_y, OVERDRAW_VIEWPORT - 1);
+
+                // edge functions at pixel centres, each one weights the vertex opposite its edge
+                for (int32_t py = min_y; py <= max_y; py++) {
+                    float sy = static_cast<float>(py) + 0.5f;
+                    for (int32_t px = min_x; px <= max_x; px++) {
+                        float sx = static_cast<float>(px) + 0.5f;
+                        float w0 = (x[2] - x[1]) * (sy - y[1]) - (y[2] - y[1]) * (sx - x[1]);
+                        float w1 = (x[0] - x[2]) * (sy - y[2]) - (y[0] - y[2]) * (sx - x[2]);
+                        float w2 = (x[1] - x[0]) * (sy - y[0]) - (y[1] - y[0]) * (sx - x[0]);
+                        if (area > 0.0f ? (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                                        : (w0 > 0.0f || w1 > 0.0f || w2 > 0.0f)) {
+                            continue;
+                        }
+                        float fragment = (w0 * z[0] + w1 * z[1] + w2 * z[2]) / area;
+                        float &stored = depth[static_cast<size_t>(py) * OVERDRAW_VIEWPORT + px];
+                        if (fragment < stored) {
+                            stored = fragment;
+                            stats.pixels_shaded++;
+                        }
+                    }
+                }
+            }
+
+            for (float value: depth) {
+                stats.pixels_covered += value != FAR;
+            }
+        }
+    }
+
+    if (stats.pixels_covered > 0) {
+        stats.overdraw = static_cast<float>(stats.pixels_shaded) / static_cast<float>(stats.pixels_covered);
+    }
+    return stats;
+}
+
+} // end namespace lvk
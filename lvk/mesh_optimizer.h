@@ -0,0 +1,70 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_MESH_OPTIMIZER_H
+#define LYH_MESH_OPTIMIZER_H
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lvk {
+
+struct VertexCacheStats {
+    float acmr = 0.0f; // vertex shader invocations per triangle, 0.5 is ideal for a regular grid
+    float atvr = 0.0f; // vertex shader invocations per vertex, 1 is ideal
+};
+
+struct OverdrawStats {
+    uint64_t pixels_covered = 0;
+    uint64_t pixels_shaded = 0;
+    float overdraw = 0.0f; // fragments shaded per covered pixel, 1 is ideal
+};
+
+// uint16 indices whenever every vertex is addressable with them.
+inline VkIndexType SelectIndexType(size_t vertex_count) {
+    return vertex_count <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+// Reorders triangles for the post-transform vertex cache with Tom Forsyth's linear-speed
+// algorithm: triangles are emitted greedily by the score of their vertices, which favours
+// vertices still in a simulated LRU cache and vertices with few triangles left. `destination`
+// may be `indices`.
+void OptimizeVertexCache(uint32_t *destination, const uint32_t *indices, size_t index_count, size_t vertex_count);
+
+// Reorders the triangles of a cache optimized index buffer so that outward facing parts of the
+// mesh are drawn first and hide what is behind them, after Sander et al., "Fast Triangle
+// Reordering for Vertex Locality and Reduced Overdraw". The buffer is cut into clusters where the
+// simulated vertex cache restarts anyway, and further wherever the cluster's ACMR has got within
+// `threshold` of the whole run's, then the clusters are sorted by how far they face away from the
+// mesh centre. 1.05 trades up to 5% ACMR for overdraw. `destination` must not be `indices`.
+void OptimizeOverdraw(uint32_t *destination, const uint32_t *indices, size_t index_count, const float *positions,
+                      size_t vertex_count, size_t position_stride, float threshold = 1.05f);
+
+// Reorders vertices into the order the indices first reference them and rewrites the indices,
+// so vertex fetch walks memory forward. Unreferenced vertices are dropped; returns the vertex
+// count left. Run it after OptimizeVertexCache().
+size_t OptimizeVertexFetch(void *vertices, size_t vertex_count, size_t vertex_size, uint32_t *indices,
+                           size_t index_count);
+
+template<typename V>
+void OptimizeVertexFetch(std::vector<V> &vertices, std::vector<uint32_t> &indices) {
+    size_t count = OptimizeVertexFetch(vertices.data(), vertices.size(), sizeof(V), indices.data(), indices.size());
+    vertices.erase(vertices.begin() + static_cast<ptrdiff_t>(count), vertices.end());
+}
+
+// Simulates a FIFO post-transform cache of `cache_size` entries, the model most GPUs are closest to.
+VertexCacheStats AnalyzeVertexCache(const uint32_t *indices, size_t index_count, size_t vertex_count,
+                                    uint32_t cache_size = 16);
+
+// Rasterizes the mesh in submission order from the six axis directions into a small depth buffer,
+// with back faces culled and a less-than depth test, and counts the fragments that pass against the
+// pixels left covered. `position_stride` is in bytes.
+OverdrawStats AnalyzeOverdraw(const uint32_t *indices, size_t index_count, const float *positions,
+                              size_t vertex_count, size_t position_stride);
+
+} // end namespace lvk
+
+#endif //LYH_MESH_OPTIMIZER_H
@@ -0,0 +1,299 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace lvk {
+namespace {
+constexpr uint32_t NO_LOCAL = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+// narrower than this and the cone test is both unstable and hardly ever passes
+constexpr float MIN_CONE_DOT = 0.1f;
+
+struct MeshletBuilder {
+    MeshletBuilder(const uint32_t *indices, const float *positions, size_t position_stride)
+        : indices(indices), positions(positions), position_stride(position_stride) {
+    }
+
+    const uint32_t *indices;
+    const float *positions;
+    size_t position_stride;
+
+    // triangles using each vertex, CSR
+    std::vector<uint32_t> adjacency_offsets;
+    std::vector<uint32_t> adjacency;
+    std::vector<bool> emitted;
+    // unused triangles left around each vertex
+    std::vector<uint32_t> live;
+    // index into `vertices` of each mesh vertex while it is part of the open meshlet
+    std::vector<uint32_t> local;
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> triangles;
+    // sum of the open meshlet's vertex positions
+    float position_sum[3] = {0.0f, 0.0f, 0.0f};
+
+    const float *position(uint32_t vertex) const {
+        return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) +
+                                               vertex * position_stride);
+    }
+
+    // distinct vertices of `triangle` not in the open meshlet yet
+    uint32_t newVertices(uint32_t triangle) const {
+        const uint32_t *corners = &indices[triangle * 3];
+        uint32_t count = local[corners[0]] == NO_LOCAL;
+        count += local[corners[1]] == NO_LOCAL && corners[1] != corners[0];
+        count += local[corners[2]] == NO_LOCAL && corners[2] != corners[0] && corners[2] != corners[1];
+        return count;
+    }
+
+    void add(uint32_t triangle) {
+        uint32_t packed = 0;
+        for (uint32_t k = 0; k < 3; k++) {
+            uint32_t vertex = indices[triangle * 3 + k];
+            if (local[vertex] == NO_LOCAL) {
+                local[vertex] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(vertex);
+                for (int axis = 0; axis < 3; axis++) {
+                    position_sum[axis] += position(vertex)[axis];
+                }
+            }
+            packed |= local[vertex] << (k * 8);
+        }
+        triangles.push_back(packed);
+        emitted[triangle] = true;
+        for (uint32_t k = 0; k < 3; k++) {
+            live[indices[triangle * 3 + k]]--;
+        }
+    }
+
+    // The unused neighbour adding the fewest vertices; on ties the one with the fewest unused
+    // triangles around it, which fills corners before they turn into pockets only a tiny meshlet
+    // can pick up later, then the one closest to the meshlet's centre, so meshlets grow round
+    // rather than along a strip and fill up before they run out of vertices.
+    uint32_t next(uint32_t max_vertices) const {
+        float center[3];
+        for (int axis = 0; axis < 3; axis++) {
+            center[axis] = position_sum[axis] / static_cast<float>(vertices.size());
+        }
+
+        uint32_t best = NO_TRIANGLE;
+        uint32_t best_new = 4;
+        uint32_t best_live = 0;
+        float best_distance = std::numeric_limits<float>::max();
+        for (auto vertex: vertices) {
+            for (uint32_t i = adjacency_offsets[vertex]; i < adjacency_offsets[vertex + 1]; i++) {
+                uint32_t triangle = adjacency[i];
+                if (emitted[triangle]) {
+                    continue;
+                }
+                uint32_t added = newVertices(triangle);
+                if (added > best_new || vertices.size() + added > max_vertices) {
+                    continue;
+                }
+                const uint32_t *corners = &indices[triangle * 3];
+                uint32_t around = live[corners[0]] + live[corners[1]] + live[corners[2]];
+                if (added == best_new && around > best_live) {
+                    continue;
+                }
+                float distance = 0.0f;
+                for (int axis = 0; axis < 3; axis++) {
+                    float d = (position(corners[0])[axis] + position(corners[1])[axis] +
+                               position(corners[2])[axis]) / 3.0f - center[axis];
+                    distance += d * d;
+                }
+                if (added < best_new || around < best_live || distance < best_distance) {
+                    best = triangle;
+                    best_new = added;
+                    best_live = around;
+                    best_distance = distance;
+                }
+            }
+        }
+        return best;
+    }
+
+    MeshletBounds bounds() const {
+        MeshletBounds result{};
+
+        // centre of the box, then the farthest vertex: a little looser than a minimal sphere
+        float low[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                        std::numeric_limits<float>::max()};
+        float high[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                         std::numeric_limits<float>::lowest()};
+        for (auto vertex: vertices) {
+            const float *p = position(vertex);
+            for (int k = 0; k < 3; k++) {
+                low[k] = std::min(low[k], p[k]);
+                high[k] = std::max(high[k], p[k]);
+            }
+        }
+        for (int k = 0; k < 3; k++) {
+            result.center[k] = (low[k] + high[k]) * 0.5f;
+        }
+        float radius_squared = 0.0f;
+        for (auto vertex: vertices) {
+            const float *p = position(vertex);
+            float d[3] = {p[0] - result.center[0], p[1] - result.center[1], p[2] - result.center[2]};
+            radius_squared = std::max(radius_squared, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        }
+        result.radius = std::sqrt(radius_squared);
+
+        std::vector<float> normals;
+        normals.reserve(triangles.size() * 3);
+        float axis[3] = {0.0f, 0.0f, 0.0f};
+        for (auto packed: triangles) {
+            const float *p0 = position(vertices[packed & 0xFF]);
+            const float *p1 = position(vertices[(packed >> 8) & 0xFF]);
+            const float *p2 = position(vertices[(packed >> 16) & 0xFF]);
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length == 0.0f) {
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                normals.push_back(n[k] / length);
+                axis[k] += n[k] / length;
+            }
+        }
+
+        // no cone unless every normal is well within 90 degrees of the mean
+        result.cone_cutoff = 1.0f;
+        float axis_length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        if (normals.empty() || axis_length == 0.0f) {
+            return result;
+        }
+        float min_dot = 1.0f;
+        for (int k = 0; k < 3; k++) {
+            result.cone_axis[k] = axis[k] / axis_length;
+        }
+        for (size_t i = 0; i < normals.size(); i += 3) {
+            min_dot = std::min(min_dot, normals[i] * result.cone_axis[0] + normals[i + 1] * result.cone_axis[1] +
+                                        normals[i + 2] * result.cone_axis[2]);
+        }
+        if (min_dot > MIN_CONE_DOT) {
+            result.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+        }
+        return result;
+    }
+
+    // An unused triangle next to the open meshlet, the one with the fewest unused triangles around
+    // it: starting in corners of what is left keeps the remaining region from turning ragged.
+    uint32_t seed() const {
+        uint32_t best = NO_TRIANGLE;
+        uint32_t best_live = std::numeric_limits<uint32_t>::max();
+        for (auto vertex: vertices) {
+            for (uint32_t i = adjacency_offsets[vertex]; i < adjacency_offsets[vertex + 1]; i++) {
+                uint32_t triangle = adjacency[i];
+                if (emitted[triangle]) {
+                    continue;
+                }
+                uint32_t around = live[indices[triangle * 3]] + live[indices[triangle * 3 + 1]] +
+                                  live[indices[triangle * 3 + 2]];
+                if (around < best_live) {
+                    best = triangle;
+                    best_live = around;
+                }
+            }
+        }
+        return best;
+    }
+
+    void flush(MeshletMesh &mesh) {
+        if (triangles.empty()) {
+            return;
+        }
+        mesh.meshlets.push_back({static_cast<uint32_t>(mesh.vertices.size()),
+                                 static_cast<uint32_t>(mesh.triangles.size()),
+                                 static_cast<uint32_t>(vertices.size()),
+                                 static_cast<uint32_t>(triangles.size())});
+        mesh.bounds.push_back(bounds());
+        mesh.vertices.insert(mesh.vertices.end(), vertices.begin(), vertices.end());
+        mesh.triangles.insert(mesh.triangles.end(), triangles.begin(), triangles.end());
+
+        for (auto vertex: vertices) {
+            local[vertex] = NO_LOCAL;
+        }
+        vertices.clear();
+        triangles.clear();
+        position_sum[0] = position_sum[1] = position_sum[2] = 0.0f;
+    }
+};
+} // namespace
+
+MeshletMesh BuildMeshlets(const uint32_t *indices, size_t index_count, const float *positions, size_t vertex_count,
+                          size_t position_stride, uint32_t max_vertices, uint32_t max_triangles) {
+    // local indices are stored in 8 bits
+    if (max_vertices < 3 || max_vertices > 256 || max_triangles == 0) {
+        throw std::runtime_error("failed to build meshlets, limits out of range!");
+    }
+    auto triangle_count = static_cast<uint32_t>(index_count / 3);
+
+    MeshletBuilder builder(indices, positions, position_stride);
+    builder.adjacency_offsets.assign(vertex_count + 1, 0);
+    for (size_t i = 0; i < triangle_count * 3; i++) {
+        if (indices[i] >= vertex_count) {
+            throw std::runtime_error("failed to build meshlets, index out of range!");
+        }
+        builder.adjacency_offsets[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertex_count; v++) {
+        builder.adjacency_offsets[v + 1] += builder.adjacency_offsets[v];
+    }
+    builder.adjacency.resize(triangle_count * 3);
+    std::vector<uint32_t> fill(builder.adjacency_offsets.begin(), builder.adjacency_offsets.end() - 1);
+    for (uint32_t t = 0; t < triangle_count; t++) {
+        for (uint32_t k = 0; k < 3; k++) {
+            builder.adjacency[fill[indices[t * 3 + k]]++] = t;
+        }
+    }
+    builder.emitted.assign(triangle_count, false);
+    builder.local.assign(vertex_count, NO_LOCAL);
+
+    MeshletMesh mesh{};
+    // meshlet vertices stay below one per triangle, border vertices repeat in each meshlet
+    mesh.meshlets.reserve(triangle_count / max_triangles + 1);
+    mesh.triangles.reserve(triangle_count);
+    mesh.vertices.reserve(triangle_count);
+
+    builder.live.resize(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) {
+        builder.live[v] = builder.adjacency_offsets[v + 1] - builder.adjacency_offsets[v];
+    }
+
+    uint32_t cursor = 0;
+    uint32_t seed = NO_TRIANGLE;
+    while (true) {
+        // nothing unused next to the last meshlet, carry on in index order
+        if (seed == NO_TRIANGLE) {
+            while (cursor < triangle_count && builder.emitted[cursor]) {
+                cursor++;
+            }
+            if (cursor == triangle_count) {
+                break;
+            }
+            seed = cursor;
+        }
+
+        builder.add(seed);
+        while (builder.triangles.size() < max_triangles) {
+            uint32_t triangle = builder.next(max_vertices);
+            if (triangle == NO_TRIANGLE) {
+                break;
+            }
+            builder.add(triangle);
+        }
+        seed = builder.seed();
+        builder.flush(mesh);
+    }
+    return mesh;
+}
+
+} // end namespace lvk
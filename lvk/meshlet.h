@@ -0,0 +1,84 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_MESHLET_H
+#define LYH_MESHLET_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lvk {
+
+// NVIDIA's recommended limits, they fit every VK_EXT_mesh_shader implementation's minimums
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// Ranges into MeshletMesh::vertices and MeshletMesh::triangles, 16 bytes as the shaders read it.
+struct Meshlet {
+    uint32_t vertex_offset;
+    uint32_t triangle_offset;
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+};
+
+// A sphere around the meshlet and a cone holding all of its triangle normals, 32 bytes as the
+// task shader reads it. cone_cutoff is the sine of the cone's half angle, 1 when the normals
+// spread too far for the cone to ever cull.
+struct MeshletBounds {
+    float center[3];
+    float radius;
+    float cone_axis[3];
+    float cone_cutoff;
+};
+
+struct MeshletMesh {
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshletBounds> bounds;
+    // mesh vertex index of each meshlet local vertex
+    std::vector<uint32_t> vertices;
+    // one per triangle, the three meshlet local vertex indices in bits 0-7, 8-15 and 16-23
+    std::vector<uint32_t> triangles;
+};
+
+// Splits a triangle list into meshlets of at most `max_vertices` vertices and `max_triangles`
+// triangles. Each meshlet grows from a seed triangle by repeatedly taking the neighbouring triangle
+// that adds the fewest new vertices and is closed once nothing adjacent fits; the next one starts
+// next to it, so consecutive meshlets stay close. `position_stride` is in bytes, triangles are
+// expected counter-clockwise when seen from the front.
+MeshletMesh BuildMeshlets(const uint32_t *indices, size_t index_count, const float *positions, size_t vertex_count,
+                          size_t position_stride, uint32_t max_vertices = MESHLET_MAX_VERTICES,
+                          uint32_t max_triangles = MESHLET_MAX_TRIANGLES);
+
+// The tests meshlet.task runs per meshlet, for the CPU side and to check the shader against.
+// Everything is in mesh space: `camera_position` and the frustum planes (a, b, c, d with ax + by
+// + cz + d >= 0 inside) are transformed into it.
+inline bool IsMeshletBackfacing(const MeshletBounds &bounds, const float camera_position[3]) {
+    float to_center[3] = {bounds.center[0] - camera_position[0], bounds.center[1] - camera_position[1],
+                          bounds.center[2] - camera_position[2]};
+    float distance = std::sqrt(to_center[0] * to_center[0] + to_center[1] * to_center[1] +
+                               to_center[2] * to_center[2]);
+    float along_axis = to_center[0] * bounds.cone_axis[0] + to_center[1] * bounds.cone_axis[1] +
+                       to_center[2] * bounds.cone_axis[2];
+    // every point of the sphere sees every normal of the cone from behind
+    return along_axis >= bounds.cone_cutoff * distance + bounds.radius;
+}
+
+inline bool IsMeshletOutsideFrustum(const MeshletBounds &bounds, const float planes[6][4]) {
+    for (int i = 0; i < 6; i++) {
+        float length = std::sqrt(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] +
+                                 planes[i][2] * planes[i][2]);
+        float distance = planes[i][0] * bounds.center[0] + planes[i][1] * bounds.center[1] +
+                         planes[i][2] * bounds.center[2] + planes[i][3];
+        if (distance < -bounds.radius * length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // end namespace lvk
+
+#endif //LYH_MESHLET_H
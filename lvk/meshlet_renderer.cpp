@@ -0,0 +1,192 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "meshlet_renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace lvk {
+static constexpr const char *MESHLET_TASK = "../shaders/meshlet.task";
+static constexpr const char *MESHLET_MESH = "../shaders/meshlet.mesh";
+static constexpr const char *MESHLET_FRAG = "../shaders/meshlet.frag";
+
+namespace {
+constexpr uint32_t BINDING_COUNT = 5;
+
+// VK_EXT_mesh_shader needs SPIR-V 1.4, which on a 1.1 device comes with these two
+const std::vector<const char *> MESH_SHADER_EXTENSIONS = {
+    VK_EXT_MESH_SHADER_EXTENSION_NAME,
+    VK_KHR_SPIRV_1_4_EXTENSION_NAME,
+    VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME,
+};
+
+VkPhysicalDeviceMeshShaderFeaturesEXT required_features() {
+    VkPhysicalDeviceMeshShaderFeaturesEXT features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+    features.taskShader = VK_TRUE;
+    features.meshShader = VK_TRUE;
+    return features;
+}
+} // namespace
+
+void MeshletRenderer::RequireFeatures(PhysicalDeviceSelector &selector) {
+    selector.AddRequiredExtensions(MESH_SHADER_EXTENSIONS);
+    selector.AddRequiredExtensionFeatures(required_features());
+}
+
+bool MeshletRenderer::EnableFeaturesIfPresent(PhysicalDevice &physical_device) {
+    for (auto extension: MESH_SHADER_EXTENSIONS) {
+        if (!physical_device.IsExtensionPresent(extension)) {
+            return false;
+        }
+    }
+    if (!physical_device.EnableExtensionFeaturesIfPresent(required_features())) {
+        return false;
+    }
+    return physical_device.EnableExtensionsIfPresent(MESH_SHADER_EXTENSIONS);
+}
+
+bool MeshletRenderer::IsSupported(const Device &device) {
+    return std::all_of(MESH_SHADER_EXTENSIONS.begin(), MESH_SHADER_EXTENSIONS.end(), [&](const char *extension) {
+               return device.IsExtensionEnabled(extension);
+           }) &&
+           device.AreExtensionFeaturesEnabled(required_features());
+}
+
+MeshletRenderer::MeshletRenderer(RenderContext &context) : context(context) {
+    auto &device = context.GetContext().device;
+    if (!IsSupported(device)) {
+        throw std::runtime_error("meshlet renderer needs VK_EXT_mesh_shader!");
+    }
+    // an extension command, the loader does not export it
+    cmd_draw_mesh_tasks = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(
+        vkGetDeviceProcAddr(device.device, "vkCmdDrawMeshTasksEXT"));
+    if (!cmd_draw_mesh_tasks) {
+        throw std::runtime_error("failed to load vkCmdDrawMeshTasksEXT!");
+    }
+    storage_alignment = std::max<VkDeviceSize>(
+        device.physical_device.properties.limits.minStorageBufferOffsetAlignment, 16);
+
+    auto reflection = context.GetPipelineRegistry().Reflect({MESHLET_TASK, MESHLET_MESH, MESHLET_FRAG});
+    auto layout_builder = DescriptorSetLayout::Builder(device);
+    for (auto const &binding: reflection.GetSetBindings(0)) {
+        layout_builder.AddBinding(binding.binding, binding.descriptorType, binding.stageFlags,
+                                  binding.descriptorCount);
+    }
+    set_layout = layout_builder.Build();
+
+    GraphicsPipelineDesc desc{};
+    desc.task_file = MESHLET_TASK;
+    desc.mesh_file = MESHLET_MESH;
+    desc.frag_file = MESHLET_FRAG;
+    desc.render_pass = context.GetContext().GetDefaultRenderPass();
+    desc.color_formats = {context.GetContext().swapchain.image_format};
+    // the winding BuildMeshlets() takes as front facing
+    desc.front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    desc.push_constants = reflection.GetPushConstants();
+    desc.set_layouts = {set_layout->getDescriptorSetLayout()};
+    pipeline = context.GetPipelineRegistry().Acquire(desc);
+    for (auto const &range: desc.push_constants) {
+        push_stages |= range.stageFlags;
+    }
+
+    // written by transfer copies only, never mapped
+    buffers = std::make_unique<BufferPool>(context.GetAllocator(), &context.GetUploadManager(),
+                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+}
+
+void MeshletRenderer::Destroy() {
+    vkDeviceWaitIdle(context.GetContext().device.device);
+    for (auto const &mesh: meshes) {
+        context.GetDescriptorSetCache().Release(mesh.set);
+        for (auto const &slice: mesh.slices) {
+            context.GetDescriptorSetCache().Invalidate(slice.buffer);
+        }
+    }
+    meshes.clear();
+    if (buffers) {
+        buffers->Destroy();
+        buffers.reset();
+    }
+    if (set_layout) {
+        context.GetDescriptorSetCache().Invalidate(set_layout->getDescriptorSetLayout());
+        set_layout->Cleanup();
+        set_layout.reset();
+    }
+    if (pipeline.pipeline != VK_NULL_HANDLE) {
+        context.GetPipelineRegistry().Release(pipeline.pipeline);
+        pipeline = {};
+    }
+}
+
+uint32_t MeshletRenderer::AddMesh(const MeshGeometry &geometry) {
+    if (geometry.vertices.empty() || geometry.indices.size() < 3) {
+        throw std::runtime_error("failed to add meshlet mesh, the mesh is empty!");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto meshlets = BuildMeshlets(geometry.indices.data(), geometry.indices.size(),
+                                  &geometry.vertices[0].pos.x, geometry.vertices.size(), sizeof(Vertex3));
+    double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    GpuMeshlets mesh{};
+    mesh.slices[0] = upload(meshlets.meshlets.data(), meshlets.meshlets.size() * sizeof(Meshlet));
+    mesh.slices[1] = upload(meshlets.bounds.data(), meshlets.bounds.size() * sizeof(MeshletBounds));
+    mesh.slices[2] = upload(meshlets.vertices.data(), meshlets.vertices.size() * sizeof(uint32_t));
+    mesh.slices[3] = upload(meshlets.triangles.data(), meshlets.triangles.size() * sizeof(uint32_t));
+    mesh.slices[4] = upload(geometry.vertices.data(), geometry.vertices.size() * sizeof(Vertex3));
+
+    VkDescriptorBufferInfo infos[BINDING_COUNT];
+    auto writer = DescriptorWriter(*set_layout, context.GetDescriptorPoolManager());
+    for (uint32_t binding = 0; binding < BINDING_COUNT; binding++) {
+        infos[binding] = {mesh.slices[binding].buffer, mesh.slices[binding].offset, mesh.slices[binding].size};
+        writer.WriteBuffer(binding, &infos[binding]);
+    }
+    mesh.set = context.GetDescriptorSetCache().Acquire(writer);
+
+    mesh.stats.meshlets = static_cast<uint32_t>(meshlets.meshlets.size());
+    mesh.stats.triangles = static_cast<uint32_t>(meshlets.triangles.size());
+    mesh.stats.vertices = static_cast<uint32_t>(meshlets.vertices.size());
+    mesh.stats.build_ms = build_ms;
+
+    meshes.push_back(mesh);
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+void MeshletRenderer::Draw(VkCommandBuffer command_buffer, uint32_t mesh, const glm::mat4 &mvp,
+                           const glm::vec3 &camera_position) {
+    auto const &gpu_mesh = meshes.at(mesh);
+    MeshletDrawData data{mvp, camera_position, gpu_mesh.stats.meshlets};
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipeline);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.layout, 0, 1, &gpu_mesh.set,
+                            0, nullptr);
+    vkCmdPushConstants(command_buffer, pipeline.layout, push_stages, 0, sizeof(data), &data);
+    // one task workgroup culls TASK_GROUP_SIZE meshlets and launches a mesh workgroup per survivor
+    cmd_draw_mesh_tasks(command_buffer, (data.meshlet_count + TASK_GROUP_SIZE - 1) / TASK_GROUP_SIZE, 1, 1);
+}
+
+void MeshletRenderer::PrintStats() const {
+    for (size_t i = 0; i < meshes.size(); i++) {
+        auto const &stats = meshes[i].stats;
+        std::cout << "[MeshletRenderer] mesh " << i << ": " << stats.triangles << " triangles in " << stats.meshlets
+                << " meshlets (" << (stats.meshlets ? static_cast<double>(stats.triangles) / stats.meshlets : 0.0)
+                << " triangles, " << (stats.meshlets ? static_cast<double>(stats.vertices) / stats.meshlets : 0.0)
+                << " vertices each), built in " << stats.build_ms << " ms" << std::endl;
+    }
+}
+
+BufferSlice MeshletRenderer::upload(const void *data, VkDeviceSize size) {
+    auto slice = buffers->Allocate(size, storage_alignment);
+    // read by the task and mesh shaders, which the upload's default hand-off does not cover
+    context.GetUploadManager().EnqueueBufferCopy(data, size, slice.buffer, slice.offset,
+                                                 VK_PIPELINE_STAGE_TASK_SHADER_BIT_EXT |
+                                                 VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT);
+    return slice;
+}
+
+} // end namespace lvk
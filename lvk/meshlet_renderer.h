@@ -0,0 +1,104 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_MESHLET_RENDERER_H
+#define LYH_MESHLET_RENDERER_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "allocator.h"
+#include "descriptor.h"
+#include "device.h"
+#include "mesh_loader.h"
+#include "meshlet.h"
+#include "pipeline_registry.h"
+#include "render_context.h"
+
+namespace lvk {
+
+// meshlet.task / meshlet.mesh push constant, 80 bytes
+struct MeshletDrawData {
+    glm::mat4 mvp;
+    glm::vec3 camera_position; // in mesh space
+    uint32_t meshlet_count;
+};
+
+static_assert(sizeof(MeshletDrawData) == 80, "meshlet push constant layout changed");
+
+struct MeshletMeshStats {
+    uint32_t meshlets = 0;
+    uint32_t triangles = 0;
+    uint32_t vertices = 0; // meshlet local vertices, border vertices count once per meshlet
+    double build_ms = 0.0;
+};
+
+// Draws meshes split into meshlets with VK_EXT_mesh_shader. meshlet.task runs one invocation per
+// meshlet, drops those outside the frustum or facing away from the camera (MeshletBounds' sphere
+// and normal cone, the same tests as IsMeshletOutsideFrustum() / IsMeshletBackfacing()) and
+// launches one meshlet.mesh workgroup per survivor, which reads the vertices straight from storage
+// buffers. There is no vertex input state, every mesh's data sits in one descriptor set.
+//
+// Meshes are full float Vertex3 wound counter-clockwise seen from the front, as BuildMeshlets()
+// expects.
+class MeshletRenderer {
+public:
+    // meshlets tested per task workgroup, matches local_size_x in meshlet.task
+    static constexpr uint32_t TASK_GROUP_SIZE = 32;
+
+    static void RequireFeatures(PhysicalDeviceSelector &selector);
+
+    // For devices where the mesh shader path is optional. Returns false and enables nothing when
+    // the device lacks any part of it.
+    static bool EnableFeaturesIfPresent(PhysicalDevice &physical_device);
+
+    static bool IsSupported(const Device &device);
+
+    // Throws when the device was created without the mesh shader features.
+    explicit MeshletRenderer(RenderContext &context);
+
+    MeshletRenderer(const MeshletRenderer &) = delete;
+
+    MeshletRenderer &operator=(const MeshletRenderer &) = delete;
+
+    void Destroy();
+
+    // Builds the meshlets and queues their upload on the context's UploadManager, the mesh can be
+    // drawn from the next RenderBegin() on. Returns the id Draw() takes.
+    uint32_t AddMesh(const MeshGeometry &geometry);
+
+    // Records into `command_buffer`, which must be inside the render pass of the current frame.
+    // `camera_position` is in the mesh's own space, i.e. transformed by the inverse model matrix.
+    void Draw(VkCommandBuffer command_buffer, uint32_t mesh, const glm::mat4 &mvp, const glm::vec3 &camera_position);
+
+    [[nodiscard]] const MeshletMeshStats &GetStats(uint32_t mesh) const { return meshes[mesh].stats; }
+
+    void PrintStats() const;
+
+private:
+    struct GpuMeshlets {
+        // meshlets, bounds, meshlet vertices, meshlet triangles and vertices, bindings 0 to 4
+        BufferSlice slices[5];
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        MeshletMeshStats stats{};
+    };
+
+    BufferSlice upload(const void *data, VkDeviceSize size);
+
+    RenderContext &context;
+    PFN_vkCmdDrawMeshTasksEXT cmd_draw_mesh_tasks = nullptr;
+    VkDeviceSize storage_alignment = 16;
+
+    std::unique_ptr<DescriptorSetLayout> set_layout;
+    PipelineHandle pipeline{};
+    VkShaderStageFlags push_stages = 0;
+    std::unique_ptr<BufferPool> buffers;
+    std::vector<GpuMeshlets> meshes;
+};
+
+} // end namespace lvk
+
+#endif //LYH_MESHLET_RENDERER_H
@@ -0,0 +1,183 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "mip_generator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "thread_pool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LVK_MIP_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define LVK_MIP_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace lvk {
+namespace {
+// Texels are widened to 14 bit linear values so four of them still sum inside a uint16 lane.
+constexpr uint32_t LINEAR_BITS = 14;
+constexpr uint32_t LINEAR_MAX = (1u << LINEAR_BITS) - 1;
+constexpr uint32_t UNORM_SHIFT = LINEAR_BITS - 8;
+
+struct ColorTables {
+    uint16_t srgb_to_linear[256];
+    uint8_t linear_to_srgb[LINEAR_MAX + 1];
+
+    ColorTables() {
+        for (uint32_t i = 0; i < 256; i++) {
+            double c = i / 255.0;
+            double linear = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+            srgb_to_linear[i] = static_cast<uint16_t>(std::lround(linear * LINEAR_MAX));
+        }
+        for (uint32_t i = 0; i <= LINEAR_MAX; i++) {
+            double linear = static_cast<double>(i) / LINEAR_MAX;
+            double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+            linear_to_srgb[i] = static_cast<uint8_t>(std::clamp(std::lround(c * 255.0), 0l, 255l));
+        }
+    }
+};
+
+const ColorTables &color_tables() {
+    static const ColorTables tables;
+    return tables;
+}
+
+void decode_row(const uint8_t *src, uint32_t width, bool srgb, uint16_t *dst) {
+    auto const &tables = color_tables();
+    for (uint32_t i = 0; i < width * 4; i += 4) {
+        for (uint32_t c = 0; c < 3; c++) {
+            dst[i + c] = srgb ? tables.srgb_to_linear[src[i + c]] : static_cast<uint16_t>(src[i + c] << UNORM_SHIFT);
+        }
+        dst[i + 3] = static_cast<uint16_t>(src[i + 3] << UNORM_SHIFT);
+    }
+}
+
+void encode_row(const uint16_t *src, uint32_t width, bool srgb, uint8_t *dst) {
+    auto const &tables = color_tables();
+    constexpr uint32_t half = 1u << (UNORM_SHIFT - 1);
+    for (uint32_t i = 0; i < width * 4; i += 4) {
+        for (uint32_t c = 0; c < 3; c++) {
+            dst[i + c] = srgb ? tables.linear_to_srgb[src[i + c]] : static_cast<uint8_t>((src[i + c] + half) >> UNORM_SHIFT);
+        }
+        dst[i + 3] = static_cast<uint8_t>((src[i + 3] + half) >> UNORM_SHIFT);
+    }
+}
+
+// Average 2x2 blocks of rows r0/r1, dst pixels [begin, dst_width).
+void box_row_scalar(const uint16_t *r0, const uint16_t *r1, uint32_t src_width, uint32_t begin, uint32_t dst_width,
+                    uint16_t *dst) {
+    for (uint32_t x = begin; x < dst_width; x++) {
+        uint32_t x0 = 2 * x * 4;
+        uint32_t x1 = std::min(2 * x + 1, src_width - 1) * 4;
+        for (uint32_t c = 0; c < 4; c++) {
+            uint32_t sum = r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c];
+            dst[x * 4 + c] = static_cast<uint16_t>((sum + 2) >> 2);
+        }
+    }
+}
+
+// Returns how many dst pixels were written, the rest is left to the scalar kernel.
+uint32_t box_row_simd(const uint16_t *r0, const uint16_t *r1, uint32_t src_width, uint16_t *dst) {
+    // two dst pixels (four src pixels, 32 bytes per row) per iteration, only where both columns exist
+    uint32_t pairs = (src_width / 2) / 2;
+#if LVK_MIP_SSE2
+    const __m128i round = _mm_set1_epi16(2);
+    for (uint32_t i = 0; i < pairs; i++) {
+        const uint16_t *p0 = r0 + i * 16;
+        const uint16_t *p1 = r1 + i * 16;
+        __m128i s0 = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p0)),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(p1)));
+        __m128i s1 = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p0 + 8)),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(p1 + 8)));
+        // horizontal neighbours sit in the two 64 bit halves
+        __m128i h0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+        __m128i h1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+        __m128i result = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(h0, h1), round), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 8), result);
+    }
+    return pairs * 2;
+#elif LVK_MIP_NEON
+    for (uint32_t i = 0; i < pairs; i++) {
+        const uint16_t *p0 = r0 + i * 16;
+        const uint16_t *p1 = r1 + i * 16;
+        uint16x8_t s0 = vaddq_u16(vld1q_u16(p0), vld1q_u16(p1));
+        uint16x8_t s1 = vaddq_u16(vld1q_u16(p0 + 8), vld1q_u16(p1 + 8));
+        uint16x4_t h0 = vadd_u16(vget_low_u16(s0), vget_high_u16(s0));
+        uint16x4_t h1 = vadd_u16(vget_low_u16(s1), vget_high_u16(s1));
+        // rounding shift is computed without overflowing the lane
+        vst1q_u16(dst + i * 8, vcombine_u16(vrshr_n_u16(h0, 2), vrshr_n_u16(h1, 2)));
+    }
+    return pairs * 2;
+#else
+    (void) r0, (void) r1, (void) dst, (void) pairs;
+    return 0;
+#endif
+}
+} // namespace
+
+uint32_t MipGenerator::LevelCount(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+        levels++;
+    }
+    return levels;
+}
+
+MipChainLayout MipGenerator::Layout(uint32_t width, uint32_t height, uint32_t levels) {
+    MipChainLayout layout{};
+    layout.offsets.resize(levels);
+    for (uint32_t level = 0; level < levels; level++) {
+        layout.offsets[level] = layout.size;
+        layout.size += static_cast<uint64_t>(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * 4;
+    }
+    return layout;
+}
+
+void MipGenerator::Downsample(const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst,
+                              uint32_t row_begin, uint32_t row_end, bool srgb, MipKernel kernel) {
+    uint32_t dst_width = std::max(src_width / 2, 1u);
+    bool simd = kernel != MipKernel::kScalar;
+
+    std::vector<uint16_t> row0(src_width * 4);
+    std::vector<uint16_t> row1(src_width * 4);
+    std::vector<uint16_t> result(dst_width * 4);
+
+    for (uint32_t y = row_begin; y < row_end; y++) {
+        uint32_t y0 = 2 * y;
+        uint32_t y1 = std::min(2 * y + 1, src_height - 1);
+        decode_row(src + static_cast<size_t>(y0) * src_width * 4, src_width, srgb, row0.data());
+        decode_row(src + static_cast<size_t>(y1) * src_width * 4, src_width, srgb, row1.data());
+
+        uint32_t done = simd ? box_row_simd(row0.data(), row1.data(), src_width, result.data()) : 0;
+        box_row_scalar(row0.data(), row1.data(), src_width, done, dst_width, result.data());
+
+        encode_row(result.data(), dst_width, srgb, dst + static_cast<size_t>(y) * dst_width * 4);
+    }
+}
+
+void MipGenerator::Generate(uint8_t *chain, uint32_t width, uint32_t height, const MipChainLayout &layout, bool srgb,
+                            ThreadPool *pool, MipKernel kernel) {
+    for (uint32_t level = 1; level < layout.offsets.size(); level++) {
+        uint32_t src_width = std::max(width >> (level - 1), 1u);
+        uint32_t src_height = std::max(height >> (level - 1), 1u);
+        uint32_t dst_height = std::max(src_height / 2, 1u);
+
+        const uint8_t *src = chain + layout.offsets[level - 1];
+        uint8_t *dst = chain + layout.offsets[level];
+
+        if (pool != nullptr) {
+            pool->ParallelFor(dst_height, 16, [&](uint32_t begin, uint32_t end) {
+                Downsample(src, src_width, src_height, dst, begin, end, srgb, kernel);
+            });
+        } else {
+            Downsample(src, src_width, src_height, dst, 0, dst_height, srgb, kernel);
+        }
+    }
+}
+
+} // end namespace lvk
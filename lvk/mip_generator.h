@@ -0,0 +1,46 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_MIP_GENERATOR_H
+#define LYH_MIP_GENERATOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace lvk {
+class ThreadPool;
+
+enum class MipKernel {
+    kAuto,   // best one compiled in
+    kScalar,
+    kSimd,   // SSE2 on x86, NEON on arm, falls back to scalar elsewhere
+};
+
+// Byte layout of an RGBA8 mip chain packed level after level.
+struct MipChainLayout {
+    std::vector<uint64_t> offsets;
+    uint64_t size = 0;
+};
+
+// CPU downsampler for the formats vkCmdBlitImage can't linearly filter. 2x2 box filter, colour
+// channels are averaged in linear space when `srgb` is set, alpha always is linear.
+class MipGenerator {
+public:
+    static uint32_t LevelCount(uint32_t width, uint32_t height);
+
+    static MipChainLayout Layout(uint32_t width, uint32_t height, uint32_t levels);
+
+    // `chain` holds level 0 at offset 0 and room for `layout`, levels 1.. are written in place.
+    // Rows of each level are split across `pool` when given, pass nullptr from inside a pool task.
+    static void Generate(uint8_t *chain, uint32_t width, uint32_t height, const MipChainLayout &layout, bool srgb,
+                         ThreadPool *pool = nullptr, MipKernel kernel = MipKernel::kAuto);
+
+    // One level, dst rows [row_begin, row_end) of the max(1, w/2) x max(1, h/2) result.
+    static void Downsample(const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst,
+                           uint32_t row_begin, uint32_t row_end, bool srgb, MipKernel kernel = MipKernel::kAuto);
+};
+
+} // end namespace lvk
+
+#endif //LYH_MIP_GENERATOR_H
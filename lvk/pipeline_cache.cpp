@@ -0,0 +1,155 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "pipeline_cache.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace lvk {
+PipelineCache::PipelineCache(Device &device, std::string path) : device(device), path(std::move(path)) {
+    // requested is not enough, chaining the feedback struct needs the extension enabled on the device
+    creation_feedback = device.IsExtensionEnabled(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+    std::vector<char> blob;
+    std::ifstream file(this->path, std::ios::binary | std::ios::ate);
+    if (file) {
+        blob.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(blob.data(), static_cast<std::streamsize>(blob.size()));
+        if (!file || !validateHeader(blob)) {
+            std::cout << "[PipelineCache] ignoring stale or foreign cache " << this->path << std::endl;
+            blob.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo cache_info{};
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.initialDataSize = blob.size();
+    cache_info.pInitialData = blob.empty() ? nullptr : blob.data();
+
+    if (vkCreatePipelineCache(device.device, &cache_info, nullptr, &cache) != VK_SUCCESS) {
+        // a driver may still refuse data that passed the header check, fall back to an empty cache
+        cache_info.initialDataSize = 0;
+        cache_info.pInitialData = nullptr;
+        blob.clear();
+        if (vkCreatePipelineCache(device.device, &cache_info, nullptr, &cache) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+    }
+
+    stats.loaded_from_disk = !blob.empty();
+    stats.loaded_size = blob.size();
+}
+
+bool PipelineCache::validateHeader(const std::vector<char> &blob) const {
+    VkPipelineCacheHeaderVersionOne header{};
+    if (blob.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, blob.data(), sizeof(header));
+
+    auto const &properties = device.physical_device.properties;
+    return header.headerSize >= sizeof(header) &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+VkResult PipelineCache::CreateGraphicsPipelines(uint32_t count, const VkGraphicsPipelineCreateInfo *infos,
+                                                VkPipeline *pipelines) {
+    std::vector<VkGraphicsPipelineCreateInfo> chained(infos, infos + count);
+    std::vector<VkPipelineCreationFeedbackEXT> feedback(count);
+    std::vector<VkPipelineCreationFeedbackCreateInfoEXT> feedback_info(count);
+    if (creation_feedback) {
+        for (uint32_t i = 0; i < count; i++) {
+            feedback_info[i].sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+            feedback_info[i].pNext = chained[i].pNext;
+            feedback_info[i].pPipelineCreationFeedback = &feedback[i];
+            chained[i].pNext = &feedback_info[i];
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    VkResult result = vkCreateGraphicsPipelines(device.device, cache, count, chained.data(), nullptr, pipelines);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (result != VK_SUCCESS || count == 0) {
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    for (uint32_t i = 0; i < count; i++) {
+        bool valid = creation_feedback && (feedback[i].flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT);
+        double ms = valid ? static_cast<double>(feedback[i].duration) / 1e6 : elapsed / count;
+        if (!valid) {
+            stats.unknown++;
+            stats.unknown_ms += ms;
+        } else if (feedback[i].flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) {
+            stats.hits++;
+            stats.hit_ms += ms;
+        } else {
+            stats.misses++;
+            stats.miss_ms += ms;
+        }
+    }
+    return result;
+}
+
+void PipelineCache::Save() const {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device.device, cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+        return;
+    }
+    std::vector<char> blob(size);
+    if (vkGetPipelineCacheData(device.device, cache, &size, blob.data()) != VK_SUCCESS) {
+        return;
+    }
+
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        file.write(blob.data(), static_cast<std::streamsize>(size));
+        if (!file) {
+            std::cout << "[PipelineCache] failed to write " << temp << std::endl;
+            return;
+        }
+    }
+
+    // filesystem::rename replaces the target in one step (MoveFileEx on Windows, rename(2) elsewhere)
+    std::error_code error;
+    std::filesystem::rename(temp, path, error);
+    if (error) {
+        std::cout << "[PipelineCache] failed to replace " << path << ": " << error.message() << std::endl;
+    }
+}
+
+PipelineCacheStats PipelineCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return stats;
+}
+
+void PipelineCache::PrintStats() const {
+    auto current = GetStats();
+    std::cout << "[PipelineCache] "
+            << (current.loaded_from_disk ? "loaded " + std::to_string(current.loaded_size) + " bytes" : "cold start")
+            << ", hits: " << current.hits << " (" << current.hit_ms << " ms)"
+            << ", misses: " << current.misses << " (" << current.miss_ms << " ms)";
+    if (current.unknown > 0) {
+        std::cout << ", untracked: " << current.unknown << " (" << current.unknown_ms << " ms)";
+    }
+    std::cout << std::endl;
+}
+
+void PipelineCache::Destroy() {
+    vkDestroyPipelineCache(device.device, cache, nullptr);
+    cache = VK_NULL_HANDLE;
+}
+
+} // end namespace lvk
@@ -0,0 +1,67 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_PIPELINE_CACHE_H
+#define LYH_PIPELINE_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <mutex>
+#include <string>
+
+#include "device.h"
+
+namespace lvk {
+
+struct PipelineCacheStats {
+    bool loaded_from_disk = false;
+    size_t loaded_size = 0;
+    // hit / miss comes from VK_EXT_pipeline_creation_feedback, without it creations count as unknown
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t unknown = 0;
+    double hit_ms = 0.0;
+    double miss_ms = 0.0;
+    double unknown_ms = 0.0;
+};
+
+// VkPipelineCache backed by a file. The blob is only reused when its header matches this exact
+// device and driver (vendor ID, device ID, pipelineCacheUUID), otherwise the cache starts empty.
+// Pipelines may be created from several threads, the driver synchronizes the VkPipelineCache.
+class PipelineCache {
+public:
+    explicit PipelineCache(Device &device, std::string path);
+
+    PipelineCache(const PipelineCache &) = delete;
+
+    PipelineCache &operator=(const PipelineCache &) = delete;
+
+    [[nodiscard]] VkPipelineCache GetHandle() const { return cache; }
+
+    // vkCreateGraphicsPipelines through the cache, recording timing and hit / miss per pipeline.
+    VkResult CreateGraphicsPipelines(uint32_t count, const VkGraphicsPipelineCreateInfo *infos, VkPipeline *pipelines);
+
+    // Write the blob next to the target file and rename it over, so a crash never leaves a torn cache.
+    void Save() const;
+
+    [[nodiscard]] PipelineCacheStats GetStats() const;
+
+    void PrintStats() const;
+
+    void Destroy();
+
+private:
+    bool validateHeader(const std::vector<char> &blob) const;
+
+    Device &device;
+    std::string path;
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    bool creation_feedback = false;
+
+    mutable std::mutex stats_mutex;
+    PipelineCacheStats stats{};
+};
+
+} // end namespace lvk
+
+#endif //LYH_PIPELINE_CACHE_H
@@ -0,0 +1,46 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "pipeline_compiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace lvk {
+PipelineCompiler::PipelineCompiler(PipelineRegistry &registry, uint32_t thread_count)
+    : registry(registry), workers(thread_count) {
+}
+
+PipelineRequest PipelineCompiler::Compile(GraphicsPipelineDesc desc) {
+    auto request = workers.Submit([this, desc = std::move(desc)] {
+        return registry.Acquire(desc);
+    }).share();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    in_flight.erase(std::remove_if(in_flight.begin(), in_flight.end(), IsReady), in_flight.end());
+    in_flight.push_back(request);
+    return request;
+}
+
+bool PipelineCompiler::IsReady(const PipelineRequest &request) {
+    return request.valid() && request.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void PipelineCompiler::WaitIdle() {
+    std::vector<PipelineRequest> requests;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.swap(in_flight);
+    }
+    for (auto const &request: requests) {
+        request.wait();
+    }
+}
+
+void PipelineCompiler::Destroy() {
+    // pipelines finishing after this would be created against a registry that is going away
+    WaitIdle();
+}
+
+} // end namespace lvk
@@ -0,0 +1,53 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_PIPELINE_COMPILER_H
+#define LYH_PIPELINE_COMPILER_H
+
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "pipeline_registry.h"
+#include "thread_pool.h"
+
+namespace lvk {
+
+using PipelineRequest = std::shared_future<PipelineHandle>;
+
+// Compiles graphics pipelines on a worker pool through the registry, so identical descriptions
+// submitted at the same time are still compiled once. vkCreateGraphicsPipelines may run on
+// several threads at once, the pipeline cache is internally synchronized.
+class PipelineCompiler {
+public:
+    explicit PipelineCompiler(PipelineRegistry &registry, uint32_t thread_count = 0);
+
+    PipelineCompiler(const PipelineCompiler &) = delete;
+
+    PipelineCompiler &operator=(const PipelineCompiler &) = delete;
+
+    // Returns at once, the handle resolves once a worker has compiled (or found) the pipeline.
+    PipelineRequest Compile(GraphicsPipelineDesc desc);
+
+    // Non-blocking, true once `request` can be read without waiting.
+    static bool IsReady(const PipelineRequest &request);
+
+    // Block until every submitted pipeline has been compiled.
+    void WaitIdle();
+
+    [[nodiscard]] uint32_t GetThreadCount() const { return workers.GetThreadCount(); }
+
+    void Destroy();
+
+private:
+    PipelineRegistry &registry;
+    ThreadPool workers;
+
+    std::mutex mutex;
+    std::vector<PipelineRequest> in_flight;
+};
+
+} // end namespace lvk
+
+#endif //LYH_PIPELINE_COMPILER_H
@@ -0,0 +1,390 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "pipeline_registry.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "functions.h"
+
+namespace lvk {
+template<typename T>
+static void append_key(std::string &key, const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    key.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+static std::string layout_key(const GraphicsPipelineDesc &desc) {
+    std::string key;
+    append_key(key, desc.set_layouts.size());
+    for (auto set_layout: desc.set_layouts) {
+        append_key(key, set_layout);
+    }
+    append_key(key, desc.push_constants.size());
+    for (auto const &range: desc.push_constants) {
+        append_key(key, range.stageFlags);
+        append_key(key, range.offset);
+        append_key(key, range.size);
+    }
+    return key;
+}
+
+static uint64_t hash_key(const std::string &key) {
+    return Fnv1a64(key.data(), key.size());
+}
+
+PipelineRegistry::PipelineRegistry(Device &device, PipelineCache &cache, ShaderCompiler &compiler)
+    : device(device), cache(cache), compiler(compiler) {
+}
+
+const PipelineRegistry::ShaderCode &PipelineRegistry::loadShader(const std::string &file) {
+    {
+        std::lock_guard<std::mutex> lock(shader_mutex);
+        auto found = shaders.find(file);
+        if (found != shaders.end()) {
+            return found->second;
+        }
+    }
+
+    // two threads may load the same file at once, the first one to finish wins
+    ShaderCode shader{};
+    shader.code = ShaderCompiler::IsSource(file) ? compiler.Compile(file) : ReadFile(file);
+    shader.hash = Fnv1a64(shader.code.data(), shader.code.size());
+
+    std::lock_guard<std::mutex> lock(shader_mutex);
+    return shaders.emplace(file, std::move(shader)).first->second;
+}
+
+ShaderReflection PipelineRegistry::Reflect(const std::vector<std::string> &files) {
+    // compile independent sources in parallel, loadShader() then finds them in memory
+    std::vector<ShaderRequest> requests;
+    for (auto const &file: files) {
+        if (ShaderCompiler::IsSource(file)) {
+            requests.push_back(compiler.CompileAsync(file));
+        }
+    }
+    for (auto const &request: requests) {
+        request.wait();
+    }
+
+    ShaderReflection reflection{};
+    for (auto const &file: files) {
+        reflection.Merge(ShaderReflection::Reflect(loadShader(file).code));
+    }
+    return reflection;
+}
+
+PipelineHandle PipelineRegistry::Acquire(const GraphicsPipelineDesc &desc) {
+    ShaderStages stages;
+    if (desc.mesh_file.empty()) {
+        stages.emplace_back(VK_SHADER_STAGE_VERTEX_BIT, &loadShader(desc.vert_file));
+    } else {
+        if (!desc.task_file.empty()) {
+            stages.emplace_back(VK_SHADER_STAGE_TASK_BIT_EXT, &loadShader(desc.task_file));
+        }
+        stages.emplace_back(VK_SHADER_STAGE_MESH_BIT_EXT, &loadShader(desc.mesh_file));
+    }
+    stages.emplace_back(VK_SHADER_STAGE_FRAGMENT_BIT, &loadShader(desc.frag_file));
+
+    // identical SPIR-V loaded from different paths still shares a pipeline
+    std::string key;
+    for (auto const &[stage, shader]: stages) {
+        append_key(key, stage);
+        append_key(key, shader->hash);
+    }
+
+    append_key(key, desc.bindings.size());
+    for (auto const &binding: desc.bindings) {
+        append_key(key, binding.binding);
+        append_key(key, binding.stride);
+        append_key(key, binding.inputRate);
+    }
+    append_key(key, desc.attributes.size());
+    for (auto const &attribute: desc.attributes) {
+        append_key(key, attribute.location);
+        append_key(key, attribute.binding);
+        append_key(key, attribute.format);
+        append_key(key, attribute.offset);
+    }
+
+    append_key(key, desc.topology);
+    append_key(key, desc.polygon_mode);
+    append_key(key, desc.cull_mode);
+    append_key(key, desc.front_face);
+    append_key(key, desc.samples);
+    append_key(key, desc.blend_enable);
+    if (desc.blend_enable) {
+        append_key(key, desc.src_color_blend);
+        append_key(key, desc.dst_color_blend);
+        append_key(key, desc.src_alpha_blend);
+        append_key(key, desc.dst_alpha_blend);
+    }
+
+    key += layout_key(desc);
+
+    append_key(key, desc.subpass);
+    append_key(key, desc.color_formats.size());
+    for (auto format: desc.color_formats) {
+        append_key(key, format);
+    }
+    append_key(key, desc.depth_format);
+
+    uint64_t hash = hash_key(key);
+    std::unique_lock<std::mutex> lock(mutex);
+    if (auto *entry = findPipeline(hash, key)) {
+        entry->references++;
+        auto ready = entry->ready;
+        lock.unlock();
+        // blocks only while another thread is still compiling the same pipeline
+        return ready.get();
+    }
+
+    std::promise<PipelineHandle> promise;
+    PipelineEntry entry{};
+    entry.key = key;
+    entry.handle.layout = acquireLayout(desc);
+    entry.ready = promise.get_future().share();
+    entry.references = 1;
+    VkPipelineLayout layout = entry.handle.layout;
+    pipelines.emplace(hash, std::move(entry));
+    lock.unlock();
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    try {
+        pipeline = createPipeline(desc, layout, stages);
+    } catch (...) {
+        lock.lock();
+        for (auto [it, end] = pipelines.equal_range(hash); it != end; ++it) {
+            if (it->second.key == key) {
+                pipelines.erase(it);
+                break;
+            }
+        }
+        releaseLayout(layout);
+        lock.unlock();
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    lock.lock();
+    auto *created = findPipeline(hash, key);
+    created->handle.pipeline = pipeline;
+    pipeline_hashes[pipeline] = hash;
+    PipelineHandle handle = created->handle;
+    lock.unlock();
+
+    promise.set_value(handle);
+    return handle;
+}
+
+PipelineRegistry::PipelineEntry *PipelineRegistry::findPipeline(uint64_t hash, const std::string &key) {
+    for (auto [it, end] = pipelines.equal_range(hash); it != end; ++it) {
+        if (it->second.key == key) {
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+void PipelineRegistry::Release(VkPipeline pipeline) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = pipeline_hashes.find(pipeline);
+    if (found == pipeline_hashes.end()) {
+        return;
+    }
+
+    for (auto [it, end] = pipelines.equal_range(found->second); it != end; ++it) {
+        if (it->second.handle.pipeline != pipeline) {
+            continue;
+        }
+        if (--it->second.references == 0) {
+            vkDestroyPipeline(device.device, pipeline, nullptr);
+            releaseLayout(it->second.handle.layout);
+            pipelines.erase(it);
+            pipeline_hashes.erase(found);
+        }
+        return;
+    }
+}
+
+size_t PipelineRegistry::GetPipelineCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pipelines.size();
+}
+
+size_t PipelineRegistry::GetLayoutCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return layouts.size();
+}
+
+VkPipelineLayout PipelineRegistry::acquireLayout(const GraphicsPipelineDesc &desc) {
+    std::string key = layout_key(desc);
+    uint64_t hash = hash_key(key);
+
+    auto range = layouts.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.key == key) {
+            it->second.references++;
+            return it->second.layout;
+        }
+    }
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(desc.set_layouts.size());
+    pipeline_layout_info.pSetLayouts = desc.set_layouts.data();
+    pipeline_layout_info.pushConstantRangeCount = static_cast<uint32_t>(desc.push_constants.size());
+    pipeline_layout_info.pPushConstantRanges = desc.push_constants.data();
+
+    LayoutEntry entry{};
+    if (vkCreatePipelineLayout(device.device, &pipeline_layout_info, nullptr, &entry.layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout\n");
+    }
+    entry.key = std::move(key);
+    entry.references = 1;
+
+    return layouts.emplace(hash, std::move(entry))->second.layout;
+}
+
+void PipelineRegistry::releaseLayout(VkPipelineLayout layout) {
+    for (auto it = layouts.begin(); it != layouts.end(); ++it) {
+        if (it->second.layout == layout) {
+            if (--it->second.references == 0) {
+                vkDestroyPipelineLayout(device.device, layout, nullptr);
+                layouts.erase(it);
+            }
+            return;
+        }
+    }
+}
+
+VkPipeline PipelineRegistry::createPipeline(const GraphicsPipelineDesc &desc, VkPipelineLayout layout,
+                                            const ShaderStages &stages) {
+    std::vector<VkPipelineShaderStageCreateInfo> shader_stages(stages.size());
+    auto destroy_modules = [&] {
+        for (auto const &stage: shader_stages) {
+            vkDestroyShaderModule(device.device, stage.module, nullptr);
+        }
+    };
+    for (size_t i = 0; i < stages.size(); i++) {
+        shader_stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shader_stages[i].stage = stages[i].first;
+        shader_stages[i].module = CreateShaderModule(device.device, stages[i].second->code);
+        shader_stages[i].pName = "main";
+        if (shader_stages[i].module == VK_NULL_HANDLE) {
+            destroy_modules();
+            throw std::runtime_error("failed to create shader module\n");
+        }
+    }
+
+    VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
+    vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.bindings.size());
+    vertex_input_info.pVertexBindingDescriptions = desc.bindings.data();
+    vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.attributes.size());
+    vertex_input_info.pVertexAttributeDescriptions = desc.attributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
+    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    input_assembly.topology = desc.topology;
+    input_assembly.primitiveRestartEnable = VK_FALSE;
+
+    // viewport and scissor are dynamic, only the counts matter here
+    VkPipelineViewportStateCreateInfo viewport_state = {};
+    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = desc.polygon_mode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = desc.cull_mode;
+    rasterizer.frontFace = desc.front_face;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = desc.samples;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+    colorBlendAttachment.colorWriteMask =
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = desc.blend_enable ? VK_TRUE : VK_FALSE;
+    colorBlendAttachment.srcColorBlendFactor = desc.src_color_blend;
+    colorBlendAttachment.dstColorBlendFactor = desc.dst_color_blend;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = desc.src_alpha_blend;
+    colorBlendAttachment.dstAlphaBlendFactor = desc.dst_alpha_blend;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    std::vector<VkPipelineColorBlendAttachmentState> blend_attachments(
+        std::max<size_t>(desc.color_formats.size(), 1), colorBlendAttachment);
+
+    VkPipelineColorBlendStateCreateInfo color_blending = {};
+    color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blending.logicOpEnable = VK_FALSE;
+    color_blending.logicOp = VK_LOGIC_OP_COPY;
+    color_blending.attachmentCount = static_cast<uint32_t>(blend_attachments.size());
+    color_blending.pAttachments = blend_attachments.data();
+
+    std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+    VkPipelineDynamicStateCreateInfo dynamic_info = {};
+    dynamic_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_info.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+    dynamic_info.pDynamicStates = dynamic_states.data();
+
+    VkGraphicsPipelineCreateInfo pipeline_info = {};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.stageCount = static_cast<uint32_t>(shader_stages.size());
+    pipeline_info.pStages = shader_stages.data();
+    // mesh shaders produce their primitives themselves
+    if (desc.mesh_file.empty()) {
+        pipeline_info.pVertexInputState = &vertex_input_info;
+        pipeline_info.pInputAssemblyState = &input_assembly;
+    }
+    pipeline_info.pViewportState = &viewport_state;
+    pipeline_info.pRasterizationState = &rasterizer;
+    pipeline_info.pMultisampleState = &multisampling;
+    pipeline_info.pColorBlendState = &color_blending;
+    pipeline_info.pDynamicState = &dynamic_info;
+    pipeline_info.layout = layout;
+    pipeline_info.renderPass = desc.render_pass;
+    pipeline_info.subpass = desc.subpass;
+    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = cache.CreateGraphicsPipelines(1, &pipeline_info, &pipeline);
+
+    destroy_modules();
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipline\n");
+    }
+    return pipeline;
+}
+
+void PipelineRegistry::Destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto const &[hash, entry]: pipelines) {
+        vkDestroyPipeline(device.device, entry.handle.pipeline, nullptr);
+    }
+    for (auto const &[hash, entry]: layouts) {
+        vkDestroyPipelineLayout(device.device, entry.layout, nullptr);
+    }
+    pipelines.clear();
+    layouts.clear();
+    pipeline_hashes.clear();
+
+    std::lock_guard<std::mutex> shader_lock(shader_mutex);
+    shaders.clear();
+}
+
+} // end namespace lvk
@@ -0,0 +1,141 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_PIPELINE_REGISTRY_H
+#define LYH_PIPELINE_REGISTRY_H
+
+#include <vulkan/vulkan.h>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "device.h"
+#include "pipeline_cache.h"
+#include "shader_compiler.h"
+#include "shader_reflection.h"
+
+namespace lvk {
+
+// Everything that makes two graphics pipelines different. Viewport and scissor are always dynamic
+// and are not part of the description.
+struct GraphicsPipelineDesc {
+    // GLSL sources are compiled through the ShaderCompiler, anything else is read as SPIR-V
+    std::string vert_file;
+    std::string frag_file;
+    // Set for a mesh shader pipeline, which replaces vert_file and the vertex input state; the task
+    // stage is optional. The device needs VK_EXT_mesh_shader.
+    std::string task_file;
+    std::string mesh_file;
+
+    std::vector<VkVertexInputBindingDescription> bindings;
+    std::vector<VkVertexInputAttributeDescription> attributes;
+
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygon_mode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cull_mode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace front_face = VK_FRONT_FACE_CLOCKWISE;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    bool blend_enable = false;
+    VkBlendFactor src_color_blend = VK_BLEND_FACTOR_SRC_ALPHA;
+    VkBlendFactor dst_color_blend = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    VkBlendFactor src_alpha_blend = VK_BLEND_FACTOR_ONE;
+    VkBlendFactor dst_alpha_blend = VK_BLEND_FACTOR_ZERO;
+
+    std::vector<VkDescriptorSetLayout> set_layouts;
+    std::vector<VkPushConstantRange> push_constants;
+
+    // pipelines are created against `render_pass` but shared between compatible passes, which are
+    // matched by their attachment formats
+    VkRenderPass render_pass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+    std::vector<VkFormat> color_formats;
+    VkFormat depth_format = VK_FORMAT_UNDEFINED;
+};
+
+struct PipelineHandle {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+};
+
+// Deduplicates graphics pipelines and pipeline layouts. Acquire() returns the existing pipeline
+// when the hashed description matches one that is alive and bumps its reference count, Release()
+// destroys it with the last reference, after the caller made sure the GPU no longer uses it.
+// Acquire() may be called from several threads, pipelines are compiled outside the lock and a
+// thread asking for a pipeline another thread is still compiling waits for that one.
+class PipelineRegistry {
+public:
+    explicit PipelineRegistry(Device &device, PipelineCache &cache, ShaderCompiler &compiler);
+
+    PipelineRegistry(const PipelineRegistry &) = delete;
+
+    PipelineRegistry &operator=(const PipelineRegistry &) = delete;
+
+    PipelineHandle Acquire(const GraphicsPipelineDesc &desc);
+
+    void Release(VkPipeline pipeline);
+
+    // Reflection of the given stages merged into one, the files are loaded (or compiled) the same
+    // way Acquire() does it and stay cached for it.
+    ShaderReflection Reflect(const std::vector<std::string> &files);
+
+    [[nodiscard]] size_t GetPipelineCount() const;
+
+    [[nodiscard]] size_t GetLayoutCount() const;
+
+    void Destroy();
+
+private:
+    struct PipelineEntry {
+        std::string key;
+        // pipeline stays VK_NULL_HANDLE until compiled, `ready` is fulfilled at the same time
+        PipelineHandle handle;
+        std::shared_future<PipelineHandle> ready;
+        uint32_t references = 0;
+    };
+
+    struct LayoutEntry {
+        std::string key;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        uint32_t references = 0;
+    };
+
+    // SPIR-V of a shader file and the hash standing in for it in pipeline keys
+    struct ShaderCode {
+        std::vector<char> code;
+        uint64_t hash = 0;
+    };
+
+    const ShaderCode &loadShader(const std::string &file);
+
+    PipelineEntry *findPipeline(uint64_t hash, const std::string &key);
+
+    VkPipelineLayout acquireLayout(const GraphicsPipelineDesc &desc);
+
+    void releaseLayout(VkPipelineLayout layout);
+
+    using ShaderStages = std::vector<std::pair<VkShaderStageFlagBits, const ShaderCode *>>;
+
+    VkPipeline createPipeline(const GraphicsPipelineDesc &desc, VkPipelineLayout layout, const ShaderStages &stages);
+
+    Device &device;
+    PipelineCache &cache;
+    ShaderCompiler &compiler;
+
+    mutable std::mutex mutex;
+    // separate from `mutex` so compiling one shader does not stall lookups of other pipelines
+    std::mutex shader_mutex;
+    std::unordered_map<std::string, ShaderCode> shaders;
+    // keyed by the 64 bit hash of the serialized description, the full key guards against collisions
+    std::unordered_multimap<uint64_t, PipelineEntry> pipelines;
+    std::unordered_multimap<uint64_t, LayoutEntry> layouts;
+    std::unordered_map<VkPipeline, uint64_t> pipeline_hashes;
+};
+
+} // end namespace lvk
+
+#endif //LYH_PIPELINE_REGISTRY_H
@@ -0,0 +1,207 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "quadtree.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace lvk {
+
+LooseQuadtree::LooseQuadtree(const Rect &world, uint32_t max_depth) : max_depth(std::min(max_depth, MAX_DEPTH)) {
+    if (world.min.x > world.max.x || world.min.y > world.max.y) {
+        throw std::runtime_error("failed to create quadtree, world bounds are inverted!");
+    }
+    // cells are square, the world's longer side sets their size
+    Node root{};
+    root.min = world.min;
+    root.size = std::max(std::max(world.max.x - world.min.x, world.max.y - world.min.y),
+                         std::numeric_limits<float>::min());
+    nodes.push_back(std::move(root));
+}
+
+void LooseQuadtree::Insert(uint32_t id, const Rect &bounds) {
+    if (Contains(id)) {
+        throw std::runtime_error("failed to insert into quadtree, id is already present!");
+    }
+    if (bounds.min.x > bounds.max.x || bounds.min.y > bounds.max.y) {
+        throw std::runtime_error("failed to insert into quadtree, bounds are inverted!");
+    }
+    if (id >= locations.size()) {
+        locations.resize(std::max<size_t>(id + 1, locations.size() * 2));
+    }
+    add(place(bounds), id, bounds);
+}
+
+void LooseQuadtree::Move(uint32_t id, const Rect &bounds) {
+    if (!Contains(id)) {
+        throw std::runtime_error("failed to move quadtree item, id is not present!");
+    }
+    if (bounds.min.x > bounds.max.x || bounds.min.y > bounds.max.y) {
+        throw std::runtime_error("failed to move quadtree item, bounds are inverted!");
+    }
+
+    auto const &location = locations[id];
+    if (place(bounds, false) == location.node) {
+        nodes[location.node].entries[location.slot].bounds = bounds;
+        return;
+    }
+    detach(id);
+    add(place(bounds), id, bounds);
+}
+
+void LooseQuadtree::Remove(uint32_t id) {
+    if (Contains(id)) {
+        detach(id);
+        locations[id] = {};
+    }
+}
+
+void LooseQuadtree::Clear() {
+    Node root{};
+    root.min = nodes[ROOT].min;
+    root.size = nodes[ROOT].size;
+    nodes.clear();
+    nodes.push_back(std::move(root));
+    free_nodes.clear();
+    locations.clear();
+}
+
+void LooseQuadtree::Query(const Rect &area, std::vector<uint32_t> &out) const {
+    // depth first, bit 0 marks nodes whose loose bounds lie entirely inside `area`
+    uint32_t stack[4 * (MAX_DEPTH + 1)];
+    uint32_t depth = 0;
+    stack[depth++] = ROOT << 1;
+    while (depth > 0) {
+        uint32_t top = stack[--depth];
+        auto const &node = nodes[top >> 1];
+        bool inside = top & 1;
+
+        // the root also holds what lies outside the world, its items are always tested
+        if (!inside && (top >> 1) != ROOT) {
+            float half = node.size * 0.5f;
+            Rect loose{node.min - half, node.min + node.size + half};
+            if (!area.Intersects(loose)) {
+                continue;
+            }
+            inside = area.Contains(loose);
+        }
+
+        if (inside) {
+            for (auto const &entry: node.entries) {
+                out.push_back(entry.id);
+            }
+        } else {
+            for (auto const &entry: node.entries) {
+                if (area.Intersects(entry.bounds)) {
+                    out.push_back(entry.id);
+                }
+            }
+        }
+        for (auto child: node.children) {
+            if (child != NO_NODE) {
+                stack[depth++] = child << 1 | static_cast<uint32_t>(inside);
+            }
+        }
+    }
+}
+
+uint32_t LooseQuadtree::place(const Rect &bounds, bool create) {
+    glm::vec2 center = (bounds.min + bounds.max) * 0.5f;
+    float extent = std::max(bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y);
+
+    auto const &root = nodes[ROOT];
+    if (!Rect{root.min, root.min + root.size}.Contains(center)) {
+        return ROOT;
+    }
+
+    // a child's loose bounds hold anything centred in its cell and no larger than the cell
+    uint32_t node = ROOT;
+    while (nodes[node].split) {
+        float half = nodes[node].size * 0.5f;
+        if (extent > half) {
+            break;
+        }
+        glm::vec2 middle = nodes[node].min + half;
+        uint32_t quadrant = (center.x >= middle.x ? 1u : 0u) | (center.y >= middle.y ? 2u : 0u);
+        uint32_t child = nodes[node].children[quadrant];
+        if (child == NO_NODE) {
+            if (!create) {
+                return NO_NODE;
+            }
+            child = createNode(node, quadrant);
+        }
+        node = child;
+    }
+    return node;
+}
+
+uint32_t LooseQuadtree::createNode(uint32_t parent, uint32_t quadrant) {
+    uint32_t node;
+    if (!free_nodes.empty()) {
+        node = free_nodes.back();
+        free_nodes.pop_back();
+    } else {
+        node = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    float half = nodes[parent].size * 0.5f;
+    auto &child = nodes[node];
+    child.min = nodes[parent].min + glm::vec2(quadrant & 1 ? half : 0.0f, quadrant & 2 ? half : 0.0f);
+    child.size = half;
+    child.parent = parent;
+    child.depth = nodes[parent].depth + 1;
+    nodes[parent].children[quadrant] = node;
+    return node;
+}
+
+void LooseQuadtree::add(uint32_t node, uint32_t id, const Rect &bounds) {
+    locations[id] = {node, static_cast<uint32_t>(nodes[node].entries.size())};
+    nodes[node].entries.push_back({bounds, id});
+    for (uint32_t n = node; n != NO_NODE; n = nodes[n].parent) {
+        nodes[n].count++;
+    }
+    if (!nodes[node].split && nodes[node].entries.size() > NODE_CAPACITY && nodes[node].depth < max_depth) {
+        split(node);
+    }
+}
+
+void LooseQuadtree::split(uint32_t node) {
+    nodes[node].split = true;
+    auto entries = std::move(nodes[node].entries);
+    nodes[node].entries.clear();
+    for (uint32_t n = node; n != NO_NODE; n = nodes[n].parent) {
+        nodes[n].count -= static_cast<uint32_t>(entries.size());
+    }
+    // the ones too large for a child land right back here
+    for (auto const &entry: entries) {
+        add(place(entry.bounds), entry.id, entry.bounds);
+    }
+}
+
+void LooseQuadtree::detach(uint32_t id) {
+    auto [node, slot] = locations[id];
+    auto &entries = nodes[node].entries;
+    if (slot + 1 != entries.size()) {
+        entries[slot] = entries.back();
+        locations[entries[slot].id].slot = slot;
+    }
+    entries.pop_back();
+
+    // every node but the root has an item at or below it, the ones this leaves empty go
+    for (uint32_t n = node; n != NO_NODE;) {
+        auto &current = nodes[n];
+        uint32_t parent = current.parent;
+        if (--current.count == 0 && n != ROOT) {
+            auto &siblings = nodes[parent].children;
+            *std::find(std::begin(siblings), std::end(siblings), n) = NO_NODE;
+            current = Node{};
+            free_nodes.push_back(n);
+        }
+        n = parent;
+    }
+}
+
+} // end namespace lvk
@@ -0,0 +1,128 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_QUADTREE_H
+#define LYH_QUADTREE_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace lvk {
+
+// Axis aligned, edges inclusive.
+struct Rect {
+    glm::vec2 min{0.0f};
+    glm::vec2 max{0.0f};
+
+    [[nodiscard]] bool Intersects(const Rect &other) const {
+        return min.x <= other.max.x && other.min.x <= max.x && min.y <= other.max.y && other.min.y <= max.y;
+    }
+
+    [[nodiscard]] bool Contains(const Rect &other) const {
+        return min.x <= other.min.x && other.max.x <= max.x && min.y <= other.min.y && other.max.y <= max.y;
+    }
+
+    [[nodiscard]] bool Contains(glm::vec2 point) const {
+        return min.x <= point.x && point.x <= max.x && min.y <= point.y && point.y <= max.y;
+    }
+
+    [[nodiscard]] Rect Union(const Rect &other) const {
+        return {glm::min(min, other.min), glm::max(max, other.max)};
+    }
+};
+
+// Spatial index over 2D bounds for viewport culling and hit testing. Loose: every node's bounds
+// are its quadtree cell grown by half a cell on each side, so an item is stored in exactly one
+// node, one whose cell holds the item's centre and is at least as large as the item, and never
+// has to be split across nodes. Items go as deep as the nodes on their way have been split; a
+// node splits once it holds more than NODE_CAPACITY items, handing those small enough down to its
+// children. A Move() that stays in its node only rewrites the stored bounds. Nodes left without
+// items below them are released.
+//
+// Items are identified by caller chosen ids, kept in an array indexed by id, so ids should be
+// dense. Items whose centre lies outside `world`, or which are larger than it, sit in the root and
+// are tested by every query; `world` should cover the scene. Not thread safe.
+class LooseQuadtree {
+public:
+    static constexpr uint32_t DEFAULT_MAX_DEPTH = 12;
+    static constexpr uint32_t MAX_DEPTH = 24;
+    static constexpr uint32_t NODE_CAPACITY = 32;
+
+    explicit LooseQuadtree(const Rect &world, uint32_t max_depth = DEFAULT_MAX_DEPTH);
+
+    // Throws when `id` is already in the tree or `bounds` is inverted.
+    void Insert(uint32_t id, const Rect &bounds);
+
+    // Throws when `id` is not in the tree or `bounds` is inverted.
+    void Move(uint32_t id, const Rect &bounds);
+
+    // Ids not in the tree are ignored.
+    void Remove(uint32_t id);
+
+    [[nodiscard]] bool Contains(uint32_t id) const {
+        return id < locations.size() && locations[id].node != NO_NODE;
+    }
+
+    void Clear();
+
+    // Appends the ids of all items whose bounds overlap `area`, in no particular order.
+    void Query(const Rect &area, std::vector<uint32_t> &out) const;
+
+    // Appends the ids of all items whose bounds contain `point`.
+    void QueryPoint(glm::vec2 point, std::vector<uint32_t> &out) const { Query({point, point}, out); }
+
+    [[nodiscard]] size_t GetSize() const { return nodes[ROOT].count; }
+
+    [[nodiscard]] size_t GetNodeCount() const { return nodes.size() - free_nodes.size(); }
+
+private:
+    static constexpr uint32_t ROOT = 0;
+    static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+    struct Entry {
+        Rect bounds;
+        uint32_t id;
+    };
+
+    struct Node {
+        glm::vec2 min{0.0f}; // of the cell, the loose bounds reach half a cell further
+        float size = 0.0f;
+        uint32_t parent = NO_NODE;
+        uint32_t children[4] = {NO_NODE, NO_NODE, NO_NODE, NO_NODE};
+        uint32_t count = 0; // items in this node and below
+        uint32_t depth = 0;
+        bool split = false; // items small enough for a child go down to it
+        std::vector<Entry> entries;
+    };
+
+    struct Location {
+        uint32_t node = NO_NODE;
+        uint32_t slot = 0; // in the node's entries
+    };
+
+    // The node `bounds` belongs in, created along with its ancestors when missing; without
+    // `create` NO_NODE when it does not exist yet.
+    uint32_t place(const Rect &bounds, bool create = true);
+
+    void split(uint32_t node);
+
+    uint32_t createNode(uint32_t parent, uint32_t quadrant);
+
+    void add(uint32_t node, uint32_t id, const Rect &bounds);
+
+    // takes the item out of its node and releases the nodes left empty
+    void detach(uint32_t id);
+
+    uint32_t max_depth;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> free_nodes;
+    std::vector<Location> locations;
+};
+
+} // end namespace lvk
+
+#endif //LYH_QUADTREE_H
@@ -27,6 +27,20 @@ RenderContext::RenderContext(VulkanContext &context) : context(context) {
 
     //
     allocator = std::make_unique<Allocator>(context);
+    frame_allocator = std::make_unique<FrameRingAllocator>(*allocator, FRAME_ALLOCATOR_SIZE, max_frames_in_flight);
+    descriptor_pools = std::make_unique<DescriptorPoolManager>(context.device, max_frames_in_flight);
+    descriptor_cache = std::make_unique<DescriptorSetCache>(*descriptor_pools, max_frames_in_flight);
+    if (BindlessTextureHeap::IsSupported(context.device)) {
+        bindless_heap = std::make_unique<BindlessTextureHeap>(context.device, max_frames_in_flight);
+    }
+    upload_manager = std::make_unique<UploadManager>(context, *allocator);
+    texture_loader = std::make_unique<TextureLoader>(*allocator, *upload_manager);
+    mesh_loader = std::make_unique<MeshLoader>(*allocator, *upload_manager);
+    shader_compiler = std::make_unique<ShaderCompiler>();
+    pipeline_registry = std::make_unique<PipelineRegistry>(context.device, *context.pipeline_cache,
+                                                           *shader_compiler);
+    pipeline_compiler = std::make_unique<PipelineCompiler>(*pipeline_registry);
+    workers = std::make_unique<ThreadPool>();
 }
 
 void RenderContext::reset_swapchain(Swapchain swapchain_) {
@@ -114,6 +128,17 @@ void RenderContext::create_sync_objects() {
 
 void RenderContext::Cleanup() {
     //
+    pipeline_compiler->Destroy();
+    pipeline_registry->Destroy();
+    texture_loader->Destroy();
+    mesh_loader->Destroy();
+    upload_manager->Destroy();
+    if (bindless_heap) {
+        bindless_heap->Destroy();
+    }
+    descriptor_cache->Destroy();
+    descriptor_pools->Destroy();
+    frame_allocator->Destroy();
     allocator->Destroy();
 
     for (size_t i = 0; i < context.swapchain.image_count; i++) {
@@ -143,7 +168,7 @@ void RenderContext::Cleanup() {
 }
 
 void RenderContext::Rendering() {
-    vkWaitForFences(context.device.device, 1, &in_flight_fences[current_frame], VK_TRUE, UINT64_MAX);
+    begin_frame();
 
     uint32_t image_index = 0;
     VkResult result = vkAcquireNextImageKHR(context.device.device,
@@ -180,6 +205,7 @@ void RenderContext::Rendering() {
 
     vkResetFences(context.device.device, 1, &in_flight_fences[current_frame]);
 
+    frame_allocator->Flush();
     if (vkQueueSubmit(graphics_queue, 1, &submitInfo, in_flight_fences[current_frame]) !=
         VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer");
@@ -208,7 +234,7 @@ void RenderContext::Rendering() {
 }
 
 void RenderContext::Rendering(const std::function<void(RenderContext &)> &draw_record) {
-    vkWaitForFences(context.device.device, 1, &in_flight_fences[image_index], VK_TRUE, UINT64_MAX);
+    begin_frame();
 
     // uint32_t image_index = 0;
     VkResult result = vkAcquireNextImageKHR(context.device.device,
@@ -236,6 +262,7 @@ void RenderContext::Rendering(const std::function<void(RenderContext &)> &draw_r
     draw_record(*this);
 
     //
+    frame_allocator->Flush();
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -283,8 +310,25 @@ void RenderContext::Rendering(const std::function<void(RenderContext &)> &draw_r
     current_frame = (current_frame + 1) % max_frames_in_flight;
 }
 
-int RenderContext::RenderBegin() {
+void RenderContext::begin_frame() {
     vkWaitForFences(context.device.device, 1, &in_flight_fences[current_frame], VK_TRUE, UINT64_MAX);
+    // the frame's fence has signaled, so its ring region and transient descriptor sets are no longer read by the GPU
+    frame_allocator->BeginFrame(current_frame);
+    descriptor_pools->BeginFrame(current_frame);
+    descriptor_cache->BeginFrame();
+    if (bindless_heap) {
+        bindless_heap->BeginFrame();
+    }
+
+    // submit the copies queued since the last frame ahead of this frame's draws
+    upload_manager->Collect();
+    texture_loader->Collect();
+    mesh_loader->Collect();
+    upload_manager->Flush();
+}
+
+int RenderContext::RenderBegin() {
+    begin_frame();
 
     VkResult result = vkAcquireNextImageKHR(context.device.device,
                                             context.swapchain.swapchain, UINT64_MAX,
@@ -321,6 +365,8 @@ void RenderContext::RenderEnd() {
     image_in_flight[image_index] = in_flight_fences[current_frame];
     vkResetFences(context.device.device, 1, &in_flight_fences[current_frame]);
 
+    frame_allocator->Flush();
+
     //
     VkResult result;
 
@@ -430,6 +476,14 @@ VkFramebuffer RenderContext::GetCurrentFrameBuffer() const {
     return framebuffers[image_index];
 }
 
+VkImage RenderContext::GetCurrentImage() const {
+    return swapchain_images[image_index];
+}
+
+VkImageView RenderContext::GetCurrentImageView() const {
+    return swapchain_image_views[image_index];
+}
+
 VkExtent2D RenderContext::GetExtent() const {
     return context.swapchain.extent;
 }
@@ -453,6 +507,7 @@ void RenderContext::RecreateSwapchain() {
     create_framebuffers();
     create_command_pool();
     create_command_buffers();
+    swapchain_version++;
 
     // if (0 != create_framebuffers(init, data)) return -1;
     // if (0 != create_command_pool(init, data)) return -1;
@@ -12,6 +12,16 @@
 #include <vector>
 
 #include "allocator.h"
+#include "bindless_heap.h"
+#include "descriptor.h"
+#include "frame_ring_allocator.h"
+#include "mesh_loader.h"
+#include "pipeline_compiler.h"
+#include "pipeline_registry.h"
+#include "shader_compiler.h"
+#include "texture_loader.h"
+#include "thread_pool.h"
+#include "upload_manager.h"
 
 
 namespace lvk {
@@ -33,6 +43,10 @@ public:
     [[nodiscard]] VkCommandBuffer GetCurrentCommandBuffer() const;
     uint32_t GetCurrentImageIndex() const;
     [[nodiscard]] VkFramebuffer GetCurrentFrameBuffer() const;
+    [[nodiscard]] VkImage GetCurrentImage() const;
+    [[nodiscard]] VkImageView GetCurrentImageView() const;
+    // bumped by RecreateSwapchain(), whatever was built for the old swapchain images is stale
+    [[nodiscard]] uint32_t GetSwapchainVersion() const { return swapchain_version; };
     [[nodiscard]] VkExtent2D GetExtent() const;
     void Cleanup();
 
@@ -41,6 +55,24 @@ public:
 
     [[nodiscard]] VulkanContext &GetContext() const { return context; };
     [[nodiscard]] Allocator &GetAllocator() const { return *allocator; };
+    [[nodiscard]] FrameRingAllocator &GetFrameAllocator() const { return *frame_allocator; };
+    [[nodiscard]] DescriptorPoolManager &GetDescriptorPoolManager() const { return *descriptor_pools; };
+    [[nodiscard]] DescriptorSetCache &GetDescriptorSetCache() const { return *descriptor_cache; };
+    // nullptr unless the device was created with BindlessTextureHeap::RequireFeatures()
+    [[nodiscard]] BindlessTextureHeap *GetBindlessHeap() const { return bindless_heap.get(); };
+    [[nodiscard]] UploadManager &GetUploadManager() const { return *upload_manager; };
+    [[nodiscard]] TextureLoader &GetTextureLoader() const { return *texture_loader; };
+    [[nodiscard]] MeshLoader &GetMeshLoader() const { return *mesh_loader; };
+    [[nodiscard]] ShaderCompiler &GetShaderCompiler() const { return *shader_compiler; };
+    [[nodiscard]] PipelineRegistry &GetPipelineRegistry() const { return *pipeline_registry; };
+    [[nodiscard]] PipelineCompiler &GetPipelineCompiler() const { return *pipeline_compiler; };
+    // for per-frame CPU work of the render thread, e.g. TransformHierarchy::Update(), the loaders
+    // keep their own workers so long decodes do not hold up a frame
+    [[nodiscard]] ThreadPool &GetWorkers() const { return *workers; };
+    [[nodiscard]] uint32_t GetCurrentFrame() const { return current_frame; };
+
+    // size of each per-frame region in the frame ring allocator
+    static constexpr VkDeviceSize FRAME_ALLOCATOR_SIZE = 4 * 1024 * 1024;
 
 private:
     void reset_swapchain(Swapchain swapchain_);
@@ -50,6 +82,9 @@ private:
     void create_command_pool();
     void create_sync_objects();
     void create_command_buffers();
+    // waits for the frame's fence, recycles its per-frame memory and submits the queued uploads,
+    // every entry point starts a frame with it
+    void begin_frame();
 
     VkQueue graphics_queue{};
     VkQueue present_queue{};
@@ -73,6 +108,7 @@ private:
 
     uint32_t current_frame = 0;
     uint32_t image_index = 0;
+    uint32_t swapchain_version = 0;
 
     uint8_t max_frames_in_flight = 3;
 
@@ -81,6 +117,17 @@ private:
 
     //
     std::unique_ptr<Allocator> allocator;
+    std::unique_ptr<FrameRingAllocator> frame_allocator;
+    std::unique_ptr<DescriptorPoolManager> descriptor_pools;
+    std::unique_ptr<DescriptorSetCache> descriptor_cache;
+    std::unique_ptr<BindlessTextureHeap> bindless_heap;
+    std::unique_ptr<UploadManager> upload_manager;
+    std::unique_ptr<TextureLoader> texture_loader;
+    std::unique_ptr<MeshLoader> mesh_loader;
+    std::unique_ptr<ShaderCompiler> shader_compiler;
+    std::unique_ptr<PipelineRegistry> pipeline_registry;
+    std::unique_ptr<PipelineCompiler> pipeline_compiler;
+    std::unique_ptr<ThreadPool> workers;
     // Swapchain swapchain;
     // Device device;
 };
@@ -0,0 +1,982 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "render_graph.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "render_context.h"
+
+namespace lvk {
+namespace {
+constexpr VkAccessFlags WRITE_ACCESS = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                       VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                       VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT |
+                                       VK_ACCESS_MEMORY_WRITE_BIT;
+
+bool has_stencil(VkFormat format) {
+    return format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT ||
+           format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_S8_UINT;
+}
+
+bool is_image_access(RenderAccess access) {
+    return access == RenderAccess::ColorAttachment || access == RenderAccess::DepthAttachment ||
+           access == RenderAccess::DepthRead || access == RenderAccess::SampledFragment ||
+           access == RenderAccess::SampledCompute || access == RenderAccess::Present;
+}
+
+VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+AccessInfo GetAccessInfo(RenderAccess access) {
+    switch (access) {
+        case RenderAccess::ColorAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true};
+        case RenderAccess::DepthAttachment:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                    true};
+        case RenderAccess::DepthRead:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false};
+        case RenderAccess::SampledFragment:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false};
+        case RenderAccess::SampledCompute:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false};
+        case RenderAccess::StorageRead:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                    VK_IMAGE_USAGE_STORAGE_BIT, false};
+        case RenderAccess::StorageWrite:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true};
+        case RenderAccess::TransferSrc:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false};
+        case RenderAccess::TransferDst:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true};
+        case RenderAccess::VertexInput:
+            return {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                    VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0,
+                    false};
+        case RenderAccess::ShaderRead:
+            return {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_IMAGE_USAGE_SAMPLED_BIT, false};
+        case RenderAccess::Present:
+            return {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 0, false};
+    }
+    throw std::runtime_error("unknown render access!");
+}
+
+AccessInfo GetLayoutAccessInfo(VkImageLayout layout) {
+    switch (layout) {
+        case VK_IMAGE_LAYOUT_UNDEFINED:
+        case VK_IMAGE_LAYOUT_PREINITIALIZED:
+            return {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, layout};
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+            return GetAccessInfo(RenderAccess::TransferDst);
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            return GetAccessInfo(RenderAccess::TransferSrc);
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    VK_ACCESS_SHADER_READ_BIT, layout, VK_IMAGE_USAGE_SAMPLED_BIT};
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+            return GetAccessInfo(RenderAccess::ColorAttachment);
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+            return GetAccessInfo(RenderAccess::DepthAttachment);
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+            return GetAccessInfo(RenderAccess::DepthRead);
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+            return GetAccessInfo(RenderAccess::Present);
+        default:
+            // GENERAL and anything rarer, wait for and block everything
+            return {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, layout,
+                    0, true};
+    }
+}
+
+VkImageAspectFlags GetImageAspect(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_S8_UINT:
+            return VK_IMAGE_ASPECT_STENCIL_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+void RecordImageTransition(VkCommandBuffer command_buffer, VkImage image, VkFormat format,
+                           VkImageLayout old_layout, VkImageLayout new_layout, uint32_t mip_levels) {
+    auto src = GetLayoutAccessInfo(old_layout);
+    auto dst = GetLayoutAccessInfo(new_layout);
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = GetImageAspect(format);
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mip_levels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    // only writes need to be made available, reads just have to finish
+    barrier.srcAccessMask = src.access & WRITE_ACCESS;
+    barrier.dstAccessMask = dst.access;
+
+    vkCmdPipelineBarrier(command_buffer, src.stages, dst.stages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+// *************** RenderGraphPlan *********************
+
+RenderGraphPlan::PassBuilder &RenderGraphPlan::PassBuilder::Color(Resource image, VkAttachmentLoadOp load,
+                                                                  VkClearColorValue clear) {
+    VkClearValue value{};
+    value.color = clear;
+    return graph.addUse(*this, {image, RenderAccess::ColorAttachment, true, load, value});
+}
+
+RenderGraphPlan::PassBuilder &RenderGraphPlan::PassBuilder::Depth(Resource image, VkAttachmentLoadOp load,
+                                                                  VkClearDepthStencilValue clear) {
+    VkClearValue value{};
+    value.depthStencil = clear;
+    return graph.addUse(*this, {image, RenderAccess::DepthAttachment, true, load, value});
+}
+
+RenderGraphPlan::PassBuilder &RenderGraphPlan::PassBuilder::Read(Resource resource, RenderAccess access) {
+    if (GetAccessInfo(access).write) {
+        throw std::runtime_error("failed to add render graph read, the access writes!");
+    }
+    return graph.addUse(*this, {resource, access, false, VK_ATTACHMENT_LOAD_OP_LOAD, {}});
+}
+
+RenderGraphPlan::PassBuilder &RenderGraphPlan::PassBuilder::Write(Resource resource, RenderAccess access) {
+    if (!GetAccessInfo(access).write) {
+        throw std::runtime_error("failed to add render graph write, the access only reads!");
+    }
+    if (access == RenderAccess::ColorAttachment || access == RenderAccess::DepthAttachment) {
+        throw std::runtime_error("failed to add render graph write, attachments go through Color() / Depth()!");
+    }
+    return graph.addUse(*this, {resource, access, false, VK_ATTACHMENT_LOAD_OP_LOAD, {}});
+}
+
+RenderGraphPlan::PassBuilder &RenderGraphPlan::PassBuilder::SideEffect() {
+    graph.passes[pass].side_effect = true;
+    return *this;
+}
+
+RenderGraphPlan::Resource RenderGraphPlan::CreateImage(const std::string &name, const RenderImageDesc &desc) {
+    ResourceNode node{};
+    node.name = name;
+    node.desc = desc;
+    resources.push_back(std::move(node));
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraphPlan::Resource RenderGraphPlan::ImportImage(const std::string &name, const RenderImageDesc &desc,
+                                                       VkImageLayout initial_layout, VkImageLayout final_layout) {
+    ResourceNode node{};
+    node.name = name;
+    node.desc = desc;
+    node.imported = true;
+    node.initial_layout = initial_layout;
+    node.final_layout = final_layout;
+    resources.push_back(std::move(node));
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraphPlan::Resource RenderGraphPlan::ImportBuffer(const std::string &name, VkBuffer buffer) {
+    ResourceNode node{};
+    node.name = name;
+    node.is_image = false;
+    node.imported = true;
+    node.buffer = buffer;
+    resources.push_back(std::move(node));
+    return static_cast<Resource>(resources.size() - 1);
+}
+
+RenderGraphPlan::PassBuilder RenderGraphPlan::AddPass(const std::string &name,
+                                                      std::function<void(const RenderPassContext &)> record) {
+    Pass pass{};
+    pass.name = name;
+    pass.record = std::move(record);
+    passes.push_back(std::move(pass));
+    return {*this, static_cast<uint32_t>(passes.size() - 1)};
+}
+
+RenderGraphPlan::PassBuilder &RenderGraphPlan::addUse(PassBuilder &builder, const Use &use) {
+    if (use.resource >= resources.size()) {
+        throw std::runtime_error("failed to add render graph use, unknown resource!");
+    }
+    auto const &node = resources[use.resource];
+    if (!node.is_image && is_image_access(use.access)) {
+        throw std::runtime_error("failed to add render graph use, `" + node.name + "` is not an image!");
+    }
+    if (node.is_image && use.access == RenderAccess::VertexInput) {
+        throw std::runtime_error("failed to add render graph use, `" + node.name + "` is not a buffer!");
+    }
+    passes[builder.pass].uses.push_back(use);
+    built = false;
+    return builder;
+}
+
+void RenderGraphPlan::Build(const MemoryQuery &query) {
+    clearPlan();
+    for (auto &pass: passes) {
+        pass.culled = false;
+        pass.group = NO_GROUP;
+    }
+    stats = {};
+    stats.passes = static_cast<uint32_t>(passes.size());
+
+    cullPasses();
+    buildGroups();
+    placeTransientImages(query);
+    chooseStoreOps();
+    computeBarriers();
+    built = true;
+}
+
+void RenderGraphPlan::clearPlan() {
+    groups.clear();
+    heaps.clear();
+    for (auto &node: resources) {
+        if (node.imported) {
+            continue;
+        }
+        node.first_group = NO_GROUP;
+        node.last_group = 0;
+        node.usage = 0;
+        node.heap = 0;
+        node.offset = 0;
+        node.size = 0;
+        node.aliased.clear();
+    }
+    final_barriers = {};
+    built = false;
+}
+
+void RenderGraphPlan::cullPasses() {
+    // walking backwards, a resource is needed while a later living pass still reads what is in it
+    std::vector<uint8_t> needed(resources.size());
+    for (size_t resource = 0; resource < resources.size(); resource++) {
+        needed[resource] = resources[resource].imported;
+    }
+
+    for (size_t index = passes.size(); index-- > 0;) {
+        auto &pass = passes[index];
+        bool live = pass.side_effect;
+        for (auto const &use: pass.uses) {
+            live |= GetAccessInfo(use.access).write && needed[use.resource];
+        }
+        if (!live) {
+            pass.culled = true;
+            stats.culled++;
+            continue;
+        }
+        // cleared attachments make whatever was there before dead, anything else depends on it
+        for (auto const &use: pass.uses) {
+            if (use.attachment && use.load != VK_ATTACHMENT_LOAD_OP_LOAD) {
+                needed[use.resource] = false;
+            }
+        }
+        for (auto const &use: pass.uses) {
+            if (!use.attachment || use.load == VK_ATTACHMENT_LOAD_OP_LOAD) {
+                needed[use.resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraphPlan::buildGroups() {
+    for (uint32_t index = 0; index < passes.size(); index++) {
+        auto &pass = passes[index];
+        if (pass.culled) {
+            continue;
+        }
+
+        for (size_t i = 0; i < pass.uses.size(); i++) {
+            for (size_t j = i + 1; j < pass.uses.size(); j++) {
+                auto const &a = pass.uses[i];
+                auto const &b = pass.uses[j];
+                if (a.resource == b.resource && resources[a.resource].is_image &&
+                    GetAccessInfo(a.access).layout != GetAccessInfo(b.access).layout) {
+                    throw std::runtime_error("failed to compile render graph, pass `" + pass.name +
+                                             "` uses `" + resources[a.resource].name + "` in two layouts!");
+                }
+            }
+        }
+
+        std::vector<Attachment> attachments;
+        std::vector<VkClearValue> clear_values;
+        for (auto access: {RenderAccess::ColorAttachment, RenderAccess::DepthAttachment}) {
+            for (auto const &use: pass.uses) {
+                if (use.attachment && use.access == access) {
+                    attachments.push_back({use.resource, use.load, VK_ATTACHMENT_STORE_OP_STORE, use.clear});
+                    clear_values.push_back(use.clear);
+                }
+            }
+        }
+
+        if (!attachments.empty() && !groups.empty() && !groups.back().attachments.empty()) {
+            // one render pass instance: same attachments, loaded, and nothing that needs a barrier in between
+            auto &group = groups.back();
+            bool merge = group.attachments.size() == attachments.size();
+            for (size_t i = 0; merge && i < attachments.size(); i++) {
+                merge = group.attachments[i].image == attachments[i].image &&
+                        attachments[i].load == VK_ATTACHMENT_LOAD_OP_LOAD;
+            }
+            for (auto const &use: pass.uses) {
+                if (!merge || use.attachment) {
+                    continue;
+                }
+                for (auto const &attachment: group.attachments) {
+                    merge &= attachment.image != use.resource;
+                }
+                for (auto other: group.passes) {
+                    for (auto const &other_use: passes[other].uses) {
+                        if (other_use.resource == use.resource &&
+                            (other_use.access != use.access || GetAccessInfo(use.access).write)) {
+                            merge = false;
+                        }
+                    }
+                }
+            }
+            if (merge) {
+                pass.group = static_cast<uint32_t>(groups.size() - 1);
+                group.passes.push_back(index);
+                continue;
+            }
+        }
+
+        Group group{};
+        group.passes = {index};
+        if (!attachments.empty()) {
+            group.extent = resources[attachments[0].image].desc.extent;
+            for (auto const &attachment: attachments) {
+                auto const &extent = resources[attachment.image].desc.extent;
+                if (extent.width != group.extent.width || extent.height != group.extent.height) {
+                    throw std::runtime_error("failed to compile render graph, the attachments of pass `" + pass.name +
+                                             "` differ in extent!");
+                }
+            }
+        }
+        if (!attachments.empty()) {
+            stats.render_passes++;
+        }
+        group.attachments = std::move(attachments);
+        group.clear_values = std::move(clear_values);
+        pass.group = static_cast<uint32_t>(groups.size());
+        groups.push_back(std::move(group));
+    }
+}
+
+void RenderGraphPlan::placeTransientImages(const MemoryQuery &query) {
+    std::vector<Resource> transients;
+    for (uint32_t index = 0; index < groups.size(); index++) {
+        for (auto pass: groups[index].passes) {
+            for (auto const &use: passes[pass].uses) {
+                auto &node = resources[use.resource];
+                if (node.imported) {
+                    continue;
+                }
+                if (node.first_group == NO_GROUP) {
+                    transients.push_back(use.resource);
+                }
+                node.first_group = std::min(node.first_group, index);
+                node.last_group = std::max(node.last_group, index);
+                node.usage |= GetAccessInfo(use.access).image_usage;
+            }
+        }
+    }
+
+    std::vector<VkMemoryRequirements> requirements(resources.size());
+    for (auto resource: transients) {
+        auto &node = resources[resource];
+        requirements[resource] = query(resource, node.usage);
+        node.size = requirements[resource].size;
+        stats.transient_images++;
+        stats.transient_size += node.size;
+    }
+
+    // largest first, each at the lowest offset no image alive at the same time occupies
+    std::vector<Resource> order = transients;
+    std::stable_sort(order.begin(), order.end(), [&](Resource a, Resource b) {
+        return resources[a].size > resources[b].size;
+    });
+    std::vector<Resource> placed;
+    for (auto resource: order) {
+        auto &node = resources[resource];
+        auto const &requirement = requirements[resource];
+
+        auto heap = std::find_if(heaps.begin(), heaps.end(), [&](const Heap &candidate) {
+            return candidate.memory_type_bits == requirement.memoryTypeBits;
+        });
+        if (heap == heaps.end()) {
+            heaps.push_back({requirement.memoryTypeBits});
+            heap = heaps.end() - 1;
+        }
+        node.heap = static_cast<uint32_t>(heap - heaps.begin());
+
+        std::vector<Resource> neighbours;
+        for (auto other: placed) {
+            auto const &other_node = resources[other];
+            if (other_node.heap == node.heap && other_node.first_group <= node.last_group &&
+                node.first_group <= other_node.last_group) {
+                neighbours.push_back(other);
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end(), [&](Resource a, Resource b) {
+            return resources[a].offset < resources[b].offset;
+        });
+        VkDeviceSize offset = 0;
+        for (auto other: neighbours) {
+            auto const &other_node = resources[other];
+            if (align_up(offset, requirement.alignment) + node.size <= other_node.offset) {
+                break;
+            }
+            offset = std::max(offset, other_node.offset + other_node.size);
+        }
+        node.offset = align_up(offset, requirement.alignment);
+        heap->size = std::max(heap->size, node.offset + node.size);
+        heap->alignment = std::max(heap->alignment, requirement.alignment);
+        placed.push_back(resource);
+    }
+
+    for (auto a: transients) {
+        for (auto b: transients) {
+            auto const &earlier = resources[a];
+            auto &later = resources[b];
+            if (earlier.heap == later.heap && earlier.last_group < later.first_group &&
+                earlier.offset < later.offset + later.size && later.offset < earlier.offset + earlier.size) {
+                later.aliased.push_back(a);
+            }
+        }
+    }
+
+    for (auto const &heap: heaps) {
+        stats.transient_memory += heap.size;
+    }
+}
+
+void RenderGraphPlan::chooseStoreOps() {
+    for (uint32_t index = 0; index < groups.size(); index++) {
+        for (auto &attachment: groups[index].attachments) {
+            // stored only when the first later use keeps the contents, or the image leaves the graph
+            bool store = resources[attachment.image].imported;
+            bool decided = false;
+            for (uint32_t later = index + 1; later < groups.size() && !decided; later++) {
+                for (auto pass: groups[later].passes) {
+                    for (auto const &use: passes[pass].uses) {
+                        if (use.resource == attachment.image && !decided) {
+                            store = !use.attachment || use.load == VK_ATTACHMENT_LOAD_OP_LOAD;
+                            decided = true;
+                        }
+                    }
+                }
+            }
+            attachment.store = store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        }
+    }
+}
+
+void RenderGraphPlan::computeBarriers() {
+    // Every Execute() reuses the transient images' memory, so their first access waits for the
+    // last accesses the previous execution made to the same range. A first walk finds those.
+    auto end_states = walkAccesses({});
+    std::vector<ResourceState> start_states(resources.size());
+    for (Resource resource = 0; resource < resources.size(); resource++) {
+        auto const &node = resources[resource];
+        if (node.imported || node.first_group == NO_GROUP) {
+            continue;
+        }
+        for (Resource other = 0; other < resources.size(); other++) {
+            auto const &other_node = resources[other];
+            if (other_node.imported || other_node.first_group == NO_GROUP || other_node.heap != node.heap ||
+                other_node.offset >= node.offset + node.size || node.offset >= other_node.offset + other_node.size) {
+                continue;
+            }
+            start_states[resource].previous_stages |= end_states[other].write_stages | end_states[other].read_stages;
+            start_states[resource].previous_access |= end_states[other].write_access;
+        }
+    }
+
+    for (auto &group: groups) {
+        group.before = {};
+    }
+    final_barriers = {};
+    walkAccesses(std::move(start_states));
+
+    auto count = [this](const BarrierBatch &batch) {
+        if (!batch.IsEmpty()) {
+            stats.barrier_batches++;
+            stats.image_barriers += static_cast<uint32_t>(batch.images.size());
+            stats.buffer_barriers += static_cast<uint32_t>(batch.buffers.size());
+        }
+    };
+    for (auto const &group: groups) {
+        count(group.before);
+    }
+    count(final_barriers);
+}
+
+std::vector<RenderGraphPlan::ResourceState> RenderGraphPlan::walkAccesses(std::vector<ResourceState> states) {
+    states.resize(resources.size());
+    for (size_t resource = 0; resource < resources.size(); resource++) {
+        if (resources[resource].imported) {
+            states[resource].layout = resources[resource].initial_layout;
+        }
+    }
+
+    for (auto &group: groups) {
+        for (auto pass: group.passes) {
+            for (auto const &use: passes[pass].uses) {
+                // merged passes render into attachments the group's first pass already set up
+                if (use.attachment && pass != group.passes[0]) {
+                    continue;
+                }
+                bool discard = use.attachment && use.load != VK_ATTACHMENT_LOAD_OP_LOAD;
+                addAccess(group.before, states, use.resource, GetAccessInfo(use.access), discard);
+            }
+        }
+    }
+
+    for (Resource resource = 0; resource < resources.size(); resource++) {
+        auto const &node = resources[resource];
+        if (node.imported && node.is_image && states[resource].layout != node.final_layout) {
+            addAccess(final_barriers, states, resource, GetLayoutAccessInfo(node.final_layout), false);
+        }
+    }
+    return states;
+}
+
+void RenderGraphPlan::addAccess(BarrierBatch &batch, std::vector<ResourceState> &states, Resource resource,
+                                const AccessInfo &info, bool discard) {
+    auto const &node = resources[resource];
+    auto &state = states[resource];
+    bool first = !state.used;
+    state.used = true;
+
+    // a transient image starts every frame without contents
+    VkImageLayout old_layout = discard || (first && !node.imported) ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+    bool transition = node.is_image && old_layout != info.layout;
+
+    VkPipelineStageFlags src_stages = 0;
+    VkAccessFlags src_access = 0;
+    bool needed = false;
+    if (first) {
+        needed = transition;
+        if (node.imported) {
+            // chains with the semaphore wait the caller put on these stages
+            src_stages = info.stages;
+        } else {
+            // the memory may still be in use by the previous execution, and by the images aliasing
+            // it earlier in this one
+            src_stages = state.previous_stages;
+            src_access = state.previous_access;
+            for (auto other: node.aliased) {
+                src_stages |= states[other].write_stages | states[other].read_stages;
+                src_access |= states[other].write_access;
+            }
+        }
+    } else if (transition || (state.write_stages && info.write)) {
+        // layout changes and write after write wait for everything before
+        needed = true;
+        src_stages = state.write_stages | state.read_stages;
+        src_access = state.write_access;
+    } else if (state.read_stages && info.write) {
+        // write after read only has to wait for the reads to finish
+        needed = true;
+        src_stages = state.read_stages;
+    } else if (state.write_stages && !info.write &&
+               ((info.stages & ~state.visible_stages) || (info.access & ~state.visible_access))) {
+        // read after write, unless an earlier reader's barrier already covers this one
+        needed = true;
+        src_stages = state.write_stages;
+        src_access = state.write_access;
+    }
+
+    if (needed) {
+        batch.src_stages |= src_stages ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        batch.dst_stages |= info.stages;
+        if (node.is_image && (transition || src_access)) {
+            batch.images.push_back({resource, old_layout, info.layout, src_access, info.access});
+        } else if (!node.is_image && src_access) {
+            batch.buffers.push_back({resource, src_access, info.access});
+        }
+        // anything else is an execution dependency, covered by the stage masks alone
+    }
+
+    if (node.is_image) {
+        state.layout = info.layout;
+    }
+    if (info.write) {
+        state.write_stages = info.stages;
+        state.write_access = info.access & WRITE_ACCESS;
+        state.read_stages = 0;
+        state.visible_stages = 0;
+        state.visible_access = 0;
+    } else {
+        state.read_stages |= info.stages;
+        if (needed) {
+            state.visible_stages |= info.stages;
+            state.visible_access |= info.access;
+        }
+    }
+}
+
+// *************** RenderGraph *********************
+
+RenderGraph::RenderGraph(RenderContext &context) : context(context) {
+}
+
+void RenderGraph::SetImage(Resource image, VkImage handle, VkImageView view) {
+    auto &node = resources.at(image);
+    if (!node.imported || !node.is_image) {
+        throw std::runtime_error("failed to set render graph image, it is not an imported image!");
+    }
+    node.image = handle;
+    node.view = view;
+}
+
+void RenderGraph::SetBuffer(Resource buffer, VkBuffer handle) {
+    auto &node = resources.at(buffer);
+    if (node.is_image) {
+        throw std::runtime_error("failed to set render graph buffer, it is an image!");
+    }
+    node.buffer = handle;
+}
+
+void RenderGraph::Compile() {
+    release();
+    Build([this](Resource image, VkImageUsageFlags usage) {
+        return createImage(image, usage);
+    });
+    createImageMemory();
+    createRenderPasses();
+    compiled = true;
+}
+
+VkMemoryRequirements RenderGraph::createImage(Resource image, VkImageUsageFlags usage) {
+    auto device = context.GetContext().device.device;
+    auto &node = resources[image];
+
+    VkImageCreateInfo image_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = node.desc.format;
+    image_info.extent = {node.desc.extent.width, node.desc.extent.height, 1};
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = usage | node.desc.usage;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &image_info, nullptr, &node.image) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create render graph image `" + node.name + "`!");
+    }
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device, node.image, &requirements);
+    return requirements;
+}
+
+void RenderGraph::createImageMemory() {
+    auto device = context.GetContext().device.device;
+
+    for (auto const &heap: heaps) {
+        heap_allocations.push_back(
+            context.GetAllocator().AllocateMemory({heap.size, heap.alignment, heap.memory_type_bits}));
+    }
+    for (auto &node: resources) {
+        if (node.image == VK_NULL_HANDLE || node.imported) {
+            continue;
+        }
+        context.GetAllocator().BindImageMemory(heap_allocations[node.heap], node.offset, node.image);
+
+        VkImageViewCreateInfo view_info{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        view_info.image = node.image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = node.desc.format;
+        view_info.subresourceRange = {GetImageAspect(node.desc.format), 0, 1, 0, 1};
+        if (vkCreateImageView(device, &view_info, nullptr, &node.view) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create render graph image view `" + node.name + "`!");
+        }
+    }
+}
+
+void RenderGraph::createRenderPasses() {
+    auto device = context.GetContext().device.device;
+
+    render_passes.assign(groups.size(), VK_NULL_HANDLE);
+    for (uint32_t index = 0; index < groups.size(); index++) {
+        auto const &group = groups[index];
+        if (group.attachments.empty()) {
+            continue;
+        }
+
+        std::vector<VkAttachmentDescription> descriptions;
+        std::vector<VkAttachmentReference> color_refs;
+        VkAttachmentReference depth_ref{};
+        bool has_depth = false;
+        for (auto const &attachment: group.attachments) {
+            auto const &node = resources[attachment.image];
+            bool depth = (GetImageAspect(node.desc.format) & VK_IMAGE_ASPECT_DEPTH_BIT) != 0;
+            auto layout = depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+                                : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            VkAttachmentDescription description{};
+            description.format = node.desc.format;
+            description.samples = VK_SAMPLE_COUNT_1_BIT;
+            description.loadOp = attachment.load;
+            description.storeOp = attachment.store;
+            description.stencilLoadOp = has_stencil(node.desc.format) ? attachment.load
+                                                                       : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            description.stencilStoreOp = has_stencil(node.desc.format) ? attachment.store
+                                                                        : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            // the graph's barriers move the image in and out of the attachment layout
+            description.initialLayout = layout;
+            description.finalLayout = layout;
+
+            VkAttachmentReference reference{static_cast<uint32_t>(descriptions.size()), layout};
+            if (depth) {
+                depth_ref = reference;
+                has_depth = true;
+            } else {
+                color_refs.push_back(reference);
+            }
+            descriptions.push_back(description);
+        }
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<uint32_t>(color_refs.size());
+        subpass.pColorAttachments = color_refs.data();
+        subpass.pDepthStencilAttachment = has_depth ? &depth_ref : nullptr;
+
+        VkRenderPassCreateInfo render_pass_info{};
+        render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        render_pass_info.attachmentCount = static_cast<uint32_t>(descriptions.size());
+        render_pass_info.pAttachments = descriptions.data();
+        render_pass_info.subpassCount = 1;
+        render_pass_info.pSubpasses = &subpass;
+        if (vkCreateRenderPass(device, &render_pass_info, nullptr, &render_passes[index]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create render graph render pass `" + passes[group.passes[0]].name +
+                                     "`!");
+        }
+    }
+}
+
+void RenderGraph::Execute(VkCommandBuffer command_buffer) {
+    if (!compiled || !IsBuilt()) {
+        throw std::runtime_error("failed to execute render graph, it is not compiled!");
+    }
+
+    for (uint32_t index = 0; index < groups.size(); index++) {
+        auto const &group = groups[index];
+        auto render_pass = render_passes[index];
+        recordBarriers(command_buffer, group.before);
+
+        RenderPassContext pass_context{command_buffer, render_pass, group.extent};
+        if (render_pass == VK_NULL_HANDLE) {
+            for (auto pass: group.passes) {
+                passes[pass].record(pass_context);
+            }
+            continue;
+        }
+
+        VkRenderPassBeginInfo render_pass_info{};
+        render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        render_pass_info.renderPass = render_pass;
+        render_pass_info.framebuffer = getFramebuffer(group, render_pass);
+        render_pass_info.renderArea.offset = {0, 0};
+        render_pass_info.renderArea.extent = group.extent;
+        render_pass_info.clearValueCount = static_cast<uint32_t>(group.clear_values.size());
+        render_pass_info.pClearValues = group.clear_values.data();
+        vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(group.extent.width);
+        viewport.height = static_cast<float>(group.extent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = group.extent;
+        vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+        for (auto pass: group.passes) {
+            passes[pass].record(pass_context);
+        }
+        vkCmdEndRenderPass(command_buffer);
+    }
+
+    recordBarriers(command_buffer, final_barriers);
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer command_buffer, const BarrierBatch &batch) {
+    if (batch.IsEmpty()) {
+        return;
+    }
+
+    image_barriers.clear();
+    for (auto const &barrier: batch.images) {
+        auto const &node = resources[barrier.image];
+        if (node.image == VK_NULL_HANDLE) {
+            throw std::runtime_error("failed to execute render graph, image `" + node.name + "` is not set!");
+        }
+        VkImageMemoryBarrier image_barrier{};
+        image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        image_barrier.srcAccessMask = barrier.src_access;
+        image_barrier.dstAccessMask = barrier.dst_access;
+        image_barrier.oldLayout = barrier.old_layout;
+        image_barrier.newLayout = barrier.new_layout;
+        image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.image = node.image;
+        image_barrier.subresourceRange = {GetImageAspect(node.desc.format), 0, VK_REMAINING_MIP_LEVELS, 0,
+                                          VK_REMAINING_ARRAY_LAYERS};
+        image_barriers.push_back(image_barrier);
+    }
+
+    buffer_barriers.clear();
+    for (auto const &barrier: batch.buffers) {
+        VkBufferMemoryBarrier buffer_barrier{};
+        buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        buffer_barrier.srcAccessMask = barrier.src_access;
+        buffer_barrier.dstAccessMask = barrier.dst_access;
+        buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buffer_barrier.buffer = resources[barrier.buffer].buffer;
+        buffer_barrier.offset = 0;
+        buffer_barrier.size = VK_WHOLE_SIZE;
+        buffer_barriers.push_back(buffer_barrier);
+    }
+
+    vkCmdPipelineBarrier(command_buffer, batch.src_stages, batch.dst_stages, 0, 0, nullptr,
+                         static_cast<uint32_t>(buffer_barriers.size()), buffer_barriers.data(),
+                         static_cast<uint32_t>(image_barriers.size()), image_barriers.data());
+}
+
+VkFramebuffer RenderGraph::getFramebuffer(const Group &group, VkRenderPass render_pass) {
+    std::vector<VkImageView> views;
+    for (auto const &attachment: group.attachments) {
+        auto const &node = resources[attachment.image];
+        if (node.view == VK_NULL_HANDLE) {
+            throw std::runtime_error("failed to execute render graph, image `" + node.name + "` is not set!");
+        }
+        views.push_back(node.view);
+    }
+
+    std::string key(reinterpret_cast<const char *>(&render_pass), sizeof(VkRenderPass));
+    key.append(reinterpret_cast<const char *>(views.data()), views.size() * sizeof(VkImageView));
+    auto found = framebuffers.find(key);
+    if (found != framebuffers.end()) {
+        return found->second;
+    }
+
+    VkFramebufferCreateInfo framebuffer_info{};
+    framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebuffer_info.renderPass = render_pass;
+    framebuffer_info.attachmentCount = static_cast<uint32_t>(views.size());
+    framebuffer_info.pAttachments = views.data();
+    framebuffer_info.width = group.extent.width;
+    framebuffer_info.height = group.extent.height;
+    framebuffer_info.layers = 1;
+
+    VkFramebuffer framebuffer;
+    if (vkCreateFramebuffer(context.GetContext().device.device, &framebuffer_info, nullptr, &framebuffer) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create render graph framebuffer!");
+    }
+    framebuffers.emplace(std::move(key), framebuffer);
+    return framebuffer;
+}
+
+VkRenderPass RenderGraph::GetRenderPass(uint32_t pass) const {
+    auto const &node = passes.at(pass);
+    if (!compiled || node.culled) {
+        return VK_NULL_HANDLE;
+    }
+    return render_passes[node.group];
+}
+
+void RenderGraph::PrintStats() const {
+    std::cout << "[RenderGraph] " << stats.passes << " passes (" << stats.culled << " culled) in "
+            << stats.render_passes << " render passes, " << stats.barrier_batches << " barrier batches ("
+            << stats.image_barriers << " image, " << stats.buffer_barriers << " buffer), "
+            << stats.transient_images << " transient images in " << stats.transient_memory / 1024 << " of "
+            << stats.transient_size / 1024 << " KiB" << std::endl;
+}
+
+void RenderGraph::Reset() {
+    release();
+    passes.clear();
+    resources.clear();
+    stats = {};
+}
+
+void RenderGraph::release() {
+    auto device = context.GetContext().device.device;
+    if (!render_passes.empty() || !heap_allocations.empty() || !framebuffers.empty()) {
+        vkDeviceWaitIdle(device);
+    }
+
+    for (auto const &[key, framebuffer]: framebuffers) {
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    }
+    framebuffers.clear();
+    for (auto render_pass: render_passes) {
+        if (render_pass != VK_NULL_HANDLE) {
+            vkDestroyRenderPass(device, render_pass, nullptr);
+        }
+    }
+    render_passes.clear();
+
+    for (auto &node: resources) {
+        if (node.imported) {
+            continue;
+        }
+        if (node.view != VK_NULL_HANDLE) {
+            // passes may have sampled it through cached sets
+            context.GetDescriptorSetCache().Invalidate(node.view);
+            vkDestroyImageView(device, node.view, nullptr);
+        }
+        if (node.image != VK_NULL_HANDLE) {
+            vkDestroyImage(device, node.image, nullptr);
+        }
+        node.image = VK_NULL_HANDLE;
+        node.view = VK_NULL_HANDLE;
+    }
+    for (auto allocation: heap_allocations) {
+        context.GetAllocator().FreeMemory(allocation);
+    }
+    heap_allocations.clear();
+    clearPlan();
+    compiled = false;
+}
+
+} // end namespace lvk
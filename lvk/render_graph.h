@@ -0,0 +1,376 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_RENDER_GRAPH_H
+#define LYH_RENDER_GRAPH_H
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lvk {
+class RenderContext;
+
+// How a pass uses a resource.
+enum class RenderAccess : uint8_t {
+    ColorAttachment,
+    DepthAttachment,
+    DepthRead, // depth test without depth writes
+    SampledFragment,
+    SampledCompute,
+    StorageRead, // compute
+    StorageWrite, // compute
+    TransferSrc,
+    TransferDst,
+    VertexInput, // vertex and index buffers
+    ShaderRead, // uniform and storage reads of vertex and fragment shaders
+    Present,
+};
+
+// What a barrier around an access has to cover.
+struct AccessInfo {
+    VkPipelineStageFlags stages = 0;
+    VkAccessFlags access = 0;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageUsageFlags image_usage = 0;
+    bool write = false;
+};
+
+AccessInfo GetAccessInfo(RenderAccess access);
+
+// The stages and accesses an image in `layout` is typically used by, for one-off transitions
+// outside a RenderGraph. UNDEFINED and PREINITIALIZED have nothing to wait for.
+AccessInfo GetLayoutAccessInfo(VkImageLayout layout);
+
+VkImageAspectFlags GetImageAspect(VkFormat format);
+
+// Records a barrier moving all mips of `image` from `old_layout` to `new_layout`, waiting for the
+// work the old layout implies and blocking the work the new one does.
+void RecordImageTransition(VkCommandBuffer command_buffer, VkImage image, VkFormat format,
+                           VkImageLayout old_layout, VkImageLayout new_layout, uint32_t mip_levels = 1);
+
+struct RenderImageDesc {
+    VkExtent2D extent{};
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    // on top of the usage the passes' accesses imply
+    VkImageUsageFlags usage = 0;
+};
+
+struct RenderPassContext {
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    // VK_NULL_HANDLE for passes without attachments
+    VkRenderPass render_pass = VK_NULL_HANDLE;
+    VkExtent2D extent{};
+};
+
+struct RenderGraphStats {
+    uint32_t passes = 0;
+    uint32_t culled = 0;
+    uint32_t render_passes = 0; // after merging
+    uint32_t barrier_batches = 0; // vkCmdPipelineBarrier calls per Execute()
+    uint32_t image_barriers = 0;
+    uint32_t buffer_barriers = 0;
+    uint32_t transient_images = 0;
+    VkDeviceSize transient_size = 0; // what the transient images take unaliased
+    VkDeviceSize transient_memory = 0; // what they were given
+};
+
+// The device free half of a RenderGraph: the passes and resources it declares, and what Build()
+// derives from them. Creates no Vulkan objects, so the culling, merging, memory placement and
+// barriers can be checked without a device.
+class RenderGraphPlan {
+public:
+    using Resource = uint32_t;
+    static constexpr Resource NO_RESOURCE = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NO_GROUP = std::numeric_limits<uint32_t>::max();
+
+    class PassBuilder {
+    public:
+        // Attachments of one pass share their extent. With LOAD the previous contents are kept,
+        // CLEAR and DONT_CARE drop them.
+        PassBuilder &Color(Resource image, VkAttachmentLoadOp load = VK_ATTACHMENT_LOAD_OP_LOAD,
+                           VkClearColorValue clear = {});
+
+        PassBuilder &Depth(Resource image, VkAttachmentLoadOp load = VK_ATTACHMENT_LOAD_OP_LOAD,
+                           VkClearDepthStencilValue clear = {1.0f, 0});
+
+        PassBuilder &Read(Resource resource, RenderAccess access);
+
+        PassBuilder &Write(Resource resource, RenderAccess access);
+
+        // Never culled, for passes whose effects the graph cannot see.
+        PassBuilder &SideEffect();
+
+        [[nodiscard]] uint32_t GetPass() const { return pass; }
+
+    private:
+        friend class RenderGraphPlan;
+
+        PassBuilder(RenderGraphPlan &graph, uint32_t pass) : graph(graph), pass(pass) {
+        }
+
+        RenderGraphPlan &graph;
+        uint32_t pass;
+    };
+
+    struct ImageBarrier {
+        Resource image;
+        VkImageLayout old_layout;
+        VkImageLayout new_layout;
+        VkAccessFlags src_access;
+        VkAccessFlags dst_access;
+    };
+
+    struct BufferBarrier {
+        Resource buffer;
+        VkAccessFlags src_access;
+        VkAccessFlags dst_access;
+    };
+
+    struct BarrierBatch {
+        VkPipelineStageFlags src_stages = 0;
+        VkPipelineStageFlags dst_stages = 0;
+        std::vector<ImageBarrier> images;
+        std::vector<BufferBarrier> buffers;
+
+        [[nodiscard]] bool IsEmpty() const { return dst_stages == 0; }
+    };
+
+    struct Attachment {
+        Resource image;
+        VkAttachmentLoadOp load;
+        VkAttachmentStoreOp store;
+        VkClearValue clear;
+    };
+
+    // passes sharing one render pass instance, or a single pass without attachments
+    struct Group {
+        std::vector<uint32_t> passes;
+        std::vector<Attachment> attachments; // colours, then the depth attachment
+        VkExtent2D extent{};
+        std::vector<VkClearValue> clear_values;
+        BarrierBatch before;
+    };
+
+    struct ResourceNode {
+        std::string name;
+        bool is_image = true;
+        bool imported = false;
+        RenderImageDesc desc{};
+        VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // set by the RenderGraph, never touched by the plan
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+
+        // transient images, in groups
+        uint32_t first_group = NO_GROUP;
+        uint32_t last_group = 0;
+        VkImageUsageFlags usage = 0;
+        uint32_t heap = 0;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        // earlier transient images sharing its memory, the first access waits for theirs
+        std::vector<Resource> aliased;
+    };
+
+    // memory shared by transient images with the same memory types
+    struct Heap {
+        uint32_t memory_type_bits = 0;
+        VkDeviceSize size = 0;
+        VkDeviceSize alignment = 1;
+    };
+
+    // The requirements of transient `image` created with `usage`, on top of its desc's usage.
+    using MemoryQuery = std::function<VkMemoryRequirements(Resource image, VkImageUsageFlags usage)>;
+
+    RenderGraphPlan() = default;
+
+    RenderGraphPlan(const RenderGraphPlan &) = delete;
+
+    RenderGraphPlan &operator=(const RenderGraphPlan &) = delete;
+
+    // Created by Compile(), only valid during the frame's passes.
+    Resource CreateImage(const std::string &name, const RenderImageDesc &desc);
+
+    // Not owned. In `initial_layout` when Execute() starts, left in `final_layout`. The graph's
+    // first access chains with a semaphore wait on that access' stages, e.g. the swapchain image
+    // acquire waiting at COLOR_ATTACHMENT_OUTPUT.
+    Resource ImportImage(const std::string &name, const RenderImageDesc &desc, VkImageLayout initial_layout,
+                         VkImageLayout final_layout);
+
+    // Not owned, earlier writes have to be visible when Execute() starts (e.g. host writes before
+    // the submit).
+    Resource ImportBuffer(const std::string &name, VkBuffer buffer);
+
+    PassBuilder AddPass(const std::string &name, std::function<void(const RenderPassContext &)> record);
+
+    // Culls, merges passes into groups, places the transient images asking `query` for each one's
+    // requirements and computes the barriers. Throws when a pass uses an image in two layouts or its
+    // attachments differ in extent.
+    void Build(const MemoryQuery &query);
+
+    [[nodiscard]] bool IsBuilt() const { return built; }
+
+    [[nodiscard]] bool IsCulled(uint32_t pass) const { return passes.at(pass).culled; }
+
+    // NO_GROUP for culled passes
+    [[nodiscard]] uint32_t GetGroup(uint32_t pass) const { return passes.at(pass).group; }
+
+    [[nodiscard]] const std::vector<Group> &GetGroups() const { return groups; }
+
+    [[nodiscard]] const ResourceNode &GetResource(Resource resource) const { return resources.at(resource); }
+
+    [[nodiscard]] const std::vector<Heap> &GetHeaps() const { return heaps; }
+
+    // back to the imported images' final layouts, after the last group
+    [[nodiscard]] const BarrierBatch &GetFinalBarriers() const { return final_barriers; }
+
+    [[nodiscard]] const RenderGraphStats &GetStats() const { return stats; }
+
+protected:
+    struct Use {
+        Resource resource;
+        RenderAccess access;
+        bool attachment;
+        VkAttachmentLoadOp load;
+        VkClearValue clear;
+    };
+
+    struct Pass {
+        std::string name;
+        std::function<void(const RenderPassContext &)> record;
+        std::vector<Use> uses;
+        bool side_effect = false;
+        bool culled = false;
+        uint32_t group = NO_GROUP;
+    };
+
+    // drops what Build() derived, keeps the declarations
+    void clearPlan();
+
+    std::vector<Pass> passes;
+    std::vector<ResourceNode> resources;
+    std::vector<Group> groups;
+    std::vector<Heap> heaps;
+    BarrierBatch final_barriers;
+    RenderGraphStats stats{};
+
+private:
+    // where a resource was left by the accesses so far
+    struct ResourceState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags write_stages = 0;
+        VkAccessFlags write_access = 0;
+        VkPipelineStageFlags read_stages = 0; // since the last write
+        // what the last write was made visible to
+        VkPipelineStageFlags visible_stages = 0;
+        VkAccessFlags visible_access = 0;
+        bool used = false;
+        // transient images, what the previous execution last did to the same memory
+        VkPipelineStageFlags previous_stages = 0;
+        VkAccessFlags previous_access = 0;
+    };
+
+    PassBuilder &addUse(PassBuilder &builder, const Use &use);
+
+    void cullPasses();
+
+    void buildGroups();
+
+    void placeTransientImages(const MemoryQuery &query);
+
+    void chooseStoreOps();
+
+    void computeBarriers();
+
+    // adds each group's accesses and the final transitions to the batches, returns where the
+    // resources are left
+    std::vector<ResourceState> walkAccesses(std::vector<ResourceState> states);
+
+    void addAccess(BarrierBatch &batch, std::vector<ResourceState> &states, Resource resource,
+                   const AccessInfo &info, bool discard);
+
+    bool built = false;
+};
+
+// Frame passes that declare what they read and write, synchronised by the graph.
+//
+// Passes are added in submission order together with the resources they use, then Compile():
+//  - culls passes whose results nothing reads, a pass lives when it writes an imported resource
+//    or something a living pass reads, or has SideEffect();
+//  - merges consecutive passes rendering into the same attachments into one render pass instance,
+//    as long as the later ones load the attachments and use nothing an earlier one wrote;
+//  - creates the transient images and places them in shared memory, images whose lifetimes do not
+//    overlap alias the same range;
+//  - precomputes the barriers: one vkCmdPipelineBarrier before each render pass at most, with only
+//    the hazards and layout changes that are really there, readers of a result share the barrier.
+// All but creating the Vulkan objects is the RenderGraphPlan's Build().
+//
+// The graph is built once and executed every frame. Imported images are set per frame with
+// SetImage(), a graph whose imports change shape (e.g. after a swapchain resize) has to be Reset()
+// and rebuilt. Attachments start the render pass in their attachment layout, the graph's barriers
+// do every transition. Pipelines created against any compatible render pass can be used in a pass.
+class RenderGraph : public RenderGraphPlan {
+public:
+    explicit RenderGraph(RenderContext &context);
+
+    void SetImage(Resource image, VkImage handle, VkImageView view);
+
+    void SetBuffer(Resource buffer, VkBuffer handle);
+
+    // Throws when a pass uses an image in two layouts or its attachments differ in extent.
+    void Compile();
+
+    void Execute(VkCommandBuffer command_buffer);
+
+    // Valid after Compile(), e.g. to create pipelines or write a transient image's descriptors.
+    [[nodiscard]] VkRenderPass GetRenderPass(uint32_t pass) const;
+
+    [[nodiscard]] VkImage GetImage(Resource image) const { return resources.at(image).image; }
+
+    [[nodiscard]] VkImageView GetImageView(Resource image) const { return resources.at(image).view; }
+
+    void PrintStats() const;
+
+    // Drops passes and resources and destroys what Compile() created, after the GPU is done with
+    // them.
+    void Reset();
+
+    void Destroy() { Reset(); }
+
+private:
+    VkMemoryRequirements createImage(Resource image, VkImageUsageFlags usage);
+
+    void createImageMemory();
+
+    void createRenderPasses();
+
+    void recordBarriers(VkCommandBuffer command_buffer, const BarrierBatch &batch);
+
+    // destroys what Compile() created, keeps the declarations
+    void release();
+
+    VkFramebuffer getFramebuffer(const Group &group, VkRenderPass render_pass);
+
+    RenderContext &context;
+
+    bool compiled = false;
+    std::vector<VkRenderPass> render_passes; // by group, VK_NULL_HANDLE without attachments
+    std::vector<VmaAllocation> heap_allocations; // by heap
+    // by render pass and views, imported views change from frame to frame
+    std::unordered_map<std::string, VkFramebuffer> framebuffers;
+    std::vector<VkImageMemoryBarrier> image_barriers;
+    std::vector<VkBufferMemoryBarrier> buffer_barriers;
+};
+
+} // end namespace lvk
+
+#endif //LYH_RENDER_GRAPH_H
@@ -0,0 +1,362 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "shader_compiler.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <glslang/Public/ResourceLimits.h>
+#include <glslang/Public/ShaderLang.h>
+#include <SPIRV/GlslangToSpv.h>
+
+#include "functions.h"
+
+namespace fs = std::filesystem;
+
+namespace lvk {
+namespace {
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+// bump when the way shaders are compiled changes in a way the key does not capture
+constexpr uint32_t SHADER_CACHE_VERSION = 1;
+
+bool stage_from_extension(const std::string &file, EShLanguage &stage) {
+    static const std::pair<const char *, EShLanguage> stages[] = {
+        {".vert", EShLangVertex}, {".frag", EShLangFragment}, {".comp", EShLangCompute},
+        {".geom", EShLangGeometry}, {".tesc", EShLangTessControl}, {".tese", EShLangTessEvaluation},
+        {".task", EShLangTask}, {".mesh", EShLangMesh},
+    };
+    auto extension = fs::path(file).extension().string();
+    for (auto const &[name, value]: stages) {
+        if (extension == name) {
+            stage = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool read_text(const fs::path &path, std::string &text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    text = stream.str();
+    return true;
+}
+
+// Same lookup order for hashing and for glslang: "x" next to the includer first, then the
+// include directories, <x> only in the include directories.
+fs::path resolve_include(const std::string &name, const fs::path &includer, bool local,
+                         const std::vector<std::string> &include_dirs) {
+    if (local) {
+        auto candidate = includer.parent_path() / name;
+        if (fs::exists(candidate)) {
+            return candidate;
+        }
+    }
+    for (auto const &dir: include_dirs) {
+        auto candidate = fs::path(dir) / name;
+        if (fs::exists(candidate)) {
+            return candidate;
+        }
+    }
+    return {};
+}
+
+// Hash the text of every file reachable through #include, in the order they are first seen.
+// A textual scan is enough here, an #include that is compiled out only costs a spurious miss.
+uint64_t hash_includes(const std::string &source, const fs::path &file, const std::vector<std::string> &include_dirs,
+                       std::unordered_set<std::string> &visited, uint64_t hash) {
+    std::istringstream lines(source);
+    std::string line;
+    while (std::getline(lines, line)) {
+        auto begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos || line.compare(begin, 8, "#include") != 0) {
+            continue;
+        }
+        auto open = line.find_first_of("\"<", begin + 8);
+        if (open == std::string::npos) {
+            continue;
+        }
+        auto close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+        if (close == std::string::npos) {
+            continue;
+        }
+
+        auto name = line.substr(open + 1, close - open - 1);
+        auto path = resolve_include(name, file, line[open] == '"', include_dirs);
+        auto key = path.empty() ? name : path.lexically_normal().string();
+        if (!visited.insert(key).second) {
+            continue;
+        }
+
+        std::string text;
+        if (path.empty() || !read_text(path, text)) {
+            // leave the error to glslang, but still key on the name so a later fix is picked up
+            hash = Fnv1a64(name.data(), name.size(), hash);
+            continue;
+        }
+        hash = Fnv1a64(text.data(), text.size(), hash);
+        hash = hash_includes(text, path, include_dirs, visited, hash);
+    }
+    return hash;
+}
+
+class Includer : public glslang::TShader::Includer {
+public:
+    explicit Includer(const std::vector<std::string> &include_dirs) : include_dirs(include_dirs) {
+    }
+
+    IncludeResult *includeLocal(const char *header_name, const char *includer_name, size_t) override {
+        return include(header_name, includer_name, true);
+    }
+
+    IncludeResult *includeSystem(const char *header_name, const char *includer_name, size_t) override {
+        return include(header_name, includer_name, false);
+    }
+
+    void releaseInclude(IncludeResult *result) override {
+        if (result != nullptr) {
+            delete static_cast<std::string *>(result->userData);
+            delete result;
+        }
+    }
+
+private:
+    IncludeResult *include(const char *header_name, const char *includer_name, bool local) {
+        auto path = resolve_include(header_name, includer_name, local, include_dirs);
+        auto text = std::make_unique<std::string>();
+        if (path.empty() || !read_text(path, *text)) {
+            return nullptr;
+        }
+        auto result = new IncludeResult(path.string(), text->data(), text->size(), text.get());
+        text.release();
+        return result;
+    }
+
+    const std::vector<std::string> &include_dirs;
+};
+} // namespace
+
+ShaderCompiler::GlslangProcess::GlslangProcess() {
+    glslang::InitializeProcess();
+}
+
+ShaderCompiler::GlslangProcess::~GlslangProcess() {
+    glslang::FinalizeProcess();
+}
+
+ShaderCompiler::ShaderCompiler(std::string cache_dir, uint32_t thread_count)
+    : cache_dir(std::move(cache_dir)), workers(thread_count) {
+    fs::create_directories(this->cache_dir);
+}
+
+bool ShaderCompiler::IsSource(const std::string &file) {
+    EShLanguage stage;
+    return stage_from_extension(file, stage);
+}
+
+std::vector<char> ShaderCompiler::Compile(const std::string &file, const ShaderCompileOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+
+    EShLanguage stage;
+    if (!stage_from_extension(file, stage)) {
+        throw std::runtime_error("unknown shader stage for " + file);
+    }
+    std::string source;
+    if (!read_text(file, source)) {
+        throw std::runtime_error("failed to open shader " + file);
+    }
+
+    // everything that can change the SPIR-V goes into the key, the file name does not
+    auto version = glslang::GetVersion();
+    uint32_t header[] = {SHADER_CACHE_VERSION, static_cast<uint32_t>(version.major),
+                         static_cast<uint32_t>(version.minor), static_cast<uint32_t>(version.patch),
+                         static_cast<uint32_t>(stage), options.vulkan_minor, options.debug_info ? 1u : 0u};
+    uint64_t key = Fnv1a64(header, sizeof(header));
+    for (auto const &define: options.defines) {
+        key = Fnv1a64(define.c_str(), define.size() + 1, key);
+    }
+    key = Fnv1a64(source.data(), source.size(), key);
+    if (options.debug_info) {
+        // debug info embeds the source path
+        key = Fnv1a64(file.data(), file.size(), key);
+    }
+    std::unordered_set<std::string> visited;
+    key = hash_includes(source, file, options.include_dirs, visited, key);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = memory.find(key);
+        if (found != memory.end()) {
+            stats.memory_hits++;
+            stats.hit_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return found->second;
+        }
+    }
+
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".spv";
+    fs::path cached = fs::path(cache_dir) / name.str();
+
+    std::vector<char> spirv;
+    std::ifstream cache_file(cached, std::ios::binary | std::ios::ate);
+    if (cache_file) {
+        spirv.resize(static_cast<size_t>(cache_file.tellg()));
+        cache_file.seekg(0);
+        cache_file.read(spirv.data(), static_cast<std::streamsize>(spirv.size()));
+
+        uint32_t magic = 0;
+        if (spirv.size() >= sizeof(magic)) {
+            memcpy(&magic, spirv.data(), sizeof(magic));
+        }
+        if (!cache_file || spirv.size() % 4 != 0 || magic != SPIRV_MAGIC) {
+            std::cout << "[ShaderCompiler] ignoring damaged cache entry " << cached.string() << std::endl;
+            spirv.clear();
+        }
+    }
+
+    bool hit = !spirv.empty();
+    if (!hit) {
+        spirv = compileGlsl(file, source, options);
+
+        // write next to the target and rename, a concurrent reader never sees a torn file
+        fs::path temp = cached;
+        temp += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(spirv.data(), static_cast<std::streamsize>(spirv.size()));
+        }
+        std::error_code error;
+        fs::rename(temp, cached, error);
+        if (error) {
+            fs::remove(temp, error);
+        }
+    }
+
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (hit) {
+        stats.disk_hits++;
+        stats.hit_ms += elapsed;
+    } else {
+        stats.compiled++;
+        stats.compile_ms += elapsed;
+    }
+    memory.emplace(key, spirv);
+    return spirv;
+}
+
+ShaderRequest ShaderCompiler::CompileAsync(const std::string &file, const ShaderCompileOptions &options) {
+    return workers.Submit([this, file, options] {
+        return Compile(file, options);
+    }).share();
+}
+
+void ShaderCompiler::CompileDirectory(const std::string &dir, const ShaderCompileOptions &options) {
+    std::vector<ShaderRequest> requests;
+    for (auto const &entry: fs::directory_iterator(dir)) {
+        if (entry.is_regular_file() && IsSource(entry.path().string())) {
+            requests.push_back(CompileAsync(entry.path().string(), options));
+        }
+    }
+    // get() rethrows the first failure after everything else has finished
+    for (auto const &request: requests) {
+        request.wait();
+    }
+    for (auto const &request: requests) {
+        request.get();
+    }
+}
+
+std::vector<char> ShaderCompiler::compileGlsl(const std::string &file, const std::string &source,
+                                              const ShaderCompileOptions &options) const {
+    EShLanguage stage;
+    stage_from_extension(file, stage);
+
+    std::string preamble;
+    for (auto const &define: options.defines) {
+        auto equals = define.find('=');
+        preamble += "#define " + (equals == std::string::npos
+                                      ? define
+                                      : define.substr(0, equals) + " " + define.substr(equals + 1)) + "\n";
+    }
+
+    auto client = static_cast<glslang::EShTargetClientVersion>((1 << 22) | (options.vulkan_minor << 12));
+    // the newest SPIR-V each Vulkan version guarantees
+    glslang::EShTargetLanguageVersion target = glslang::EShTargetSpv_1_0;
+    switch (options.vulkan_minor) {
+        case 0: target = glslang::EShTargetSpv_1_0;
+            break;
+        case 1: target = glslang::EShTargetSpv_1_3;
+            break;
+        case 2: target = glslang::EShTargetSpv_1_5;
+            break;
+        default: target = glslang::EShTargetSpv_1_6;
+            break;
+    }
+    // VK_EXT_mesh_shader requires VK_KHR_spirv_1_4, so task and mesh stages may always use it
+    if ((stage == EShLangTask || stage == EShLangMesh) && target < glslang::EShTargetSpv_1_4) {
+        target = glslang::EShTargetSpv_1_4;
+    }
+
+    const char *strings[] = {source.c_str()};
+    const int lengths[] = {static_cast<int>(source.size())};
+    const char *names[] = {file.c_str()};
+
+    glslang::TShader shader(stage);
+    shader.setStringsWithLengthsAndNames(strings, lengths, names, 1);
+    shader.setPreamble(preamble.c_str());
+    shader.setEnvInput(glslang::EShSourceGlsl, stage, glslang::EShClientVulkan, 100);
+    shader.setEnvClient(glslang::EShClientVulkan, client);
+    shader.setEnvTarget(glslang::EShTargetSpv, target);
+
+    auto messages = static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules);
+    Includer includer(options.include_dirs);
+    if (!shader.parse(GetDefaultResources(), 100, false, messages, includer)) {
+        throw std::runtime_error("failed to compile shader " + file + ":\n" + shader.getInfoLog());
+    }
+
+    glslang::TProgram program;
+    program.addShader(&shader);
+    if (!program.link(messages)) {
+        throw std::runtime_error("failed to link shader " + file + ":\n" + program.getInfoLog());
+    }
+
+    glslang::SpvOptions spv_options;
+    spv_options.generateDebugInfo = options.debug_info;
+    std::vector<uint32_t> words;
+    glslang::GlslangToSpv(*program.getIntermediate(stage), words, &spv_options);
+
+    std::vector<char> spirv(words.size() * sizeof(uint32_t));
+    memcpy(spirv.data(), words.data(), spirv.size());
+    return spirv;
+}
+
+ShaderCompilerStats ShaderCompiler::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void ShaderCompiler::PrintStats() const {
+    auto current = GetStats();
+    uint32_t hits = current.memory_hits + current.disk_hits;
+    std::cout << "[ShaderCompiler] " << hits << " cache hits (" << current.memory_hits << " in memory, "
+            << current.disk_hits << " on disk) "
+            << (hits ? current.hit_ms / hits : 0.0) << " ms avg, "
+            << current.compiled << " compiled "
+            << (current.compiled ? current.compile_ms / current.compiled : 0.0) << " ms avg" << std::endl;
+}
+
+} // end namespace lvk
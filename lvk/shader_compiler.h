@@ -0,0 +1,91 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_SHADER_COMPILER_H
+#define LYH_SHADER_COMPILER_H
+
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "thread_pool.h"
+
+namespace lvk {
+
+struct ShaderCompileOptions {
+    // "NAME" or "NAME=VALUE"
+    std::vector<std::string> defines;
+    // searched for #include <...>, #include "..." looks next to the including file first
+    std::vector<std::string> include_dirs;
+    bool debug_info = false;
+    // SPIR-V is generated for Vulkan 1.<vulkan_minor>
+    uint32_t vulkan_minor = 1;
+};
+
+struct ShaderCompilerStats {
+    uint32_t memory_hits = 0;
+    uint32_t disk_hits = 0;
+    uint32_t compiled = 0;
+    double hit_ms = 0.0;
+    double compile_ms = 0.0;
+};
+
+using ShaderRequest = std::shared_future<std::vector<char>>;
+
+// Compiles GLSL to SPIR-V in process with glslang. Results are cached on disk under the FNV-1a
+// hash of everything that affects the output: the source and every file it includes, stage,
+// defines, options and the glslang version. A changed shader simply hashes to a new file, so
+// the cache never has to be invalidated, stale entries can be deleted at any time.
+class ShaderCompiler {
+public:
+    static constexpr const char *SHADER_CACHE_DIR = "shader_cache";
+
+    explicit ShaderCompiler(std::string cache_dir = SHADER_CACHE_DIR, uint32_t thread_count = 0);
+
+    ShaderCompiler(const ShaderCompiler &) = delete;
+
+    ShaderCompiler &operator=(const ShaderCompiler &) = delete;
+
+    // The stage comes from the extension: .vert .frag .comp .geom .tesc .tese .task .mesh
+    // Throws with glslang's log when the shader does not compile.
+    std::vector<char> Compile(const std::string &file, const ShaderCompileOptions &options = {});
+
+    ShaderRequest CompileAsync(const std::string &file, const ShaderCompileOptions &options = {});
+
+    // Compile every shader source in `dir` in parallel, e.g. to warm the cache at startup.
+    void CompileDirectory(const std::string &dir, const ShaderCompileOptions &options = {});
+
+    // True for files Compile() understands, false for .spv and everything else.
+    static bool IsSource(const std::string &file);
+
+    [[nodiscard]] ShaderCompilerStats GetStats() const;
+
+    void PrintStats() const;
+
+private:
+    // glslang's process wide setup, declared before `workers` so it outlives every compile
+    struct GlslangProcess {
+        GlslangProcess();
+
+        ~GlslangProcess();
+    };
+
+    std::vector<char> compileGlsl(const std::string &file, const std::string &source,
+                                  const ShaderCompileOptions &options) const;
+
+    GlslangProcess process;
+    std::string cache_dir;
+    ThreadPool workers;
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<char>> memory;
+    ShaderCompilerStats stats{};
+};
+
+} // end namespace lvk
+
+#endif //LYH_SHADER_COMPILER_H
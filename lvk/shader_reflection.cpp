@@ -0,0 +1,222 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "shader_reflection.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <spirv_cross.hpp>
+
+namespace lvk {
+namespace {
+VkShaderStageFlagBits to_stage(spv::ExecutionModel model) {
+    switch (model) {
+        case spv::ExecutionModelVertex: return VK_SHADER_STAGE_VERTEX_BIT;
+        case spv::ExecutionModelTessellationControl: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case spv::ExecutionModelTessellationEvaluation: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case spv::ExecutionModelGeometry: return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case spv::ExecutionModelFragment: return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case spv::ExecutionModelGLCompute: return VK_SHADER_STAGE_COMPUTE_BIT;
+        case spv::ExecutionModelTaskEXT: return VK_SHADER_STAGE_TASK_BIT_EXT;
+        case spv::ExecutionModelMeshEXT: return VK_SHADER_STAGE_MESH_BIT_EXT;
+        default: throw std::runtime_error("unsupported shader execution model!");
+    }
+}
+
+// 32 bit and 16 bit scalars / vectors, everything a vertex attribute can reasonably be
+VkFormat to_format(const spirv_cross::SPIRType &type) {
+    using BaseType = spirv_cross::SPIRType::BaseType;
+    static const VkFormat floats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+                                      VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+    static const VkFormat ints[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT,
+                                    VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+    static const VkFormat uints[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT,
+                                     VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+    static const VkFormat halfs[] = {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT,
+                                     VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT};
+
+    if (type.vecsize < 1 || type.vecsize > 4) {
+        throw std::runtime_error("unsupported vertex input vector size!");
+    }
+    switch (type.basetype) {
+        case BaseType::Float: return floats[type.vecsize - 1];
+        case BaseType::Int: return ints[type.vecsize - 1];
+        case BaseType::UInt: return uints[type.vecsize - 1];
+        case BaseType::Half: return halfs[type.vecsize - 1];
+        default: throw std::runtime_error("unsupported vertex input type!");
+    }
+}
+
+uint32_t array_count(const spirv_cross::SPIRType &type) {
+    uint32_t count = 1;
+    for (auto size: type.array) {
+        // 0 is a runtime sized array, left for the caller to size
+        count *= size;
+    }
+    return count;
+}
+} // namespace
+
+ShaderReflection ShaderReflection::Reflect(const std::vector<char> &spirv) {
+    if (spirv.empty() || spirv.size() % sizeof(uint32_t) != 0) {
+        throw std::runtime_error("SPIR-V size is not a multiple of 4!");
+    }
+    std::vector<uint32_t> words(spirv.size() / sizeof(uint32_t));
+    memcpy(words.data(), spirv.data(), spirv.size());
+
+    ShaderReflection reflection{};
+    try {
+        spirv_cross::Compiler compiler(std::move(words));
+        auto stage = to_stage(compiler.get_execution_model());
+        reflection.stages = stage;
+
+        auto resources = compiler.get_shader_resources();
+        auto add = [&](const spirv_cross::SmallVector<spirv_cross::Resource> &list, VkDescriptorType type,
+                       VkDescriptorType buffer_type) {
+            for (auto const &resource: list) {
+                auto const &spir_type = compiler.get_type(resource.type_id);
+                VkDescriptorSetLayoutBinding binding{};
+                binding.binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+                binding.descriptorType = spir_type.image.dim == spv::DimBuffer ? buffer_type : type;
+                binding.descriptorCount = array_count(spir_type);
+                binding.stageFlags = stage;
+
+                ShaderReflection single{};
+                single.sets[compiler.get_decoration(resource.id, spv::DecorationDescriptorSet)] = {binding};
+                reflection.Merge(single);
+            }
+        };
+        add(resources.uniform_buffers, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+        add(resources.storage_buffers, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+        add(resources.sampled_images, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER);
+        add(resources.separate_images, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER);
+        add(resources.separate_samplers, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_SAMPLER);
+        add(resources.storage_images, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER);
+        add(resources.subpass_inputs, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT);
+
+        for (auto const &resource: resources.push_constant_buffers) {
+            // only the bytes the stage reads, so stages using different members get tight ranges
+            auto ranges = compiler.get_active_buffer_ranges(resource.id);
+            size_t begin = 0;
+            size_t end = compiler.get_declared_struct_size(compiler.get_type(resource.base_type_id));
+            if (!ranges.empty()) {
+                begin = ranges.front().offset;
+                end = 0;
+                for (auto const &range: ranges) {
+                    begin = std::min(begin, range.offset);
+                    end = std::max(end, range.offset + range.range);
+                }
+            }
+            reflection.push_constants.push_back(
+                {static_cast<VkShaderStageFlags>(stage), static_cast<uint32_t>(begin),
+                 static_cast<uint32_t>(end - begin)});
+        }
+
+        if (stage == VK_SHADER_STAGE_VERTEX_BIT) {
+            for (auto const &resource: resources.stage_inputs) {
+                auto const &spir_type = compiler.get_type(resource.type_id);
+                uint32_t location = compiler.get_decoration(resource.id, spv::DecorationLocation);
+                VkFormat format = to_format(spir_type);
+                uint32_t size = spir_type.vecsize * spir_type.width / 8;
+                // matrices and arrays take one location per column / element
+                uint32_t count = spir_type.columns * array_count(spir_type);
+                for (uint32_t i = 0; i < count; i++) {
+                    reflection.vertex_inputs.push_back({location + i, format, size});
+                }
+            }
+            std::sort(reflection.vertex_inputs.begin(), reflection.vertex_inputs.end(),
+                      [](auto const &a, auto const &b) { return a.location < b.location; });
+        }
+    } catch (const spirv_cross::CompilerError &e) {
+        throw std::runtime_error(std::string("failed to reflect shader: ") + e.what());
+    }
+    return reflection;
+}
+
+ShaderReflection ShaderReflection::Reflect(const std::vector<std::vector<char>> &stages) {
+    ShaderReflection merged{};
+    for (auto const &spirv: stages) {
+        merged.Merge(Reflect(spirv));
+    }
+    return merged;
+}
+
+void ShaderReflection::Merge(const ShaderReflection &other) {
+    stages |= other.stages;
+
+    for (auto const &[set, bindings]: other.sets) {
+        auto &merged = sets[set];
+        for (auto const &binding: bindings) {
+            auto found = std::find_if(merged.begin(), merged.end(), [&](auto const &existing) {
+                return existing.binding == binding.binding;
+            });
+            if (found == merged.end()) {
+                merged.push_back(binding);
+                continue;
+            }
+            if (found->descriptorType != binding.descriptorType || found->descriptorCount != binding.descriptorCount) {
+                throw std::runtime_error("shader stages disagree on set " + std::to_string(set) + " binding " +
+                                         std::to_string(binding.binding) + "!");
+            }
+            found->stageFlags |= binding.stageFlags;
+        }
+        std::sort(merged.begin(), merged.end(), [](auto const &a, auto const &b) { return a.binding < b.binding; });
+    }
+
+    // one range over everything any stage reads, visible to all of those stages
+    for (auto const &range: other.push_constants) {
+        if (push_constants.empty()) {
+            push_constants.push_back(range);
+            continue;
+        }
+        auto &merged = push_constants.front();
+        uint32_t begin = std::min(merged.offset, range.offset);
+        uint32_t end = std::max(merged.offset + merged.size, range.offset + range.size);
+        merged.stageFlags |= range.stageFlags;
+        merged.offset = begin;
+        merged.size = end - begin;
+    }
+
+    if (vertex_inputs.empty()) {
+        vertex_inputs = other.vertex_inputs;
+    }
+}
+
+std::vector<VkDescriptorSetLayoutBinding> ShaderReflection::GetSetBindings(uint32_t set) const {
+    auto found = sets.find(set);
+    return found == sets.end() ? std::vector<VkDescriptorSetLayoutBinding>{} : found->second;
+}
+
+std::vector<VkVertexInputAttributeDescription> ShaderReflection::GetAttributeDescriptions(
+    uint32_t binding, const std::vector<uint32_t> &offsets) const {
+    if (!offsets.empty() && offsets.size() != vertex_inputs.size()) {
+        throw std::runtime_error("vertex shader takes " + std::to_string(vertex_inputs.size()) + " inputs, " +
+                                 std::to_string(offsets.size()) + " offsets given!");
+    }
+
+    std::vector<VkVertexInputAttributeDescription> attributes(vertex_inputs.size());
+    uint32_t packed = 0;
+    for (size_t i = 0; i < vertex_inputs.size(); i++) {
+        attributes[i].location = vertex_inputs[i].location;
+        attributes[i].binding = binding;
+        attributes[i].format = vertex_inputs[i].format;
+        attributes[i].offset = offsets.empty() ? packed : offsets[i];
+        packed += vertex_inputs[i].size;
+    }
+    return attributes;
+}
+
+uint32_t ShaderReflection::GetPackedStride() const {
+    uint32_t stride = 0;
+    for (auto const &input: vertex_inputs) {
+        stride += input.size;
+    }
+    return stride;
+}
+
+} // end namespace lvk
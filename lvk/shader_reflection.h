@@ -0,0 +1,67 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_SHADER_REFLECTION_H
+#define LYH_SHADER_REFLECTION_H
+
+#include <vulkan/vulkan.h>
+#include <map>
+#include <vector>
+
+namespace lvk {
+
+struct ReflectedVertexInput {
+    uint32_t location;
+    VkFormat format;
+    uint32_t size; // bytes the format occupies
+};
+
+// Descriptor bindings, push constant ranges and vertex inputs read from SPIR-V with spirv-cross.
+// Reflect every stage of a pipeline and Merge() them: bindings used by several stages are
+// combined into one binding with all their stage flags and push constants collapse into a single
+// range, which yields the smallest layout the pipeline can use and one other pipelines with the
+// same resources can share.
+class ShaderReflection {
+public:
+    // Throws when the SPIR-V is malformed or uses something a set layout cannot describe.
+    static ShaderReflection Reflect(const std::vector<char> &spirv);
+
+    static ShaderReflection Reflect(const std::vector<std::vector<char>> &stages);
+
+    // Throws when the two declare the same set / binding with different types or counts.
+    void Merge(const ShaderReflection &other);
+
+    [[nodiscard]] VkShaderStageFlags GetStages() const { return stages; }
+
+    // set index -> bindings ordered by binding number. Runtime sized arrays report
+    // descriptorCount 0, the caller picks the size.
+    [[nodiscard]] const std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> &GetSets() const {
+        return sets;
+    }
+
+    [[nodiscard]] std::vector<VkDescriptorSetLayoutBinding> GetSetBindings(uint32_t set) const;
+
+    [[nodiscard]] const std::vector<VkPushConstantRange> &GetPushConstants() const { return push_constants; }
+
+    // vertex stage inputs ordered by location, matrices take one location per column
+    [[nodiscard]] const std::vector<ReflectedVertexInput> &GetVertexInputs() const { return vertex_inputs; }
+
+    // One attribute per vertex input, with the shader's format. `offsets` gives the offset of each
+    // input in location order; when empty the inputs are packed back to back.
+    [[nodiscard]] std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(
+        uint32_t binding, const std::vector<uint32_t> &offsets = {}) const;
+
+    // Size of one vertex with the inputs packed back to back.
+    [[nodiscard]] uint32_t GetPackedStride() const;
+
+private:
+    VkShaderStageFlags stages = 0;
+    std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> sets;
+    std::vector<VkPushConstantRange> push_constants;
+    std::vector<ReflectedVertexInput> vertex_inputs;
+};
+
+} // end namespace lvk
+
+#endif //LYH_SHADER_REFLECTION_H
@@ -204,7 +204,7 @@ void SimpleDraw::create_graphics_pipeline() {
     pipeline_info.subpass = 0;
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(context.device.device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &graphics_pipeline) !=
+    if (context.pipeline_cache->CreateGraphicsPipelines(1, &pipeline_info, &graphics_pipeline) !=
         VK_SUCCESS) {
         throw std::runtime_error("failed to create pipline\n");
     }
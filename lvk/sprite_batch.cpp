@@ -0,0 +1,224 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "sprite_batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace lvk {
+static constexpr const char *SPRITE_VERT = "../shaders/sprite.vert";
+static constexpr const char *SPRITE_FRAG = "../shaders/sprite.frag";
+
+namespace {
+// glm::packUnorm4x8 rounds through libm, this is the per quad hot path
+uint32_t pack_color(const glm::vec4 &color) {
+    auto channel = [](float value) {
+        return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(color.x) | channel(color.y) << 8 | channel(color.z) << 16 | channel(color.w) << 24;
+}
+
+uint16_t pack_unorm16(float value) {
+    return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+} // namespace
+
+SpriteBatch::SpriteBatch(RenderContext &context) : context(context),
+                                                   frames(Swapchain::MAX_FRAMES_IN_FLIGHT) {
+    if (!context.GetBindlessHeap()) {
+        throw std::runtime_error("sprite batch needs the bindless texture heap!");
+    }
+    AddMaterial(SPRITE_VERT, SPRITE_FRAG);
+}
+
+void SpriteBatch::Destroy() {
+    for (auto &frame: frames) {
+        if (frame.instances) {
+            frame.instances->Destroy();
+        }
+    }
+    frames.clear();
+    for (auto const &material: materials) {
+        context.GetPipelineRegistry().Release(material.pipeline);
+    }
+    materials.clear();
+}
+
+uint16_t SpriteBatch::AddMaterial(const std::string &vert_file, const std::string &frag_file, bool blend) {
+    GraphicsPipelineDesc desc{};
+    desc.vert_file = vert_file;
+    desc.frag_file = frag_file;
+    desc.render_pass = context.GetContext().GetDefaultRenderPass();
+    desc.color_formats = {context.GetContext().swapchain.image_format};
+    // negative sizes mirror a sprite
+    desc.cull_mode = VK_CULL_MODE_NONE;
+    desc.blend_enable = blend;
+
+    auto reflection = context.GetPipelineRegistry().Reflect({vert_file, frag_file});
+    if (reflection.GetVertexInputs().size() != SpriteInstanceLayout::ATTRIBUTE_COUNT) {
+        throw std::runtime_error("failed to add sprite material, shader inputs do not match SpriteInstance!");
+    }
+    // no per vertex data, the shader builds the quad from gl_VertexIndex
+    desc.bindings = {SpriteInstanceLayout::Binding(0, VK_VERTEX_INPUT_RATE_INSTANCE)};
+    constexpr auto attributes = SpriteInstanceLayout::Attributes();
+    desc.attributes.assign(attributes.begin(), attributes.end());
+    desc.push_constants = reflection.GetPushConstants();
+    desc.set_layouts = {context.GetBindlessHeap()->GetLayout()};
+
+    materials.push_back(context.GetPipelineRegistry().Acquire(desc));
+    return static_cast<uint16_t>(materials.size() - 1);
+}
+
+void SpriteBatch::Begin() {
+    sprites.clear();
+}
+
+void SpriteBatch::End(VkCommandBuffer command_buffer, const glm::mat4 &mvp) {
+    stats = {};
+    if (sprites.empty()) {
+        return;
+    }
+
+    // the frame ring is flushed at submit, only batches too large for it use the frame's own buffer
+    auto size = static_cast<VkDeviceSize>(sprites.size()) * sizeof(SpriteInstance);
+    auto instances = context.GetFrameAllocator().TryAllocate(size, alignof(SpriteInstance));
+    FrameBuffers *frame = nullptr;
+    if (instances.buffer == VK_NULL_HANDLE) {
+        // this frame's fence has signaled, its buffer is free to be rewritten or replaced
+        frame = &frames[context.GetCurrentFrame()];
+        reserve(*frame, static_cast<uint32_t>(sprites.size()));
+        instances = {frame->instances->buffer, 0, size, frame->instances->mapped};
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto const &runs = builder.Build(sprites.data(), sprites.size(), static_cast<SpriteInstance *>(instances.data));
+    stats.build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (frame) {
+        frame->instances->Flush(0, size);
+    }
+
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &instances.buffer, &instances.offset);
+
+    VkPipelineLayout bound_layout = VK_NULL_HANDLE;
+    VkPipeline bound_pipeline = VK_NULL_HANDLE;
+    for (auto const &run: runs) {
+        auto const &material = materials[run.material];
+        if (material.pipeline != bound_pipeline) {
+            vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.pipeline);
+            bound_pipeline = material.pipeline;
+        }
+        // the registry hands materials with the same shader interface the same layout
+        if (material.layout != bound_layout) {
+            auto heap_set = context.GetBindlessHeap()->GetSet();
+            vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.layout, 0, 1,
+                                    &heap_set, 0, nullptr);
+            vkCmdPushConstants(command_buffer, material.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4),
+                               &mvp);
+            bound_layout = material.layout;
+        }
+        vkCmdDraw(command_buffer, 6, run.quad_count, 0, run.first_quad);
+    }
+
+    stats.quads = static_cast<uint32_t>(sprites.size());
+    stats.draws = static_cast<uint32_t>(runs.size());
+}
+
+void SpriteBatch::PrintStats() const {
+    std::cout << "[SpriteBatch] " << stats.quads << " quads in " << stats.draws << " draws, built in "
+            << stats.build_ms << " ms (" << (stats.build_ms > 0.0 ? stats.quads / stats.build_ms : 0.0)
+            << " quads/ms)" << std::endl;
+}
+
+void SpriteBatch::reserve(FrameBuffers &frame, uint32_t quads) {
+    if (quads <= frame.capacity) {
+        return;
+    }
+    uint32_t capacity = std::max(frame.capacity, INITIAL_QUADS);
+    while (capacity < quads) {
+        capacity *= 2;
+    }
+
+    if (frame.instances) {
+        frame.instances->Destroy();
+    }
+    frame.instances = context.GetAllocator().CreateBuffer2(
+        static_cast<VkDeviceSize>(capacity) * sizeof(SpriteInstance),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+    frame.capacity = capacity;
+}
+
+const std::vector<SpriteDrawRun> &SpriteBatchBuilder::Build(const Sprite *sprites, size_t count, SpriteInstance *out) {
+    sort_entries.resize(count);
+
+    bool sorted = true;
+    uint64_t differing_bits = 0;
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto const &sprite = sprites[i];
+        uint64_t key = static_cast<uint64_t>(sprite.layer) << 48 | static_cast<uint64_t>(sprite.material) << 32 |
+                       sprite.texture;
+        sort_entries[i] = {key, static_cast<uint32_t>(i)};
+        sorted &= key >= previous;
+        differing_bits |= key ^ sort_entries[0].key;
+        previous = key;
+    }
+    // sprites are often submitted grouped already
+    if (!sorted) {
+        radixSort(sort_entries, sort_scratch, differing_bits);
+    }
+
+    runs.clear();
+    for (uint32_t quad = 0; quad < count; quad++) {
+        auto const &sprite = sprites[sort_entries[quad].index];
+        if (runs.empty() || runs.back().material != sprite.material) {
+            runs.push_back({sprite.material, quad, 0});
+        }
+        runs.back().quad_count++;
+
+        SpriteInstance instance{
+            sprite.pos,
+            sprite.size,
+            {pack_unorm16(sprite.uv.x), pack_unorm16(sprite.uv.y), pack_unorm16(sprite.uv.z), pack_unorm16(sprite.uv.w)},
+            pack_color(sprite.color),
+            sprite.texture,
+        };
+        // one sequential write, the memory may be write combined
+        memcpy(out + quad, &instance, sizeof(instance));
+    }
+    return runs;
+}
+
+// Stable LSD radix sort, 8 bits per pass. Passes over bytes that are the same in every key are
+// skipped, with a handful of layers and materials most of the 8 passes never run.
+void SpriteBatchBuilder::radixSort(std::vector<SortEntry> &entries, std::vector<SortEntry> &scratch,
+                                   uint64_t differing_bits) {
+    scratch.resize(entries.size());
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        if (((differing_bits >> shift) & 0xFF) == 0) {
+            continue;
+        }
+        size_t offsets[256] = {};
+        for (auto const &entry: entries) {
+            offsets[(entry.key >> shift) & 0xFF]++;
+        }
+        size_t sum = 0;
+        for (auto &offset: offsets) {
+            size_t count = offset;
+            offset = sum;
+            sum += count;
+        }
+        for (auto const &entry: entries) {
+            scratch[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+}
+
+} // end namespace lvk
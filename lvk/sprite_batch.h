@@ -0,0 +1,140 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_SPRITE_BATCH_H
+#define LYH_SPRITE_BATCH_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bindless_heap.h"
+#include "buffer.h"
+#include "pipeline_registry.h"
+#include "render_context.h"
+#include "vertex_layout.h"
+
+namespace lvk {
+
+// What the GPU sees of a Sprite, 32 bytes. sprite.vert expands it into a unit quad.
+struct SpriteInstance {
+    glm::vec2 pos;
+    glm::vec2 size;
+    uint16_t uv[4]; // u0 v0 u1 v1 as unorm16
+    uint32_t color; // RGBA8, read as unorm
+    uint32_t texture; // bindless index
+};
+
+using SpriteInstanceLayout = VertexLayout<
+    LVK_VERTEX_ATTRIBUTE(SpriteInstance, pos, VK_FORMAT_R32G32_SFLOAT),
+    LVK_VERTEX_ATTRIBUTE(SpriteInstance, size, VK_FORMAT_R32G32_SFLOAT),
+    LVK_VERTEX_ATTRIBUTE(SpriteInstance, uv, VK_FORMAT_R16G16B16A16_UNORM),
+    LVK_VERTEX_ATTRIBUTE(SpriteInstance, color, VK_FORMAT_R8G8B8A8_UNORM),
+    LVK_VERTEX_ATTRIBUTE(SpriteInstance, texture, VK_FORMAT_R32_UINT)>;
+
+struct Sprite {
+    glm::vec2 pos{0.0f};
+    glm::vec2 size{1.0f};
+    // u0 v0 u1 v1 with v0 at the top edge, within [0, 1]
+    glm::vec4 uv{0.0f, 0.0f, 1.0f, 1.0f};
+    glm::vec4 color{1.0f};
+    // Texture::GetBindlessIndex(), INVALID_INDEX draws the color alone
+    uint32_t texture = BindlessTextureHeap::INVALID_INDEX;
+    // layers are drawn in increasing order, sprites within a layer in no particular order
+    uint16_t layer = 0;
+    // from AddMaterial(), 0 is the alpha blended default
+    uint16_t material = 0;
+};
+
+struct SpriteBatchStats {
+    uint32_t quads = 0;
+    uint32_t draws = 0;
+    double build_ms = 0.0; // sort and vertex write, the CPU cost of End()
+};
+
+struct SpriteDrawRun {
+    uint16_t material;
+    uint32_t first_quad;
+    uint32_t quad_count;
+};
+
+// The CPU half of SpriteBatch::End(): sorts sprites by (layer, material, texture) with a radix
+// sort, writes one SpriteInstance per quad in that order and splits them into runs sharing a
+// material. Needs no device, so sprite_batch_bench drives it directly.
+class SpriteBatchBuilder {
+public:
+    // `out` has room for `count` instances. The runs stay valid until the next Build().
+    const std::vector<SpriteDrawRun> &Build(const Sprite *sprites, size_t count, SpriteInstance *out);
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    static void radixSort(std::vector<SortEntry> &entries, std::vector<SortEntry> &scratch, uint64_t differing_bits);
+
+    std::vector<SortEntry> sort_entries;
+    std::vector<SortEntry> sort_scratch;
+    std::vector<SpriteDrawRun> runs;
+};
+
+// 2D quads collected between Begin() and End() and drawn with as few draws as possible. End()
+// has the SpriteBatchBuilder write the sorted instances straight into the context's
+// FrameRingAllocator and issues one instanced draw per run of quads
+// sharing a material. Textures come from the BindlessTextureHeap and are indexed per instance, so
+// they never split a draw. Batches the ring has no room for go to per-frame instance buffers of
+// the batch's own, which grow to the largest such frame seen.
+class SpriteBatch {
+public:
+    static constexpr uint32_t INITIAL_QUADS = 16 * 1024;
+
+    // Throws when the context has no BindlessTextureHeap.
+    explicit SpriteBatch(RenderContext &context);
+
+    SpriteBatch(const SpriteBatch &) = delete;
+
+    SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+    void Destroy();
+
+    // Shaders take the SpriteInstance layout and the sprite.vert push constant.
+    uint16_t AddMaterial(const std::string &vert_file, const std::string &frag_file, bool blend = true);
+
+    void Begin();
+
+    void Add(const Sprite &sprite) { sprites.push_back(sprite); }
+
+    void Add(const Sprite *p_sprites, size_t count) { sprites.insert(sprites.end(), p_sprites, p_sprites + count); }
+
+    // Records into `command_buffer`, which must be inside the render pass of the current frame.
+    void End(VkCommandBuffer command_buffer, const glm::mat4 &mvp);
+
+    [[nodiscard]] const SpriteBatchStats &GetStats() const { return stats; }
+
+    void PrintStats() const;
+
+private:
+    struct FrameBuffers {
+        std::unique_ptr<Buffer> instances;
+        uint32_t capacity = 0; // quads
+    };
+
+    void reserve(FrameBuffers &frame, uint32_t quads);
+
+    RenderContext &context;
+    std::vector<PipelineHandle> materials;
+    std::vector<FrameBuffers> frames;
+
+    std::vector<Sprite> sprites;
+    SpriteBatchBuilder builder;
+
+    SpriteBatchStats stats{};
+};
+
+} // end namespace lvk
+
+#endif //LYH_SPRITE_BATCH_H
@@ -0,0 +1,115 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "staging_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lvk {
+StagingPool::StagingPool(Allocator &allocator, UploadManager &upload_manager, VkDeviceSize free_budget)
+    : allocator(allocator), upload_manager(upload_manager), free_budget(free_budget) {
+}
+
+VkDeviceSize StagingPool::BucketSize(VkDeviceSize size) {
+    VkDeviceSize bucket = MIN_BUCKET_SIZE;
+    while (bucket < size) {
+        bucket <<= 1;
+    }
+    return bucket;
+}
+
+Buffer *StagingPool::Acquire(VkDeviceSize size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // smallest free buffer that fits
+        auto best = free_staging.end();
+        for (auto it = free_staging.begin(); it != free_staging.end(); ++it) {
+            if (it->capacity >= size && (best == free_staging.end() || it->capacity < best->capacity)) {
+                best = it;
+            }
+        }
+        if (best != free_staging.end()) {
+            Buffer *buffer = best->buffer.get();
+            free_bytes -= best->capacity;
+            used_staging.push_back(std::move(*best));
+            free_staging.erase(best);
+            return buffer;
+        }
+    }
+
+    // VMA is internally synchronized, create outside the lock so workers don't serialize on it
+    StagingBuffer staging{};
+    staging.capacity = BucketSize(size);
+    staging.buffer = allocator.CreateBuffer2(staging.capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                             VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+                                             VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                             VMA_ALLOCATION_CREATE_MAPPED_BIT);
+    if (staging.buffer->GetMappedData() == nullptr) {
+        throw std::runtime_error("failed to map staging buffer!");
+    }
+
+    Buffer *buffer = staging.buffer.get();
+    std::lock_guard<std::mutex> lock(mutex);
+    used_staging.push_back(std::move(staging));
+    return buffer;
+}
+
+void StagingPool::Release(Buffer *buffer, UploadTicket ticket) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(used_staging.begin(), used_staging.end(),
+                           [buffer](const StagingBuffer &staging) { return staging.buffer.get() == buffer; });
+    assert(it != used_staging.end() && "staging buffer does not belong to this pool");
+
+    it->ticket = ticket;
+    pending_staging.push_back(std::move(*it));
+    used_staging.erase(it);
+}
+
+void StagingPool::Collect() {
+    std::lock_guard<std::mutex> lock(mutex);
+    collect_index++;
+    for (auto it = pending_staging.begin(); it != pending_staging.end();) {
+        if (upload_manager.IsComplete(it->ticket)) {
+            it->freed_at = collect_index;
+            free_bytes += it->capacity;
+            free_staging.push_back(std::move(*it));
+            it = pending_staging.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    trimFreeList();
+}
+
+void StagingPool::trimFreeList() {
+    // the free list is ordered by freed_at, so both idle and over budget buffers are at the front;
+    // their uploads are complete and the GPU no longer reads them
+    size_t trimmed = 0;
+    while (trimmed < free_staging.size()) {
+        const StagingBuffer &staging = free_staging[trimmed];
+        bool idle = collect_index - staging.freed_at > MAX_IDLE_COLLECTS;
+        if (!idle && free_bytes <= free_budget) {
+            break;
+        }
+        free_bytes -= staging.capacity;
+        staging.buffer->Destroy();
+        trimmed++;
+    }
+    free_staging.erase(free_staging.begin(), free_staging.begin() + static_cast<std::ptrdiff_t>(trimmed));
+}
+
+void StagingPool::Destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto *list: {&free_staging, &used_staging, &pending_staging}) {
+        for (auto const &staging: *list) {
+            staging.buffer->Destroy();
+        }
+        list->clear();
+    }
+    free_bytes = 0;
+}
+
+} // end namespace lvk
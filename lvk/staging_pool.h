@@ -0,0 +1,80 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_STAGING_POOL_H
+#define LYH_STAGING_POOL_H
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "allocator.h"
+#include "buffer.h"
+#include "upload_manager.h"
+
+namespace lvk {
+
+// Persistently mapped staging buffers for loaders that write their output straight into upload
+// memory from worker threads. A buffer is handed out by Acquire(), given back with the ticket of
+// the upload batch that reads it and reused once Collect() sees that batch complete.
+//
+// Sizes are rounded up to power of two buckets so buffers get reused across differently sized
+// loads. Free buffers idle for more than MAX_IDLE_COLLECTS calls of Collect() are destroyed, and
+// the oldest ones go first whenever the free list holds more than `free_budget` bytes.
+//
+// Acquire() and Release() are thread safe.
+class StagingPool {
+public:
+    static constexpr VkDeviceSize MIN_BUCKET_SIZE = 64 * 1024;
+    static constexpr VkDeviceSize DEFAULT_FREE_BUDGET = 64 * 1024 * 1024;
+    static constexpr uint32_t MAX_IDLE_COLLECTS = 300;
+
+    explicit StagingPool(Allocator &allocator, UploadManager &upload_manager,
+                         VkDeviceSize free_budget = DEFAULT_FREE_BUDGET);
+
+    StagingPool(const StagingPool &) = delete;
+
+    StagingPool &operator=(const StagingPool &) = delete;
+
+    // Smallest free buffer of at least `size` bytes, a new one of the bucket size when none fits.
+    Buffer *Acquire(VkDeviceSize size);
+
+    void Release(Buffer *buffer, UploadTicket ticket);
+
+    // Move buffers of completed uploads back to the free list and trim it. Called once per frame.
+    void Collect();
+
+    void Destroy();
+
+    [[nodiscard]] static VkDeviceSize BucketSize(VkDeviceSize size);
+
+private:
+    struct StagingBuffer {
+        std::unique_ptr<Buffer> buffer;
+        VkDeviceSize capacity = 0;
+        UploadTicket ticket = 0;
+        // Collect() call that moved it to the free list
+        uint64_t freed_at = 0;
+    };
+
+    void trimFreeList();
+
+    Allocator &allocator;
+    UploadManager &upload_manager;
+
+    VkDeviceSize free_budget;
+    VkDeviceSize free_bytes = 0;
+    uint64_t collect_index = 0;
+
+    std::mutex mutex;
+    // oldest first
+    std::vector<StagingBuffer> free_staging;
+    std::vector<StagingBuffer> used_staging;
+    std::vector<StagingBuffer> pending_staging;
+};
+
+} // end namespace lvk
+
+#endif //LYH_STAGING_POOL_H
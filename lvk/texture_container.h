@@ -0,0 +1,118 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_TEXTURE_CONTAINER_H
+#define LYH_TEXTURE_CONTAINER_H
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace lvk {
+// Cooked texture file written by texture_cook:
+//   TextureContainerHeader
+//   TextureContainerLevel[level_count]   largest level first
+//   level data, each level starting at a TEXTURE_CONTAINER_ALIGNMENT aligned file offset
+// Level data is laid out exactly as vkCmdCopyBufferToImage expects it (tightly packed rows or
+// blocks), so the loader copies it into staging memory untouched.
+constexpr uint32_t TEXTURE_CONTAINER_MAGIC = 0x5845544C; // "LTEX"
+constexpr uint32_t TEXTURE_CONTAINER_VERSION = 1;
+constexpr uint64_t TEXTURE_CONTAINER_ALIGNMENT = 16;
+constexpr const char *TEXTURE_CONTAINER_EXTENSION = ".ltex";
+
+struct TextureContainerHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format; // VkFormat
+    uint32_t width;
+    uint32_t height;
+    uint32_t level_count;
+    uint64_t data_size; // bytes from the first level's offset to the end of the last level
+};
+
+struct TextureContainerLevel {
+    uint64_t offset; // from the start of the file
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+static_assert(sizeof(TextureContainerHeader) == 32, "container header layout changed");
+static_assert(sizeof(TextureContainerLevel) == 24, "container level layout changed");
+
+inline const TextureContainerLevel *GetContainerLevels(const TextureContainerHeader *header) {
+    return reinterpret_cast<const TextureContainerLevel *>(header + 1);
+}
+
+// Bytes of one tightly packed level, 0 for formats containers do not hold.
+inline uint64_t GetContainerLevelSize(VkFormat format, uint32_t width, uint32_t height) {
+    uint64_t block_extent = 1;
+    uint64_t block_bytes = 0;
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            block_bytes = 4;
+            break;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            block_extent = 4;
+            block_bytes = 8;
+            break;
+        default:
+            return 0;
+    }
+    return (width + block_extent - 1) / block_extent * ((height + block_extent - 1) / block_extent) * block_bytes;
+}
+
+// Checks a mapped container before anything is read from it, throws on malformed files.
+inline const TextureContainerHeader *ParseTextureContainer(const uint8_t *data, size_t size) {
+    if (size < sizeof(TextureContainerHeader)) {
+        throw std::runtime_error("texture container is truncated!");
+    }
+
+    auto header = reinterpret_cast<const TextureContainerHeader *>(data);
+    if (header->magic != TEXTURE_CONTAINER_MAGIC || header->version != TEXTURE_CONTAINER_VERSION) {
+        throw std::runtime_error("not a texture container or unsupported version!");
+    }
+    auto format = static_cast<VkFormat>(header->format);
+    if (header->width == 0 || header->height == 0 || GetContainerLevelSize(format, 1, 1) == 0) {
+        throw std::runtime_error("texture container has an unsupported format or extent!");
+    }
+    uint32_t max_levels = 1;
+    for (uint32_t extent = std::max(header->width, header->height); extent > 1; extent >>= 1) {
+        max_levels++;
+    }
+    if (header->level_count == 0 || header->level_count > max_levels ||
+        size < sizeof(TextureContainerHeader) + header->level_count * sizeof(TextureContainerLevel)) {
+        throw std::runtime_error("texture container has a bad level table!");
+    }
+
+    // compared by subtracting from bounds already checked, offsets near 2^64 must not wrap around
+    auto levels = GetContainerLevels(header);
+    uint64_t data_begin = levels[0].offset;
+    if (data_begin > size || header->data_size > size - data_begin) {
+        throw std::runtime_error("texture container is truncated!");
+    }
+    for (uint32_t i = 0; i < header->level_count; i++) {
+        auto const &level = levels[i];
+        if (level.width != std::max(header->width >> i, 1u) || level.height != std::max(header->height >> i, 1u) ||
+            level.size != GetContainerLevelSize(format, level.width, level.height)) {
+            throw std::runtime_error("texture container level does not match its format and extent!");
+        }
+        if (level.offset < data_begin || level.offset % TEXTURE_CONTAINER_ALIGNMENT != 0 ||
+            level.size > header->data_size || level.offset - data_begin > header->data_size - level.size) {
+            throw std::runtime_error("texture container level is out of bounds!");
+        }
+    }
+
+    return header;
+}
+
+} // end namespace lvk
+
+#endif //LYH_TEXTURE_CONTAINER_H
@@ -0,0 +1,118 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "texture_loader.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "mapped_file.h"
+#include "mip_generator.h"
+#include "stb_image.h"
+#include "texture_container.h"
+
+namespace lvk {
+TextureLoader::TextureLoader(Allocator &allocator, UploadManager &upload_manager, uint32_t thread_count)
+    : upload_manager(upload_manager), staging_pool(allocator, upload_manager), workers(thread_count) {
+    cpu_mips = !upload_manager.SupportsLinearBlit(FORMAT);
+}
+
+TextureRequest TextureLoader::Load(const std::string &file, bool mipmaps) {
+    std::string extension = TEXTURE_CONTAINER_EXTENSION;
+    bool cooked = file.size() >= extension.size() &&
+                  file.compare(file.size() - extension.size(), extension.size(), extension) == 0;
+
+    return workers.Submit([this, file, mipmaps, cooked] {
+        return cooked ? loadCooked(file) : decode(file, mipmaps);
+    }).share();
+}
+
+DecodedImage TextureLoader::decode(const std::string &file, bool mipmaps) {
+    int texWidth, texHeight, texChannels;
+    stbi_uc *pixels = stbi_load(file.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!pixels) {
+        throw std::runtime_error("failed to load texture image: " + file);
+    }
+
+    DecodedImage image{};
+    image.width = static_cast<uint32_t>(texWidth);
+    image.height = static_cast<uint32_t>(texHeight);
+    image.mip_levels = mipmaps ? MipGenerator::LevelCount(image.width, image.height) : 1;
+    image.size = static_cast<VkDeviceSize>(texWidth) * texHeight * 4;
+
+    // chain is built in cached memory, the staging buffer is write combined and slow to read back
+    std::vector<uint8_t> chain;
+    const uint8_t *source = pixels;
+    if (cpu_mips && image.mip_levels > 1) {
+        auto layout = MipGenerator::Layout(image.width, image.height, image.mip_levels);
+        chain.resize(layout.size);
+        memcpy(chain.data(), pixels, image.size);
+        // already on a worker, so no nested ParallelFor, other textures keep the remaining workers busy
+        MipGenerator::Generate(chain.data(), image.width, image.height, layout, true);
+
+        image.level_offsets.assign(layout.offsets.begin(), layout.offsets.end());
+        image.size = layout.size;
+        source = chain.data();
+    }
+
+    try {
+        image.staging = staging_pool.Acquire(image.size);
+    } catch (...) {
+        stbi_image_free(pixels);
+        throw;
+    }
+    memcpy(image.staging->GetMappedData(), source, image.size);
+    image.staging->Flush(0, image.size);
+
+    stbi_image_free(pixels);
+    return image;
+}
+
+DecodedImage TextureLoader::loadCooked(const std::string &file) {
+    MappedFile mapped(file);
+    auto header = ParseTextureContainer(mapped.GetData(), mapped.GetSize());
+    auto levels = GetContainerLevels(header);
+
+    DecodedImage image{};
+    image.format = static_cast<VkFormat>(header->format);
+    image.width = header->width;
+    image.height = header->height;
+    image.mip_levels = header->level_count;
+    image.size = header->data_size;
+
+    // levels are stored back to back in upload order, one copy moves the whole chain
+    uint64_t data_begin = levels[0].offset;
+    for (uint32_t i = 0; i < header->level_count; i++) {
+        image.level_offsets.push_back(levels[i].offset - data_begin);
+    }
+
+    image.staging = staging_pool.Acquire(image.size);
+    memcpy(image.staging->GetMappedData(), mapped.GetData() + data_begin, image.size);
+    image.staging->Flush(0, image.size);
+    return image;
+}
+
+void TextureLoader::Upload(const DecodedImage &image, VkImage dst, VkImageLayout final_layout) {
+    VkExtent2D extent{image.width, image.height};
+    if (!image.level_offsets.empty()) {
+        upload_manager.EnqueueImageLevels(image.staging->buffer, image.level_offsets, dst, extent, final_layout);
+    } else if (image.mip_levels > 1) {
+        upload_manager.EnqueueImageCopyWithMips(image.staging->buffer, 0, dst, extent, image.mip_levels,
+                                                final_layout);
+    } else {
+        upload_manager.EnqueueImageCopy(image.staging->buffer, 0, dst, extent, final_layout);
+    }
+    staging_pool.Release(image.staging, upload_manager.GetRecordingTicket());
+}
+
+void TextureLoader::Collect() {
+    staging_pool.Collect();
+}
+
+void TextureLoader::Destroy() {
+    upload_manager.WaitIdle();
+    staging_pool.Destroy();
+}
+
+} // end namespace lvk
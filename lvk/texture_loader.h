@@ -0,0 +1,79 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_TEXTURE_LOADER_H
+#define LYH_TEXTURE_LOADER_H
+
+#include <vulkan/vulkan.h>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "allocator.h"
+#include "buffer.h"
+#include "staging_pool.h"
+#include "thread_pool.h"
+#include "upload_manager.h"
+
+namespace lvk {
+
+// Pixels decoded (or copied from a cooked container) straight into a staging buffer borrowed from
+// the loader's pool. `level_offsets` is filled when the whole mip chain was staged, otherwise only
+// level 0 is and the remaining `mip_levels` are blitted on the GPU.
+struct DecodedImage {
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mip_levels = 1;
+    VkDeviceSize size = 0;
+    std::vector<VkDeviceSize> level_offsets;
+    Buffer *staging = nullptr;
+};
+
+using TextureRequest = std::shared_future<DecodedImage>;
+
+// Decodes image files with stb_image on a worker pool. Decoded pixels land in pooled, persistently
+// mapped staging buffers that the upload manager copies from directly, the buffers are returned
+// to the pool once the upload batch that read them has completed.
+class TextureLoader {
+public:
+    static constexpr VkFormat FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
+    explicit TextureLoader(Allocator &allocator, UploadManager &upload_manager, uint32_t thread_count = 0);
+
+    TextureLoader(const TextureLoader &) = delete;
+
+    TextureLoader &operator=(const TextureLoader &) = delete;
+
+    // Starts decoding on a worker thread, get() on the result blocks until the pixels are ready
+    // and rethrows decode errors. With `mipmaps` the full chain is generated, on the worker when
+    // FORMAT can't be linearly blitted on this device.
+    // Files with TEXTURE_CONTAINER_EXTENSION are cooked by texture_cook and are mapped and copied
+    // as they are, with whatever format and levels they were cooked with.
+    TextureRequest Load(const std::string &file, bool mipmaps = true);
+
+    // Queue the copy of `image` into `dst` on the upload manager and hand the staging buffer back
+    // to the pool once that upload has finished. `dst` needs image.mip_levels levels.
+    void Upload(const DecodedImage &image, VkImage dst,
+                VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Move staging buffers of completed uploads back to the free list.
+    void Collect();
+
+    void Destroy();
+
+private:
+    DecodedImage decode(const std::string &file, bool mipmaps);
+
+    DecodedImage loadCooked(const std::string &file);
+
+    UploadManager &upload_manager;
+    StagingPool staging_pool;
+    ThreadPool workers;
+    bool cpu_mips = false;
+};
+
+} // end namespace lvk
+
+#endif //LYH_TEXTURE_LOADER_H
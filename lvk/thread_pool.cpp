@@ -0,0 +1,92 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace lvk {
+ThreadPool::ThreadPool(uint32_t thread_count) {
+    if (thread_count == 0) {
+        uint32_t hardware = std::thread::hardware_concurrency();
+        thread_count = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    workers.reserve(thread_count);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::ParallelFor(uint32_t count, uint32_t grain,
+                             const std::function<void(uint32_t, uint32_t)> &body) {
+    if (count == 0) {
+        return;
+    }
+
+    grain = std::max<uint32_t>(grain, 1);
+    uint32_t max_chunks = GetThreadCount() + 1;
+    uint32_t chunk_count = std::min(max_chunks, (count + grain - 1) / grain);
+    uint32_t chunk_size = (count + chunk_count - 1) / chunk_count;
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunk_count);
+    for (uint32_t begin = chunk_size; begin < count; begin += chunk_size) {
+        uint32_t end = std::min(begin + chunk_size, count);
+        pending.push_back(Submit([&body, begin, end] { body(begin, end); }));
+    }
+
+    // first chunk on the calling thread, workers still reference `body` so wait for them before rethrowing
+    std::exception_ptr error;
+    try {
+        body(0, std::min(chunk_size, count));
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    for (auto &future: pending) {
+        try {
+            future.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // end namespace lvk
@@ -0,0 +1,64 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_THREAD_POOL_H
+#define LYH_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lvk {
+
+class ThreadPool {
+public:
+    // 0 picks hardware_concurrency() - 1 workers (at least one), leaving a core for the render thread.
+    explicit ThreadPool(uint32_t thread_count = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    template<typename F>
+    auto Submit(F &&task) -> std::future<std::invoke_result_t<F>> {
+        using Result = std::invoke_result_t<F>;
+
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        auto future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([packaged] { (*packaged)(); });
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    // Split [0, count) into ranges of at least `grain` items and run them on the workers,
+    // the calling thread takes part too. Blocks until every range is done.
+    // Do not call from inside a pool task, the caller would wait on its own queue.
+    void ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)> &body);
+
+    [[nodiscard]] uint32_t GetThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+};
+
+} // end namespace lvk
+
+#endif //LYH_THREAD_POOL_H
@@ -0,0 +1,435 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "transform_hierarchy.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "thread_pool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LVK_TRANSFORM_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define LVK_TRANSFORM_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace lvk {
+namespace {
+#if LVK_TRANSFORM_SSE2
+#define LVK_TRANSFORM_SIMD 1
+using f32x4 = __m128;
+
+inline f32x4 load4(const float *p) { return _mm_loadu_ps(p); }
+inline void store4(float *p, f32x4 v) { _mm_storeu_ps(p, v); }
+inline f32x4 splat4(float v) { return _mm_set1_ps(v); }
+inline f32x4 add4(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+inline f32x4 sub4(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+inline f32x4 mul4(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+#elif LVK_TRANSFORM_NEON
+#define LVK_TRANSFORM_SIMD 1
+using f32x4 = float32x4_t;
+
+inline f32x4 load4(const float *p) { return vld1q_f32(p); }
+inline void store4(float *p, f32x4 v) { vst1q_f32(p, v); }
+inline f32x4 splat4(float v) { return vdupq_n_f32(v); }
+inline f32x4 add4(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+inline f32x4 sub4(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+inline f32x4 mul4(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+#endif
+
+struct LocalArrays {
+    const float *px, *py, *pz;
+    const float *rx, *ry, *rz, *rw;
+    const float *sx, *sy, *sz;
+};
+
+// column major, scale then rotation then translation
+void compose_local(const LocalArrays &in, uint32_t slot, float *out) {
+    float x = in.rx[slot], y = in.ry[slot], z = in.rz[slot], w = in.rw[slot];
+    float xx = x * x, yy = y * y, zz = z * z;
+    float xy = x * y, xz = x * z, yz = y * z;
+    float wx = w * x, wy = w * y, wz = w * z;
+    float sx = in.sx[slot], sy = in.sy[slot], sz = in.sz[slot];
+
+    out[0] = (1.0f - 2.0f * (yy + zz)) * sx;
+    out[1] = 2.0f * (xy + wz) * sx;
+    out[2] = 2.0f * (xz - wy) * sx;
+    out[3] = 0.0f;
+    out[4] = 2.0f * (xy - wz) * sy;
+    out[5] = (1.0f - 2.0f * (xx + zz)) * sy;
+    out[6] = 2.0f * (yz + wx) * sy;
+    out[7] = 0.0f;
+    out[8] = 2.0f * (xz + wy) * sz;
+    out[9] = 2.0f * (yz - wx) * sz;
+    out[10] = (1.0f - 2.0f * (xx + yy)) * sz;
+    out[11] = 0.0f;
+    out[12] = in.px[slot];
+    out[13] = in.py[slot];
+    out[14] = in.pz[slot];
+    out[15] = 1.0f;
+}
+
+#if LVK_TRANSFORM_SIMD
+// compose_local() for slots [slot, slot + 4), one transform per lane
+void compose_local4(const LocalArrays &in, uint32_t slot, float out[4][16]) {
+    f32x4 x = load4(in.rx + slot), y = load4(in.ry + slot), z = load4(in.rz + slot), w = load4(in.rw + slot);
+    f32x4 xx = mul4(x, x), yy = mul4(y, y), zz = mul4(z, z);
+    f32x4 xy = mul4(x, y), xz = mul4(x, z), yz = mul4(y, z);
+    f32x4 wx = mul4(w, x), wy = mul4(w, y), wz = mul4(w, z);
+    f32x4 sx = load4(in.sx + slot), sy = load4(in.sy + slot), sz = load4(in.sz + slot);
+    f32x4 one = splat4(1.0f), two = splat4(2.0f);
+
+    // the 12 non constant elements, element-major with a lane per transform
+    alignas(16) float elements[12][4];
+    store4(elements[0], mul4(sub4(one, mul4(two, add4(yy, zz))), sx));
+    store4(elements[1], mul4(mul4(two, add4(xy, wz)), sx));
+    store4(elements[2], mul4(mul4(two, sub4(xz, wy)), sx));
+    store4(elements[3], mul4(mul4(two, sub4(xy, wz)), sy));
+    store4(elements[4], mul4(sub4(one, mul4(two, add4(xx, zz))), sy));
+    store4(elements[5], mul4(mul4(two, add4(yz, wx)), sy));
+    store4(elements[6], mul4(mul4(two, add4(xz, wy)), sz));
+    store4(elements[7], mul4(mul4(two, sub4(yz, wx)), sz));
+    store4(elements[8], mul4(sub4(one, mul4(two, add4(xx, yy))), sz));
+    store4(elements[9], load4(in.px + slot));
+    store4(elements[10], load4(in.py + slot));
+    store4(elements[11], load4(in.pz + slot));
+
+    for (int lane = 0; lane < 4; lane++) {
+        float *m = out[lane];
+        m[0] = elements[0][lane];
+        m[1] = elements[1][lane];
+        m[2] = elements[2][lane];
+        m[3] = 0.0f;
+        m[4] = elements[3][lane];
+        m[5] = elements[4][lane];
+        m[6] = elements[5][lane];
+        m[7] = 0.0f;
+        m[8] = elements[6][lane];
+        m[9] = elements[7][lane];
+        m[10] = elements[8][lane];
+        m[11] = 0.0f;
+        m[12] = elements[9][lane];
+        m[13] = elements[10][lane];
+        m[14] = elements[11][lane];
+        m[15] = 1.0f;
+    }
+}
+#endif
+
+// out = a * b, column major
+void multiply(const float *a, const float *b, float *out) {
+#if LVK_TRANSFORM_SIMD
+    f32x4 a0 = load4(a), a1 = load4(a + 4), a2 = load4(a + 8), a3 = load4(a + 12);
+    for (int column = 0; column < 4; column++) {
+        const float *c = b + column * 4;
+        f32x4 result = add4(add4(mul4(a0, splat4(c[0])), mul4(a1, splat4(c[1]))),
+                            add4(mul4(a2, splat4(c[2])), mul4(a3, splat4(c[3]))));
+        store4(out + column * 4, result);
+    }
+#else
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            out[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1] +
+                                    a[8 + row] * b[column * 4 + 2] + a[12 + row] * b[column * 4 + 3];
+        }
+    }
+#endif
+}
+} // namespace
+
+TransformHierarchy::TransformHierarchy(ThreadPool *workers) : workers(workers) {
+}
+
+uint32_t TransformHierarchy::Create(uint32_t parent, const Transform &local) {
+    if (parent != NO_PARENT && !IsAlive(parent)) {
+        throw std::runtime_error("failed to create transform, parent is not alive!");
+    }
+
+    uint32_t id;
+    if (!free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+        world[id] = glm::mat4(1.0f);
+    } else {
+        id = static_cast<uint32_t>(slots.size());
+        slots.push_back(NO_SLOT);
+        world.emplace_back(1.0f);
+        dirty.push_back(0);
+    }
+
+    slots[id] = static_cast<uint32_t>(ids.size());
+    ids.push_back(id);
+    parents.push_back(parent);
+    position_x.push_back(local.position.x);
+    position_y.push_back(local.position.y);
+    position_z.push_back(local.position.z);
+    rotation_x.push_back(local.rotation.x);
+    rotation_y.push_back(local.rotation.y);
+    rotation_z.push_back(local.rotation.z);
+    rotation_w.push_back(local.rotation.w);
+    scale_x.push_back(local.scale.x);
+    scale_y.push_back(local.scale.y);
+    scale_z.push_back(local.scale.z);
+
+    markDirty(id);
+    order_dirty = true;
+    return id;
+}
+
+void TransformHierarchy::Destroy(uint32_t id) {
+    if (!IsAlive(id)) {
+        return;
+    }
+    // with parents first, one pass finds every descendant
+    if (order_dirty) {
+        sortByDepth();
+    }
+
+    std::vector<uint8_t> removed(slots.size(), 0);
+    uint32_t kept = 0;
+    for (uint32_t slot = 0; slot < ids.size(); slot++) {
+        uint32_t node = ids[slot];
+        uint32_t parent = parents[slot];
+        if (node == id || (parent != NO_PARENT && removed[parent])) {
+            removed[node] = 1;
+            slots[node] = NO_SLOT;
+            dirty[node] = 0;
+            free_ids.push_back(node);
+            continue;
+        }
+        if (kept != slot) {
+            ids[kept] = node;
+            parents[kept] = parent;
+            for (auto array: {&position_x, &position_y, &position_z, &rotation_x, &rotation_y, &rotation_z,
+                              &rotation_w, &scale_x, &scale_y, &scale_z}) {
+                (*array)[kept] = (*array)[slot];
+            }
+            slots[node] = kept;
+        }
+        kept++;
+    }
+
+    ids.resize(kept);
+    parents.resize(kept);
+    for (auto array: {&position_x, &position_y, &position_z, &rotation_x, &rotation_y, &rotation_z, &rotation_w,
+                      &scale_x, &scale_y, &scale_z}) {
+        array->resize(kept);
+    }
+    // still parents first, but the level offsets are off
+    order_dirty = true;
+}
+
+void TransformHierarchy::SetParent(uint32_t id, uint32_t parent) {
+    uint32_t slot = slotOf(id);
+    if (parent != NO_PARENT) {
+        if (!IsAlive(parent)) {
+            throw std::runtime_error("failed to set parent, parent is not alive!");
+        }
+        for (uint32_t node = parent; node != NO_PARENT; node = parents[slots[node]]) {
+            if (node == id) {
+                throw std::runtime_error("failed to set parent, the transform would be its own ancestor!");
+            }
+        }
+    }
+    parents[slot] = parent;
+    markDirty(id);
+    order_dirty = true;
+}
+
+void TransformHierarchy::SetLocal(uint32_t id, const Transform &local) {
+    uint32_t slot = slotOf(id);
+    position_x[slot] = local.position.x;
+    position_y[slot] = local.position.y;
+    position_z[slot] = local.position.z;
+    rotation_x[slot] = local.rotation.x;
+    rotation_y[slot] = local.rotation.y;
+    rotation_z[slot] = local.rotation.z;
+    rotation_w[slot] = local.rotation.w;
+    scale_x[slot] = local.scale.x;
+    scale_y[slot] = local.scale.y;
+    scale_z[slot] = local.scale.z;
+    markDirty(id);
+}
+
+void TransformHierarchy::SetPosition(uint32_t id, const glm::vec3 &position) {
+    uint32_t slot = slotOf(id);
+    position_x[slot] = position.x;
+    position_y[slot] = position.y;
+    position_z[slot] = position.z;
+    markDirty(id);
+}
+
+void TransformHierarchy::SetRotation(uint32_t id, const glm::quat &rotation) {
+    uint32_t slot = slotOf(id);
+    rotation_x[slot] = rotation.x;
+    rotation_y[slot] = rotation.y;
+    rotation_z[slot] = rotation.z;
+    rotation_w[slot] = rotation.w;
+    markDirty(id);
+}
+
+void TransformHierarchy::SetScale(uint32_t id, const glm::vec3 &scale) {
+    uint32_t slot = slotOf(id);
+    scale_x[slot] = scale.x;
+    scale_y[slot] = scale.y;
+    scale_z[slot] = scale.z;
+    markDirty(id);
+}
+
+Transform TransformHierarchy::GetLocal(uint32_t id) const {
+    uint32_t slot = slotOf(id);
+    Transform local;
+    local.position = {position_x[slot], position_y[slot], position_z[slot]};
+    local.rotation = glm::quat(rotation_w[slot], rotation_x[slot], rotation_y[slot], rotation_z[slot]);
+    local.scale = {scale_x[slot], scale_y[slot], scale_z[slot]};
+    return local;
+}
+
+void TransformHierarchy::Update() {
+    if (order_dirty) {
+        sortByDepth();
+    }
+    changed.clear();
+    if (!any_dirty) {
+        return;
+    }
+
+    // a level only reads the world matrices of the one before, its transforms are independent
+    for (size_t level = 0; level + 1 < level_offsets.size(); level++) {
+        uint32_t begin = level_offsets[level];
+        uint32_t count = level_offsets[level + 1] - begin;
+        auto body = [this, begin](uint32_t first, uint32_t last) { updateRange(begin + first, begin + last); };
+        if (workers) {
+            workers->ParallelFor(count, UPDATE_GRAIN, body);
+        } else {
+            body(0, count);
+        }
+    }
+
+    for (uint32_t id = 0; id < dirty.size(); id++) {
+        if (dirty[id]) {
+            changed.push_back(id);
+            dirty[id] = 0;
+        }
+    }
+    any_dirty = false;
+}
+
+void TransformHierarchy::sortByDepth() {
+    auto count = static_cast<uint32_t>(ids.size());
+    order_dirty = false;
+    level_offsets.clear();
+    if (count == 0) {
+        return;
+    }
+
+    // depth by id, each ancestor chain is walked once
+    std::vector<uint32_t> depths(slots.size(), NO_SLOT);
+    std::vector<uint32_t> path;
+    uint32_t max_depth = 0;
+    for (uint32_t slot = 0; slot < count; slot++) {
+        path.clear();
+        uint32_t node = ids[slot];
+        while (node != NO_PARENT && depths[node] == NO_SLOT) {
+            path.push_back(node);
+            node = parents[slots[node]];
+        }
+        uint32_t depth = node == NO_PARENT ? 0 : depths[node] + 1;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            depths[*it] = depth++;
+        }
+        max_depth = std::max(max_depth, depths[ids[slot]]);
+    }
+
+    level_offsets.assign(max_depth + 2, 0);
+    for (uint32_t slot = 0; slot < count; slot++) {
+        level_offsets[depths[ids[slot]] + 1]++;
+    }
+    for (size_t level = 1; level < level_offsets.size(); level++) {
+        level_offsets[level] += level_offsets[level - 1];
+    }
+
+    std::vector<uint32_t> order(count);
+    std::vector<uint32_t> fill(level_offsets.begin(), level_offsets.end() - 1);
+    for (uint32_t slot = 0; slot < count; slot++) {
+        order[fill[depths[ids[slot]]]++] = slot;
+    }
+
+    auto permute = [&](auto &array) {
+        std::remove_reference_t<decltype(array)> sorted(count);
+        for (uint32_t slot = 0; slot < count; slot++) {
+            sorted[slot] = array[order[slot]];
+        }
+        array.swap(sorted);
+    };
+    permute(ids);
+    permute(parents);
+    for (auto array: {&position_x, &position_y, &position_z, &rotation_x, &rotation_y, &rotation_z, &rotation_w,
+                      &scale_x, &scale_y, &scale_z}) {
+        permute(*array);
+    }
+    for (uint32_t slot = 0; slot < count; slot++) {
+        slots[ids[slot]] = slot;
+    }
+}
+
+void TransformHierarchy::updateRange(uint32_t begin, uint32_t end) {
+    LocalArrays in{
+        position_x.data(), position_y.data(), position_z.data(),
+        rotation_x.data(), rotation_y.data(), rotation_z.data(), rotation_w.data(),
+        scale_x.data(), scale_y.data(), scale_z.data(),
+    };
+
+    // a transform is recomputed when it changed or its parent was recomputed
+    auto propagate = [this](uint32_t slot) {
+        uint32_t id = ids[slot];
+        uint32_t parent = parents[slot];
+        dirty[id] |= parent != NO_PARENT ? dirty[parent] : 0;
+        return dirty[id] != 0;
+    };
+    auto store = [this](uint32_t slot, const float *local) {
+        uint32_t parent = parents[slot];
+        float *out = &world[ids[slot]][0][0];
+        if (parent == NO_PARENT) {
+            memcpy(out, local, sizeof(float) * 16);
+        } else {
+            multiply(&world[parent][0][0], local, out);
+        }
+    };
+
+    uint32_t slot = begin;
+#if LVK_TRANSFORM_SIMD
+    for (; slot + 4 <= end; slot += 4) {
+        uint32_t mask = 0;
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            mask |= static_cast<uint32_t>(propagate(slot + lane)) << lane;
+        }
+        // untouched subtrees cost the flag checks only
+        if (mask == 0) {
+            continue;
+        }
+        alignas(16) float local[4][16];
+        compose_local4(in, slot, local);
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            if (mask & (1u << lane)) {
+                store(slot + lane, local[lane]);
+            }
+        }
+    }
+#endif
+    for (; slot < end; slot++) {
+        if (propagate(slot)) {
+            float local[16];
+            compose_local(in, slot, local);
+            store(slot, local);
+        }
+    }
+}
+
+} // end namespace lvk
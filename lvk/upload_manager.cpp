@@ -0,0 +1,483 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "upload_manager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace lvk {
+static constexpr VkPipelineStageFlags CONSUMER_STAGES = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                                                        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+static constexpr VkAccessFlags BUFFER_CONSUMER_ACCESS = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                                                        VK_ACCESS_INDEX_READ_BIT |
+                                                        VK_ACCESS_UNIFORM_READ_BIT |
+                                                        VK_ACCESS_SHADER_READ_BIT;
+
+static VkCommandPool create_command_pool(VkDevice device, uint32_t family) {
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = family;
+
+    VkCommandPool pool;
+    if (vkCreateCommandPool(device, &pool_info, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload command pool");
+    }
+    return pool;
+}
+
+static VkCommandBuffer begin_command_buffer(VkDevice device, VkCommandPool pool) {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = pool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    return commandBuffer;
+}
+
+UploadManager::UploadManager(VulkanContext &context, Allocator &allocator)
+    : context(context), allocator(allocator) {
+    auto &device = context.device;
+
+    graphics_family = device.GetQueueIndex(QueueType::kGraphics);
+    graphics_queue = device.GetQueue(QueueType::kGraphics);
+
+    if (device.physical_device.HasDedicatedTransferQueue()) {
+        transfer_family = device.GetDedicatedQueueIndex(QueueType::kTransfer);
+        transfer_queue = device.GetDedicatedQueue(QueueType::kTransfer);
+    } else {
+        transfer_family = graphics_family;
+        transfer_queue = graphics_queue;
+    }
+
+    graphics_pool = create_command_pool(device.device, graphics_family);
+    transfer_pool = create_command_pool(device.device, transfer_family);
+}
+
+UploadManager::StagingRange UploadManager::stage(const void *data, VkDeviceSize size) {
+    staging_head = (staging_head + 15) & ~static_cast<VkDeviceSize>(15);
+
+    if (current.staging.empty() || staging_head + size > staging_capacity) {
+        staging_capacity = std::max(STAGING_CHUNK_SIZE, size);
+        staging_head = 0;
+        current.staging.push_back(allocator.CreateBuffer2(staging_capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                          VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+                                                          VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                                          VMA_ALLOCATION_CREATE_MAPPED_BIT));
+    }
+
+    auto &chunk = current.staging.back();
+    auto *mapped = static_cast<uint8_t *>(chunk->GetMappedData());
+    if (mapped == nullptr) {
+        throw std::runtime_error("failed to map upload staging buffer!");
+    }
+    memcpy(mapped + staging_head, data, size);
+    chunk->Flush(staging_head, size);
+
+    StagingRange range{chunk->buffer, staging_head};
+    staging_head += size;
+    return range;
+}
+
+void UploadManager::beginBatch() {
+    if (recording) {
+        return;
+    }
+    current = Batch{};
+    current.transfer_cmd = begin_command_buffer(context.device.device, transfer_pool);
+    staging_head = 0;
+    staging_capacity = 0;
+    recording = true;
+}
+
+void UploadManager::EnqueueBufferCopy(const void *data, VkDeviceSize size, VkBuffer dst, VkDeviceSize dst_offset,
+                                      VkPipelineStageFlags consumer_stages) {
+    beginBatch();
+    auto src = stage(data, size);
+    EnqueueBufferCopy(src.buffer, src.offset, size, dst, dst_offset, consumer_stages);
+}
+
+void UploadManager::EnqueueBufferCopy(VkBuffer src_buffer, VkDeviceSize src_offset, VkDeviceSize size, VkBuffer dst,
+                                      VkDeviceSize dst_offset, VkPipelineStageFlags consumer_stages) {
+    beginBatch();
+
+    VkBufferCopy region{};
+    region.srcOffset = src_offset;
+    region.dstOffset = dst_offset;
+    region.size = size;
+    vkCmdCopyBuffer(current.transfer_cmd, src_buffer, dst, 1, &region);
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = BUFFER_CONSUMER_ACCESS;
+    barrier.buffer = dst;
+    barrier.offset = dst_offset;
+    barrier.size = size;
+    buffer_handoffs.push_back(barrier);
+    handoff_stages |= consumer_stages;
+}
+
+void UploadManager::EnqueueImageCopy(const void *data, VkDeviceSize size, VkImage dst, VkExtent2D extent,
+                                     VkImageLayout final_layout) {
+    beginBatch();
+    auto src = stage(data, size);
+    EnqueueImageCopy(src.buffer, src.offset, dst, extent, final_layout);
+}
+
+void UploadManager::EnqueueImageCopy(VkBuffer src_buffer, VkDeviceSize src_offset, VkImage dst, VkExtent2D extent,
+                                     VkImageLayout final_layout) {
+    EnqueueImageLevels(src_buffer, {src_offset}, dst, extent, final_layout);
+}
+
+void UploadManager::EnqueueImageLevels(VkBuffer src_buffer, const std::vector<VkDeviceSize> &level_offsets,
+                                       VkImage dst, VkExtent2D extent, VkImageLayout final_layout) {
+    auto level_count = static_cast<uint32_t>(level_offsets.size());
+    auto barrier = recordImageCopy(src_buffer, level_offsets.data(), level_count, level_count, dst, extent);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = final_layout;
+    image_handoffs.push_back(barrier);
+}
+
+void UploadManager::EnqueueImageCopyWithMips(VkBuffer src_buffer, VkDeviceSize src_offset, VkImage dst,
+                                             VkExtent2D extent, uint32_t mip_levels, VkImageLayout final_layout) {
+    auto barrier = recordImageCopy(src_buffer, &src_offset, 1, mip_levels, dst, extent);
+
+    // hand the whole chain over still in TRANSFER_DST, the blits on the graphics queue do the final transitions
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    image_handoffs.push_back(barrier);
+
+    mip_blits.push_back({dst, extent, mip_levels, final_layout});
+}
+
+bool UploadManager::SupportsLinearBlit(VkFormat format) const {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(context.device.physical_device.physical_device, format, &properties);
+
+    constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                              VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                              VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+VkImageMemoryBarrier UploadManager::recordImageCopy(VkBuffer src_buffer, const VkDeviceSize *level_offsets,
+                                                    uint32_t copy_levels, uint32_t mip_levels, VkImage dst,
+                                                    VkExtent2D extent) {
+    beginBatch();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = dst;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mip_levels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(current.transfer_cmd,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    std::vector<VkBufferImageCopy> regions(copy_levels);
+    for (uint32_t level = 0; level < copy_levels; level++) {
+        auto &region = regions[level];
+        region.bufferOffset = level_offsets[level];
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), 1};
+    }
+
+    vkCmdCopyBufferToImage(current.transfer_cmd, src_buffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           copy_levels, regions.data());
+
+    return barrier;
+}
+
+void UploadManager::recordMipBlits(VkCommandBuffer cmd) {
+    for (auto const &blit: mip_blits) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = blit.image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        auto width = static_cast<int32_t>(blit.extent.width);
+        auto height = static_cast<int32_t>(blit.extent.height);
+
+        for (uint32_t level = 1; level < blit.mip_levels; level++) {
+            // previous level becomes the blit source
+            barrier.subresourceRange.baseMipLevel = level - 1;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            int32_t next_width = std::max(width / 2, 1);
+            int32_t next_height = std::max(height / 2, 1);
+
+            VkImageBlit region{};
+            region.srcOffsets[0] = {0, 0, 0};
+            region.srcOffsets[1] = {width, height, 1};
+            region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.srcSubresource.mipLevel = level - 1;
+            region.srcSubresource.baseArrayLayer = 0;
+            region.srcSubresource.layerCount = 1;
+            region.dstOffsets[0] = {0, 0, 0};
+            region.dstOffsets[1] = {next_width, next_height, 1};
+            region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.dstSubresource.mipLevel = level;
+            region.dstSubresource.baseArrayLayer = 0;
+            region.dstSubresource.layerCount = 1;
+
+            vkCmdBlitImage(cmd,
+                           blit.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           blit.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1, &region, VK_FILTER_LINEAR);
+
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.newLayout = blit.final_layout;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, CONSUMER_STAGES,
+                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            width = next_width;
+            height = next_height;
+        }
+
+        // last level was only ever written
+        barrier.subresourceRange.baseMipLevel = blit.mip_levels - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = blit.final_layout;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, CONSUMER_STAGES,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+void UploadManager::recordOwnershipTransfers() {
+    if (image_handoffs.empty() && buffer_handoffs.empty()) {
+        return;
+    }
+
+    // mip blits read and write the transferred images before any draw does
+    VkPipelineStageFlags consumer_stages = CONSUMER_STAGES | handoff_stages;
+    if (!mip_blits.empty()) {
+        consumer_stages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+
+    if (!UsesDedicatedTransferQueue()) {
+        // same queue family, a plain barrier makes the copies visible to the draws submitted after us
+        vkCmdPipelineBarrier(current.transfer_cmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, consumer_stages,
+                             0, 0, nullptr,
+                             static_cast<uint32_t>(buffer_handoffs.size()), buffer_handoffs.data(),
+                             static_cast<uint32_t>(image_handoffs.size()), image_handoffs.data());
+        recordMipBlits(current.transfer_cmd);
+        return;
+    }
+
+    // release on the transfer queue family
+    auto release_buffers = buffer_handoffs;
+    auto release_images = image_handoffs;
+    for (auto &barrier: release_buffers) {
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = transfer_family;
+        barrier.dstQueueFamilyIndex = graphics_family;
+    }
+    for (auto &barrier: release_images) {
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = transfer_family;
+        barrier.dstQueueFamilyIndex = graphics_family;
+    }
+    vkCmdPipelineBarrier(current.transfer_cmd,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr,
+                         static_cast<uint32_t>(release_buffers.size()), release_buffers.data(),
+                         static_cast<uint32_t>(release_images.size()), release_images.data());
+
+    // matching acquire on the graphics queue family
+    current.graphics_cmd = begin_command_buffer(context.device.device, graphics_pool);
+    for (auto &barrier: buffer_handoffs) {
+        barrier.srcAccessMask = 0;
+        barrier.srcQueueFamilyIndex = transfer_family;
+        barrier.dstQueueFamilyIndex = graphics_family;
+    }
+    for (auto &barrier: image_handoffs) {
+        barrier.srcAccessMask = 0;
+        barrier.srcQueueFamilyIndex = transfer_family;
+        barrier.dstQueueFamilyIndex = graphics_family;
+    }
+    vkCmdPipelineBarrier(current.graphics_cmd,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, consumer_stages,
+                         0, 0, nullptr,
+                         static_cast<uint32_t>(buffer_handoffs.size()), buffer_handoffs.data(),
+                         static_cast<uint32_t>(image_handoffs.size()), image_handoffs.data());
+    // blits need a graphics capable queue, so they run after the acquire
+    recordMipBlits(current.graphics_cmd);
+}
+
+UploadTicket UploadManager::Flush() {
+    if (!recording) {
+        return last_submitted;
+    }
+
+    auto device = context.device.device;
+
+    recordOwnershipTransfers();
+    image_handoffs.clear();
+    buffer_handoffs.clear();
+    handoff_stages = 0;
+    mip_blits.clear();
+
+    vkEndCommandBuffer(current.transfer_cmd);
+    if (current.graphics_cmd != VK_NULL_HANDLE) {
+        vkEndCommandBuffer(current.graphics_cmd);
+    }
+
+    VkFenceCreateInfo fence_info{};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(device, &fence_info, nullptr, &current.fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload fence");
+    }
+
+    VkSubmitInfo transfer_submit{};
+    transfer_submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    transfer_submit.commandBufferCount = 1;
+    transfer_submit.pCommandBuffers = &current.transfer_cmd;
+
+    if (current.graphics_cmd == VK_NULL_HANDLE) {
+        if (vkQueueSubmit(transfer_queue, 1, &transfer_submit, current.fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload command buffer");
+        }
+    } else {
+        VkSemaphoreCreateInfo semaphore_info{};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(device, &semaphore_info, nullptr, &current.semaphore) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload semaphore");
+        }
+
+        transfer_submit.signalSemaphoreCount = 1;
+        transfer_submit.pSignalSemaphores = &current.semaphore;
+        if (vkQueueSubmit(transfer_queue, 1, &transfer_submit, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload command buffer");
+        }
+
+        VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo acquire_submit{};
+        acquire_submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        acquire_submit.waitSemaphoreCount = 1;
+        acquire_submit.pWaitSemaphores = &current.semaphore;
+        acquire_submit.pWaitDstStageMask = &wait_stage;
+        acquire_submit.commandBufferCount = 1;
+        acquire_submit.pCommandBuffers = &current.graphics_cmd;
+        if (vkQueueSubmit(graphics_queue, 1, &acquire_submit, current.fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload acquire command buffer");
+        }
+    }
+
+    current.ticket = next_ticket++;
+    last_submitted = current.ticket;
+    in_flight.push_back(std::move(current));
+    current = Batch{};
+    recording = false;
+
+    return last_submitted;
+}
+
+bool UploadManager::IsComplete(UploadTicket ticket) {
+    if (ticket <= last_completed) {
+        return true;
+    }
+    Collect();
+    return ticket <= last_completed;
+}
+
+void UploadManager::Wait(UploadTicket ticket) {
+    for (auto const &batch: in_flight) {
+        if (batch.ticket > ticket) {
+            break;
+        }
+        vkWaitForFences(context.device.device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+    }
+    Collect();
+}
+
+void UploadManager::WaitIdle() {
+    Wait(Flush());
+}
+
+void UploadManager::Collect() {
+    // batches are submitted in order, so they also retire in order
+    while (!in_flight.empty() && vkGetFenceStatus(context.device.device, in_flight.front().fence) == VK_SUCCESS) {
+        last_completed = in_flight.front().ticket;
+        releaseBatch(in_flight.front());
+        in_flight.pop_front();
+    }
+}
+
+void UploadManager::releaseBatch(Batch &batch) {
+    auto device = context.device.device;
+
+    vkFreeCommandBuffers(device, transfer_pool, 1, &batch.transfer_cmd);
+    if (batch.graphics_cmd != VK_NULL_HANDLE) {
+        vkFreeCommandBuffers(device, graphics_pool, 1, &batch.graphics_cmd);
+    }
+    vkDestroyFence(device, batch.fence, nullptr);
+    if (batch.semaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(device, batch.semaphore, nullptr);
+    }
+    for (auto const &staging: batch.staging) {
+        staging->Destroy();
+    }
+    batch.staging.clear();
+}
+
+void UploadManager::Destroy() {
+    WaitIdle();
+
+    vkDestroyCommandPool(context.device.device, transfer_pool, nullptr);
+    vkDestroyCommandPool(context.device.device, graphics_pool, nullptr);
+}
+
+} // end namespace lvk
@@ -0,0 +1,157 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_UPLOAD_MANAGER_H
+#define LYH_UPLOAD_MANAGER_H
+
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "allocator.h"
+#include "buffer.h"
+#include "vulkan_context.h"
+
+namespace lvk {
+
+using UploadTicket = uint64_t;
+
+// Batches buffer and image copies into one command buffer that is submitted once per frame.
+// When the device has a dedicated transfer queue the copies run there and ownership of the
+// destination resources is released to / acquired by the graphics queue family. Completion is
+// tracked with one fence per batch, staging memory is recycled by Collect().
+//
+// Not thread safe, enqueue and flush from the render thread.
+class UploadManager {
+public:
+    static constexpr VkDeviceSize STAGING_CHUNK_SIZE = 8 * 1024 * 1024;
+
+    explicit UploadManager(VulkanContext &context, Allocator &allocator);
+
+    UploadManager(const UploadManager &) = delete;
+
+    UploadManager &operator=(const UploadManager &) = delete;
+
+    // The source data is copied into staging memory immediately, `data` can be released on return.
+    // The copy is made visible to vertex input, vertex and fragment shaders, plus `consumer_stages`
+    // for buffers read elsewhere (e.g. by task and mesh shaders).
+    void EnqueueBufferCopy(const void *data, VkDeviceSize size, VkBuffer dst, VkDeviceSize dst_offset,
+                           VkPipelineStageFlags consumer_stages = 0);
+
+    // Same as above but copies from caller owned staging memory, which must stay alive until
+    // the ticket returned by GetRecordingTicket() completes.
+    void EnqueueBufferCopy(VkBuffer src, VkDeviceSize src_offset, VkDeviceSize size, VkBuffer dst,
+                           VkDeviceSize dst_offset, VkPipelineStageFlags consumer_stages = 0);
+
+    // Uploads mip 0 of a single layer colour image and leaves it in `final_layout` on the graphics queue.
+    void EnqueueImageCopy(const void *data, VkDeviceSize size, VkImage dst, VkExtent2D extent,
+                          VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Same as above but copies from caller owned staging memory, which must stay alive until
+    // the ticket returned by GetRecordingTicket() completes.
+    void EnqueueImageCopy(VkBuffer src, VkDeviceSize src_offset, VkImage dst, VkExtent2D extent,
+                          VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Uploads a prebuilt mip chain, level i is tightly packed at level_offsets[i] with extent max(1, extent >> i).
+    void EnqueueImageLevels(VkBuffer src, const std::vector<VkDeviceSize> &level_offsets, VkImage dst,
+                            VkExtent2D extent, VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Uploads mip 0 and fills the remaining `mip_levels` with linear blits on the graphics queue.
+    // The image needs TRANSFER_SRC usage and a format for which SupportsLinearBlit() is true.
+    void EnqueueImageCopyWithMips(VkBuffer src, VkDeviceSize src_offset, VkImage dst, VkExtent2D extent,
+                                  uint32_t mip_levels,
+                                  VkImageLayout final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Whether optimal tiling images of `format` can be downsampled with a linear vkCmdBlitImage.
+    [[nodiscard]] bool SupportsLinearBlit(VkFormat format) const;
+
+    // Submit everything enqueued since the last flush. Returns the ticket of the submitted batch,
+    // or of the last submitted batch when nothing was pending.
+    UploadTicket Flush();
+
+    [[nodiscard]] bool IsComplete(UploadTicket ticket);
+
+    void Wait(UploadTicket ticket);
+
+    void WaitIdle();
+
+    // Release command buffers, fences and staging memory of finished batches.
+    void Collect();
+
+    [[nodiscard]] bool UsesDedicatedTransferQueue() const { return transfer_family != graphics_family; }
+
+    [[nodiscard]] UploadTicket GetLastSubmitted() const { return last_submitted; }
+
+    // Ticket the batch currently being recorded will get from the next Flush().
+    [[nodiscard]] UploadTicket GetRecordingTicket() const { return next_ticket; }
+
+    void Destroy();
+
+private:
+    struct StagingRange {
+        VkBuffer buffer;
+        VkDeviceSize offset;
+    };
+
+    struct Batch {
+        UploadTicket ticket = 0;
+        VkCommandBuffer transfer_cmd = VK_NULL_HANDLE;
+        VkCommandBuffer graphics_cmd = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        std::vector<std::unique_ptr<Buffer>> staging;
+    };
+
+    struct MipBlit {
+        VkImage image;
+        VkExtent2D extent;
+        uint32_t mip_levels;
+        VkImageLayout final_layout;
+    };
+
+    StagingRange stage(const void *data, VkDeviceSize size);
+
+    // Transitions all `mip_levels` to TRANSFER_DST and copies the first `copy_levels` from `src`.
+    // Returns the barrier to be completed into the graphics queue handoff.
+    VkImageMemoryBarrier recordImageCopy(VkBuffer src, const VkDeviceSize *level_offsets, uint32_t copy_levels,
+                                         uint32_t mip_levels, VkImage dst, VkExtent2D extent);
+
+    void recordMipBlits(VkCommandBuffer cmd);
+
+    void beginBatch();
+
+    void recordOwnershipTransfers();
+
+    void releaseBatch(Batch &batch);
+
+    VulkanContext &context;
+    Allocator &allocator;
+
+    uint32_t graphics_family = 0;
+    uint32_t transfer_family = 0;
+    VkQueue graphics_queue = VK_NULL_HANDLE;
+    VkQueue transfer_queue = VK_NULL_HANDLE;
+    VkCommandPool graphics_pool = VK_NULL_HANDLE;
+    VkCommandPool transfer_pool = VK_NULL_HANDLE;
+
+    // batch being recorded
+    bool recording = false;
+    Batch current{};
+    VkDeviceSize staging_head = 0;
+    VkDeviceSize staging_capacity = 0;
+    std::vector<VkImageMemoryBarrier> image_handoffs;
+    std::vector<VkBufferMemoryBarrier> buffer_handoffs;
+    VkPipelineStageFlags handoff_stages = 0; // on top of CONSUMER_STAGES
+    std::vector<MipBlit> mip_blits;
+
+    std::deque<Batch> in_flight;
+    UploadTicket next_ticket = 1;
+    UploadTicket last_submitted = 0;
+    UploadTicket last_completed = 0;
+};
+
+} // end namespace lvk
+
+#endif //LYH_UPLOAD_MANAGER_H
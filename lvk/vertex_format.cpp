@@ -0,0 +1,289 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#include "vertex_format.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LVK_VERTEX_SSE2 1
+#include <emmintrin.h>
+// F16C comes with every AVX2 capable CPU, MSVC only signals the latter
+#if defined(__F16C__) || defined(__AVX2__)
+#define LVK_VERTEX_F16C 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace lvk {
+namespace {
+VkFormat packed_format(AttributePrecision precision, uint32_t components) {
+    switch (precision) {
+        case AttributePrecision::Float32:
+            return components == 2
+                       ? VK_FORMAT_R32G32_SFLOAT
+                       : components == 3
+                             ? VK_FORMAT_R32G32B32_SFLOAT
+                             : VK_FORMAT_R32G32B32A32_SFLOAT;
+        case AttributePrecision::Float16:
+            return components == 2 ? VK_FORMAT_R16G16_SFLOAT : VK_FORMAT_R16G16B16A16_SFLOAT;
+        case AttributePrecision::Unorm16:
+            return components == 2 ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R16G16B16A16_UNORM;
+        case AttributePrecision::Unorm8:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+    throw std::runtime_error("failed to pick vertex format, unknown precision!");
+}
+
+uint32_t component_size(AttributePrecision precision) {
+    switch (precision) {
+        case AttributePrecision::Float32: return 4;
+        case AttributePrecision::Float16:
+        case AttributePrecision::Unorm16: return 2;
+        case AttributePrecision::Unorm8: return 1;
+    }
+    return 4;
+}
+
+// round to nearest even, like F16C
+uint16_t to_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+    if (magnitude >= 0x7F800000) {
+        // inf stays inf, NaN stays quiet NaN
+        return static_cast<uint16_t>(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0));
+    }
+    if (magnitude >= 0x477FF000) {
+        // 65520 and up round past the largest half
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+    if (magnitude < 0x38800000) {
+        // subnormal half, or zero below 2^-25
+        if (magnitude < 0x33000000) {
+            return static_cast<uint16_t>(sign);
+        }
+        uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+        uint32_t shift = 126 - (magnitude >> 23);
+        uint32_t result = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (result & 1))) {
+            result++;
+        }
+        return static_cast<uint16_t>(sign | result);
+    }
+    uint32_t rebiased = magnitude - 0x38000000;
+    return static_cast<uint16_t>(sign | (rebiased + 0xFFF + ((rebiased >> 13) & 1)) >> 13);
+}
+
+// Reads one attribute of every vertex widened to four floats, missing components read as
+// (0, 0, 0, 1) the way vertex fetch fills them, and hands it to `store` with its packed slot.
+// Component counts are template arguments so the copies compile to plain moves.
+template<uint32_t SourceComponents, typename Store>
+void convert_attribute(const uint8_t *source, size_t source_stride, size_t count, uint8_t *out, size_t out_stride,
+                       Store store) {
+    for (size_t i = 0; i < count; i++) {
+        float value[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        memcpy(value, source + i * source_stride, SourceComponents * sizeof(float));
+        store(value, out + i * out_stride);
+    }
+}
+
+#if LVK_VERTEX_SSE2
+// from the scalars rather than a vector load, the copy that filled `value` would stall the load
+inline __m128 load_float4(const float *value) {
+    return _mm_setr_ps(value[0], value[1], value[2], value[3]);
+}
+#endif
+
+// `Simd` picks the SSE2 / F16C store where it is compiled in, the scalar one is the fallback.
+template<uint32_t Components, bool Simd>
+void store_float32(const float *value, uint8_t *out) {
+    memcpy(out, value, Components * sizeof(float));
+}
+
+template<uint32_t Components, bool Simd>
+void store_float16(const float *value, uint8_t *out) {
+#if LVK_VERTEX_F16C
+    if constexpr (Simd) {
+        __m128i half = _mm_cvtps_ph(load_float4(value), _MM_FROUND_TO_NEAREST_INT);
+        if constexpr (Components == 4) {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out), half);
+        } else {
+            int32_t bits = _mm_cvtsi128_si32(half);
+            memcpy(out, &bits, sizeof(bits));
+        }
+        return;
+    }
+#endif
+    uint16_t half[Components];
+    for (uint32_t c = 0; c < Components; c++) {
+        half[c] = to_half(value[c]);
+    }
+    memcpy(out, half, sizeof(half));
+}
+
+template<uint32_t Components, bool Simd>
+void store_unorm16(const float *value, uint8_t *out) {
+#if LVK_VERTEX_SSE2
+    if constexpr (Simd) {
+        __m128 clamped = _mm_min_ps(_mm_max_ps(load_float4(value), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        __m128i unorm = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(65535.0f)), _mm_set1_ps(0.5f)));
+        // SSE2 only packs signed, bias into int16 range and flip the sign bit back afterwards
+        __m128i biased = _mm_sub_epi32(unorm, _mm_set1_epi32(32768));
+        __m128i packed = _mm_xor_si128(_mm_packs_epi32(biased, biased), _mm_set1_epi16(static_cast<short>(0x8000)));
+        if constexpr (Components == 4) {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out), packed);
+        } else {
+            int32_t bits = _mm_cvtsi128_si32(packed);
+            memcpy(out, &bits, sizeof(bits));
+        }
+        return;
+    }
+#endif
+    uint16_t unorm[Components];
+    for (uint32_t c = 0; c < Components; c++) {
+        unorm[c] = static_cast<uint16_t>(std::clamp(value[c], 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+    memcpy(out, unorm, sizeof(unorm));
+}
+
+template<bool Simd>
+void store_unorm8(const float *value, uint8_t *out) {
+#if LVK_VERTEX_SSE2
+    if constexpr (Simd) {
+        __m128 clamped = _mm_min_ps(_mm_max_ps(load_float4(value), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        __m128i unorm = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(unorm, unorm), _mm_setzero_si128());
+        int32_t bits = _mm_cvtsi128_si32(packed);
+        memcpy(out, &bits, sizeof(bits));
+        return;
+    }
+#endif
+    for (uint32_t c = 0; c < 4; c++) {
+        out[c] = static_cast<uint8_t>(std::clamp(value[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+template<uint32_t SourceComponents, uint32_t Components, bool Simd>
+void pack_attribute(AttributePrecision precision, const uint8_t *source, size_t source_stride, size_t count,
+                    uint8_t *out, size_t out_stride) {
+    switch (precision) {
+        case AttributePrecision::Float32:
+            convert_attribute<SourceComponents>(source, source_stride, count, out, out_stride,
+                                                store_float32<Components, Simd>);
+            break;
+        case AttributePrecision::Float16:
+            convert_attribute<SourceComponents>(source, source_stride, count, out, out_stride,
+                                                store_float16<Components, Simd>);
+            break;
+        case AttributePrecision::Unorm16:
+            convert_attribute<SourceComponents>(source, source_stride, count, out, out_stride,
+                                                store_unorm16<Components, Simd>);
+            break;
+        case AttributePrecision::Unorm8:
+            convert_attribute<SourceComponents>(source, source_stride, count, out, out_stride, store_unorm8<Simd>);
+            break;
+    }
+}
+
+using PackFunction = void (*)(AttributePrecision, const uint8_t *, size_t, size_t, uint8_t *, size_t);
+
+// the (source, packed) component counts addAttribute() can produce
+template<bool Simd>
+PackFunction pack_function(uint32_t source_components, uint32_t components) {
+    if (source_components == 3) {
+        return components == 2 ? pack_attribute<3, 2, Simd>
+               : components == 3 ? pack_attribute<3, 3, Simd>
+               : pack_attribute<3, 4, Simd>;
+    }
+    return components == 2 ? pack_attribute<2, 2, Simd> : pack_attribute<2, 4, Simd>;
+}
+
+uint32_t position_components(const VertexFormat &format) {
+    // unorm would need a per object range to decode, the shaders have no slot for it
+    if (format.position == AttributePrecision::Unorm16 || format.position == AttributePrecision::Unorm8) {
+        throw std::runtime_error("failed to pack vertices, positions need a float precision!");
+    }
+    return format.position == AttributePrecision::Float32 ? 3 : 2;
+}
+} // namespace
+
+VertexPacker VertexPacker::ForVertex2(const VertexFormat &format) {
+    // format.uv does not apply
+    VertexPacker packer;
+    packer.addAttribute(Vertex2Layout::OFFSETS[0], 3, position_components(format), format.position);
+    packer.addAttribute(Vertex2Layout::OFFSETS[1], 3, 3, format.color);
+    return packer;
+}
+
+VertexPacker VertexPacker::ForVertex3(const VertexFormat &format) {
+    VertexPacker packer;
+    packer.addAttribute(Vertex3Layout::OFFSETS[0], 3, position_components(format), format.position);
+    packer.addAttribute(Vertex3Layout::OFFSETS[1], 3, 3, format.color);
+    packer.addAttribute(Vertex3Layout::OFFSETS[2], 2, 2, format.uv);
+    return packer;
+}
+
+std::vector<uint32_t> VertexPacker::GetOffsets() const {
+    std::vector<uint32_t> offsets;
+    offsets.reserve(attributes.size());
+    for (auto const &attribute: attributes) {
+        offsets.push_back(attribute.offset);
+    }
+    return offsets;
+}
+
+void VertexPacker::ApplyFormats(std::vector<VkVertexInputAttributeDescription> &descriptions) const {
+    if (descriptions.size() != attributes.size()) {
+        throw std::runtime_error("failed to apply vertex format, shader inputs do not match the vertex!");
+    }
+    for (size_t i = 0; i < attributes.size(); i++) {
+        descriptions[i].format = attributes[i].format;
+        descriptions[i].offset = attributes[i].offset;
+    }
+}
+
+void VertexPacker::Pack(const Vertex2 *vertices, size_t count, void *out, PackKernel kernel) const {
+    pack(reinterpret_cast<const uint8_t *>(vertices), sizeof(Vertex2), count, static_cast<uint8_t *>(out), kernel);
+}
+
+void VertexPacker::Pack(const Vertex3 *vertices, size_t count, void *out, PackKernel kernel) const {
+    pack(reinterpret_cast<const uint8_t *>(vertices), sizeof(Vertex3), count, static_cast<uint8_t *>(out), kernel);
+}
+
+void VertexPacker::addAttribute(uint32_t source_offset, uint32_t source_components, uint32_t components,
+                                AttributePrecision precision) {
+    if (precision == AttributePrecision::Unorm8) {
+        components = 4;
+    } else if (precision != AttributePrecision::Float32 && components == 3) {
+        // 3 component 16 bit formats are rarely supported for vertex input
+        components = 4;
+    }
+    auto format = packed_format(precision, components);
+    attributes.push_back({source_offset, source_components, components, precision, format, stride});
+    // every packed attribute is a multiple of 4 bytes, offsets stay 4 byte aligned
+    stride += components * component_size(precision);
+}
+
+void VertexPacker::pack(const uint8_t *source, size_t source_stride, size_t count, uint8_t *out,
+                        PackKernel kernel) const {
+    bool simd = kernel != PackKernel::kScalar;
+    // attribute by attribute over blocks that stay in cache, the source is read from memory once
+    for (size_t first = 0; first < count; first += BLOCK_VERTICES) {
+        size_t block = std::min(count - first, BLOCK_VERTICES);
+        for (auto const &attribute: attributes) {
+            auto pack_attribute = simd ? pack_function<true>(attribute.source_components, attribute.components)
+                                       : pack_function<false>(attribute.source_components, attribute.components);
+            pack_attribute(attribute.precision, source + first * source_stride + attribute.source_offset,
+                           source_stride, block, out + first * stride + attribute.offset, stride);
+        }
+    }
+}
+
+} // end namespace lvk
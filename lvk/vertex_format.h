@@ -0,0 +1,95 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_VERTEX_FORMAT_H
+#define LYH_VERTEX_FORMAT_H
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Vertex.h"
+
+namespace lvk {
+
+enum class AttributePrecision : uint8_t {
+    Float32,
+    Float16,
+    Unorm16, // clamped to [0, 1]
+    Unorm8, // clamped to [0, 1]
+};
+
+enum class PackKernel {
+    kAuto,   // best one compiled in
+    kScalar,
+    kSimd,   // SSE2 and F16C where compiled in, falls back to scalar elsewhere
+};
+
+// Precision each attribute of a Vertex2 / Vertex3 is uploaded with. Shaders keep declaring float
+// inputs, vertex fetch widens the packed formats, so one shader serves every VertexFormat.
+struct VertexFormat {
+    // Anything below Float32 keeps x and y only, the shaders see z = 0. Half floats hold integer
+    // pixel coordinates exactly up to 2048, in steps of 2 up to 4096.
+    AttributePrecision position = AttributePrecision::Float32;
+    AttributePrecision color = AttributePrecision::Float32;
+    AttributePrecision uv = AttributePrecision::Float32;
+
+    // half xy, RGBA8 color, unorm16 uv: 8 bytes per Vertex2 and 12 per Vertex3, instead of 24 and 32
+    static constexpr VertexFormat Compact() {
+        return {AttributePrecision::Float16, AttributePrecision::Unorm8, AttributePrecision::Unorm16};
+    }
+
+    [[nodiscard]] bool IsFull() const { return *this == VertexFormat{}; }
+
+    bool operator==(const VertexFormat &) const = default;
+};
+
+// Interleaved layout of one VertexFormat and the conversion of Vertex2 / Vertex3 arrays into it.
+// Attributes are converted one at a time over blocks of vertices, so the precision switch stays
+// out of the per-vertex loop and each vertex is one SIMD convert per attribute.
+class VertexPacker {
+public:
+    // Throws when an attribute cannot take the precision, e.g. unorm positions.
+    static VertexPacker ForVertex2(const VertexFormat &format);
+
+    static VertexPacker ForVertex3(const VertexFormat &format);
+
+    [[nodiscard]] uint32_t GetStride() const { return stride; }
+
+    // packed offset of each attribute in location order
+    [[nodiscard]] std::vector<uint32_t> GetOffsets() const;
+
+    // Replaces the reflected formats of `attributes`, one per attribute in location order, with the packed ones.
+    void ApplyFormats(std::vector<VkVertexInputAttributeDescription> &attributes) const;
+
+    // `out` takes count * GetStride() bytes.
+    void Pack(const Vertex2 *vertices, size_t count, void *out, PackKernel kernel = PackKernel::kAuto) const;
+
+    void Pack(const Vertex3 *vertices, size_t count, void *out, PackKernel kernel = PackKernel::kAuto) const;
+
+private:
+    static constexpr size_t BLOCK_VERTICES = 256;
+
+    struct Attribute {
+        uint32_t source_offset;
+        uint32_t source_components;
+        uint32_t components; // packed, 3 component 8/16 bit formats are padded to 4
+        AttributePrecision precision;
+        VkFormat format;
+        uint32_t offset;
+    };
+
+    void addAttribute(uint32_t source_offset, uint32_t source_components, uint32_t components,
+                      AttributePrecision precision);
+
+    void pack(const uint8_t *source, size_t source_stride, size_t count, uint8_t *out, PackKernel kernel) const;
+
+    std::vector<Attribute> attributes;
+    uint32_t stride = 0;
+};
+
+} // end namespace lvk
+
+#endif //LYH_VERTEX_FORMAT_H
@@ -0,0 +1,130 @@
+//
+// Created by admin on 2026/10/17.
+//
+
+#ifndef LYH_VERTEX_LAYOUT_H
+#define LYH_VERTEX_LAYOUT_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace lvk {
+
+struct VertexFormatInfo {
+    uint32_t size; // bytes, 0 for formats the layout does not know
+    bool float32; // read from float members
+};
+
+constexpr VertexFormatInfo GetVertexFormatInfo(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R32_SFLOAT: return {4, true};
+        case VK_FORMAT_R32G32_SFLOAT: return {8, true};
+        case VK_FORMAT_R32G32B32_SFLOAT: return {12, true};
+        case VK_FORMAT_R32G32B32A32_SFLOAT: return {16, true};
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SNORM:
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32: return {4, false};
+        case VK_FORMAT_R32G32_UINT:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SNORM: return {8, false};
+        default: return {0, false};
+    }
+}
+
+// One attribute of a VertexLayout. Use LVK_VERTEX_ATTRIBUTE, which takes the offset from the
+// same member the pointer names.
+template<auto Member, uint32_t Offset, VkFormat Format>
+struct VertexAttribute;
+
+template<typename Vertex, typename T, T Vertex::*Member, uint32_t Offset, VkFormat Format>
+struct VertexAttribute<Member, Offset, Format> {
+    using VertexType = Vertex;
+    using MemberType = T;
+    static constexpr uint32_t OFFSET = Offset;
+    static constexpr VkFormat FORMAT = Format;
+
+    static constexpr VertexFormatInfo INFO = GetVertexFormatInfo(Format);
+    static_assert(INFO.size != 0, "vertex format is not supported by VertexLayout");
+    static_assert(INFO.size == sizeof(T), "vertex format size does not match the member");
+
+    // glm vectors, arrays and scalars all reduce to their component type
+    template<typename U>
+    static constexpr auto component() {
+        if constexpr (std::is_array_v<U>) {
+            return std::remove_all_extents_t<U>{};
+        } else if constexpr (std::is_arithmetic_v<U>) {
+            return U{};
+        } else {
+            return typename U::value_type{};
+        }
+    }
+
+    static_assert(INFO.float32 == std::is_same_v<decltype(component<T>()), float>,
+                  "32 bit float formats need float members, packed formats need integer members");
+};
+
+#define LVK_VERTEX_ATTRIBUTE(Type, member, format) \
+    ::lvk::VertexAttribute<&Type::member, static_cast<uint32_t>(offsetof(Type, member)), format>
+
+// Vertex input of one interleaved vertex struct, computed at compile time from its attribute list.
+// Locations follow the list order. Nothing is allocated and the tables cannot drift from the
+// struct: a member changing type or size fails the static_asserts.
+//
+//   using Vertex2Layout = VertexLayout<LVK_VERTEX_ATTRIBUTE(Vertex2, pos, VK_FORMAT_R32G32B32_SFLOAT), ...>;
+template<typename First, typename... Rest>
+struct VertexLayout {
+    using VertexType = typename First::VertexType;
+    static_assert((std::is_same_v<VertexType, typename Rest::VertexType> && ...),
+                  "vertex attributes belong to different structs");
+
+    static constexpr uint32_t ATTRIBUTE_COUNT = 1 + sizeof...(Rest);
+    static constexpr uint32_t STRIDE = sizeof(VertexType);
+    static constexpr std::array<uint32_t, ATTRIBUTE_COUNT> OFFSETS{First::OFFSET, Rest::OFFSET...};
+    static constexpr std::array<VkFormat, ATTRIBUTE_COUNT> FORMATS{First::FORMAT, Rest::FORMAT...};
+
+    // FNV-1a over stride, offsets and formats: equal layouts hash equal in every build, so it
+    // can stand in for the attribute tables in pipeline keys.
+    static constexpr uint64_t HASH = [] {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](uint32_t value) {
+            for (uint32_t byte = 0; byte < 4; byte++) {
+                hash ^= (value >> (byte * 8)) & 0xFF;
+                hash *= 1099511628211ull;
+            }
+        };
+        mix(STRIDE);
+        for (uint32_t i = 0; i < ATTRIBUTE_COUNT; i++) {
+            mix(OFFSETS[i]);
+            mix(static_cast<uint32_t>(FORMATS[i]));
+        }
+        return hash;
+    }();
+
+    static constexpr VkVertexInputBindingDescription Binding(
+        uint32_t binding = 0, VkVertexInputRate input_rate = VK_VERTEX_INPUT_RATE_VERTEX) {
+        return {binding, STRIDE, input_rate};
+    }
+
+    static constexpr std::array<VkVertexInputAttributeDescription, ATTRIBUTE_COUNT> Attributes(
+        uint32_t binding = 0, uint32_t first_location = 0) {
+        std::array<VkVertexInputAttributeDescription, ATTRIBUTE_COUNT> attributes{};
+        for (uint32_t i = 0; i < ATTRIBUTE_COUNT; i++) {
+            attributes[i] = {first_location + i, binding, FORMATS[i], OFFSETS[i]};
+        }
+        return attributes;
+    }
+};
+
+} // end namespace lvk
+
+#endif //LYH_VERTEX_LAYOUT_H
@@ -12,6 +12,7 @@ VulkanContext::VulkanContext(GLFWwindow *window, Instance instance, VkSurfaceKHR
     : instance(instance), surface(surface), device(std::move(device)), window(window) {
     CreateSwapchain();
     createDefaultRenderPass();
+    pipeline_cache = std::make_unique<PipelineCache>(this->device, PIPELINE_CACHE_FILE);
 }
 
 void VulkanContext::CreateSwapchain() {
@@ -75,6 +76,10 @@ VkRenderPass VulkanContext::GetDefaultRenderPass() const {
 }
 
 void VulkanContext::Cleanup() {
+    pipeline_cache->PrintStats();
+    pipeline_cache->Save();
+    pipeline_cache->Destroy();
+
     vkDestroyRenderPass(device.device, render_pass, nullptr);
 
     destroy_swapchain(swapchain);
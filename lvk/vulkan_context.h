@@ -11,9 +11,14 @@
 #include "instance.h"
 #include "device.h"
 #include "swapchain.h"
+#include "pipeline_cache.h"
+
+#include <memory>
 
 namespace lvk {
 struct VulkanContext {
+    static constexpr const char *PIPELINE_CACHE_FILE = "pipeline_cache.bin";
+
     explicit VulkanContext(GLFWwindow *window, Instance instance, VkSurfaceKHR surface, Device device);
     void CreateSwapchain();
     [[nodiscard]] VkRenderPass GetDefaultRenderPass() const;
@@ -23,6 +28,8 @@ struct VulkanContext {
     Device device;
     Swapchain swapchain;
     VkRenderPass render_pass;
+    // loaded from PIPELINE_CACHE_FILE on startup and written back in Cleanup()
+    std::unique_ptr<PipelineCache> pipeline_cache;
 
     GLFWwindow *window;
 
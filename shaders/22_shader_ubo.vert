@@ -4,12 +4,17 @@ layout(binding = 0) uniform UniformBufferObject {
     mat4 mvp;
 } ubo;
 
+// world matrices by transform id, the draw's firstInstance is the object's id
+layout(binding = 2) readonly buffer Transforms {
+    mat4 transforms[];
+};
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 fragColor;
 
 void main() {
-    gl_Position = ubo.mvp * vec4(inPosition, 1.0);
+    gl_Position = ubo.mvp * transforms[gl_InstanceIndex] * vec4(inPosition, 1.0);
     fragColor = inColor;
 }
@@ -4,6 +4,11 @@ layout(binding = 0) uniform UniformBufferObject {
     mat4 mvp;
 } ubo;
 
+// world matrices by transform id, the draw's firstInstance is the object's id
+layout(binding = 2) readonly buffer Transforms {
+    mat4 transforms[];
+};
+
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
@@ -12,7 +17,7 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = ubo.mvp * vec4(inPosition, 0.0, 1.0);
+    gl_Position = ubo.mvp * transforms[gl_InstanceIndex] * vec4(inPosition, 0.0, 1.0);
     fragColor = inColor;
     fragTexCoord = inTexCoord;
 }
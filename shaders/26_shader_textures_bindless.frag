@@ -0,0 +1,19 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// every texture registered with the BindlessTextureHeap, bound once for all draws
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(push_constant) uniform DrawData {
+    uint texture_index;
+} draw;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // the index is the same for the whole draw, no nonuniformEXT needed
+    outColor = texture(textures[draw.texture_index], fragTexCoord);
+}
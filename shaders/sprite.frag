@@ -0,0 +1,21 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// the BindlessTextureHeap
+layout(set = 0, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) in vec4 fragColor;
+layout(location = 2) flat in uint fragTexture;
+
+layout(location = 0) out vec4 outColor;
+
+const uint NO_TEXTURE = 0xFFFFFFFFu;
+
+void main() {
+    outColor = fragColor;
+    if (fragTexture != NO_TEXTURE) {
+        // sprites of one draw may use different textures
+        outColor *= texture(textures[nonuniformEXT(fragTexture)], fragTexCoord);
+    }
+}
@@ -0,0 +1,31 @@
+#version 450
+
+layout(push_constant) uniform SpriteData {
+    mat4 mvp;
+} sprite;
+
+// one SpriteInstance per quad
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inSize;
+layout(location = 2) in vec4 inUvRect;
+layout(location = 3) in vec4 inColor;
+layout(location = 4) in uint inTexture;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) flat out uint fragTexture;
+
+// the shared unit quad, two triangles
+const vec2 CORNERS[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+    vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
+
+void main() {
+    vec2 corner = CORNERS[gl_VertexIndex];
+    gl_Position = sprite.mvp * vec4(inPosition + corner * inSize, 0.0, 1.0);
+    // the projection has y up, so the bottom edge samples v1
+    fragTexCoord = vec2(mix(inUvRect.x, inUvRect.z, corner.x), mix(inUvRect.w, inUvRect.y, corner.y));
+    fragColor = inColor;
+    fragTexture = inTexture;
+}
@@ -1,8 +1,9 @@
 
 #include "HelloTriangle.h"
 
-#define STB_IMAGE_IMPLEMENTATION
+// the stb_image implementation comes with lvk
 #include "stb_image.h"
+#include "shader_compiler.h"
 
 #include <algorithm>
 #include <filesystem>
@@ -553,8 +554,9 @@ void HelloTriangle::createImageViews() {
 }
 
 void HelloTriangle::createGraphicsPipeline() {
-    auto vertShaderCode = ReadFile("shaders/vert.spv");
-    auto fragShaderCode = ReadFile("shaders/frag.spv");
+    lvk::ShaderCompiler shaderCompiler;
+    auto vertShaderCode = shaderCompiler.Compile("../shaders/shader.vert");
+    auto fragShaderCode = shaderCompiler.Compile("../shaders/shader.frag");
 
     auto vertShaderModule = CreateShaderModule(device_, vertShaderCode);
     auto fragShaderModule = CreateShaderModule(device_, fragShaderCode);
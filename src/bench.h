@@ -0,0 +1,46 @@
+//
+// Created by admin on 2026/10/18.
+//
+
+#ifndef LYH_BENCH_H
+#define LYH_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+// Timing helpers for the *_bench executables.
+inline double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Fastest of `runs` calls of `body`, after one untimed warm up call.
+template<typename F>
+double best_of_ms(uint32_t runs, F &&body) {
+    body();
+    double best = std::numeric_limits<double>::max();
+    for (uint32_t i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        best = std::min(best, elapsed_ms(start));
+    }
+    return best;
+}
+
+// Deterministic input data, the same on every run and platform.
+struct BenchRandom {
+    uint32_t state = 0x12345678u;
+
+    uint32_t Next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // [0, 1)
+    float NextFloat() { return static_cast<float>(Next() >> 8) / static_cast<float>(1u << 24); }
+};
+
+#endif //LYH_BENCH_H
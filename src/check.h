@@ -0,0 +1,36 @@
+//
+// Created by admin on 2026/10/18.
+//
+
+#ifndef LYH_CHECK_H
+#define LYH_CHECK_H
+
+#include <cstdlib>
+#include <iostream>
+
+// Minimal checks for the test executables: failures are reported with their location and counted,
+// the test returns CheckResult() from main so ctest sees them. Unlike assert they stay in release
+// builds.
+inline int &check_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define LVK_CHECK(expr)                                                                        \
+    do {                                                                                       \
+        if (!(expr)) {                                                                         \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #expr << std::endl; \
+            check_failures()++;                                                                \
+        }                                                                                      \
+    } while (false)
+
+inline int CheckResult(const char *name) {
+    if (check_failures() == 0) {
+        std::cout << "[" << name << "] passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    std::cout << "[" << name << "] " << check_failures() << " checks failed" << std::endl;
+    return EXIT_FAILURE;
+}
+
+#endif //LYH_CHECK_H
@@ -17,16 +17,24 @@
 #include <glm/ext/matrix_transform.hpp>
 
 #include "draw_model.h"
+#include "meshlet_renderer.h"
+#include "render_graph.h"
+#include "sprite_batch.h"
 
 
 struct Init {
     GLFWwindow *window;
     std::unique_ptr<lvk::VulkanContext> context{};
     lvk::GlobalUbo ubo{};
+    lvk::Rect view{};
     bool is_resizing = false;
     bool framebufferResized = false;
     std::unique_ptr<lvk::DrawModel> model;
+    std::unique_ptr<lvk::SpriteBatch> sprites;
     std::unique_ptr<lvk::RenderContext> render;
+    std::unique_ptr<lvk::RenderGraph> graph;
+    lvk::RenderGraph::Resource backbuffer = lvk::RenderGraph::NO_RESOURCE;
+    uint32_t graph_version = UINT32_MAX;
 
     void UploadUbo(int width, int height) {
         auto view = glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
@@ -36,29 +44,61 @@ struct Init {
 
         auto model = glm::mat4(1.0f);
         ubo.mvp = projection * view * model;
+        // what the orthographic projection above shows of the z = 0 plane
+        this->view = {{0.0f, 0.0f}, {static_cast<float>(width), static_cast<float>(height)}};
     }
     void ReSize(uint32_t width, uint32_t height) {
         render->ReSize(width, height);
         Render();
     }
 
+    // the swapchain image is the only import, rebuilt when the swapchain is
+    void BuildGraph() {
+        graph->Reset();
+        backbuffer = graph->ImportImage("backbuffer", {render->GetExtent(), context->swapchain.image_format},
+                                        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        graph->AddPass("scene", [this](const lvk::RenderPassContext &) {
+            model->UpdateUniform(ubo);
+            model->SetViewRect(view);
+            model->Draw();
+            DrawSprites();
+        }).Color(backbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, {{0.0f, 0.0f, 0.0f, 1.0f}});
+        graph->Compile();
+        graph_version = render->GetSwapchainVersion();
+    }
+
     void Render() {
-        render->RenderBegin();
+        if (render->RenderBegin() != 0) {
+            return;
+        }
 
-        render->RenderPassBegin();
-        // create_command_buffers_v2(render);
-        // create_command_buffers_v3(render, render.image_index);
-        model->UpdateUniform(ubo);
-        model->Draw();
-        // model2.draw(render);
+        if (graph_version != render->GetSwapchainVersion()) {
+            BuildGraph();
+        }
+        graph->SetImage(backbuffer, render->GetCurrentImage(), render->GetCurrentImageView());
+        graph->Execute(render->GetCurrentCommandBuffer());
 
-        render->RenderPassEnd();
         render->RenderEnd();
         render->SetDebug(false);
     }
 
+    // dashboard style bars, all in a single draw
+    void DrawSprites() const {
+        sprites->Begin();
+        for (int i = 0; i < 32; i++) {
+            lvk::Sprite bar{};
+            bar.pos = {100.0f + static_cast<float>(i) * 18.0f, 520.0f};
+            bar.size = {14.0f, 10.0f + static_cast<float>(i % 8) * 6.0f};
+            bar.color = {static_cast<float>(i) / 31.0f, 0.6f, 1.0f - static_cast<float>(i) / 31.0f, 1.0f};
+            sprites->Add(bar);
+        }
+        sprites->End(render->GetCurrentCommandBuffer(), ubo.mvp);
+    }
+
     void Cleanup() const {
+        graph->Destroy();
         model->Destroy();
+        sprites->Destroy();
         render->Cleanup();
         context->Cleanup();
         glfwDestroyWindow(window);
@@ -100,9 +140,20 @@ int device_initialization(Init &init) {
     }
 
     lvk::PhysicalDeviceSelector phys_device_selector(instance);
+    // textures are sampled through a single bindless descriptor array
+    lvk::BindlessTextureHeap::RequireFeatures(phys_device_selector);
 
     auto physical_device = phys_device_selector.SetSurface(surface).Select();
 
+    // textures cooked with texture_cook --bc1
+    VkPhysicalDeviceFeatures optional_features{};
+    optional_features.textureCompressionBC = VK_TRUE;
+    physical_device.EnableFeaturesIfPresent(optional_features);
+    // lets the pipeline cache tell hits from misses
+    physical_device.EnableExtensionIfPresent(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    // MeshletRenderer is usable when this succeeds, see MeshletRenderer::IsSupported()
+    lvk::MeshletRenderer::EnableFeaturesIfPresent(physical_device);
+
 
     lvk::DeviceBuilder device_builder{physical_device};
 
@@ -115,6 +166,8 @@ int device_initialization(Init &init) {
     //
     init.render = std::make_unique<lvk::RenderContext>(*init.context);
     init.model = std::make_unique<lvk::DrawModel>(*init.render);
+    init.sprites = std::make_unique<lvk::SpriteBatch>(*init.render);
+    init.graph = std::make_unique<lvk::RenderGraph>(*init.render);
     init.model->DrawRectangle({100.0f, 100.0f}, {100.0f, 100.0f}, {1.0f, 1.0f, 0.0f});
     init.model->DrawRectangle({250.0f, 100.0f}, {100.0f, 100.0f}, {0.0f, 1.0f, 1.0f});
     init.model->DrawRectangle({400.0f, 100.0f}, {100.0f, 100.0f}, {1.0f, 0.0f, 0.0f});
@@ -126,7 +179,7 @@ int device_initialization(Init &init) {
     init.model->DrawRectangleUv({250.0f, 250.0f}, {100.0f, 100.0f}, {0.0f, 1.0f, 1.0f});
     init.model->DrawRectangleUv({400.0f, 250.0f}, {100.0f, 100.0f}, {0.0f, 1.0f, 1.0f});
     // image 2
-    init.model->AddDrawTextureObject("../textures/vulkan.png");
+    init.model->AddDrawTextureObject("../textures/vulkan.png", lvk::VertexFormat::Compact());
     init.model->DrawRectangleUv({100.0f, 400.0f}, {100.0f, 100.0f}, {0.0f, 1.0f, 1.0f});
     init.model->DrawRectangleUv({250.0f, 400.0f}, {100.0f, 100.0f}, {0.0f, 1.0f, 1.0f});
     init.model->DrawRectangleUv({400.0f, 400.0f}, {100.0f, 100.0f}, {0.0f, 1.0f, 1.0f});
@@ -0,0 +1,313 @@
+//
+// Created by admin on 2026/10/17.
+//
+// Offline mesh cooker: parses OBJ / glTF once, welds duplicate vertices, reorders triangles for the
+// post-transform cache and for overdraw, reorders vertices for fetch and quantizes the attributes,
+// then writes a container the MeshLoader maps and copies into staging memory as it is.
+//
+//   mesh_cook [--half-positions] [--no-overdraw] [--bench] <mesh or directory> [output file or directory]
+//
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mesh_container.h"
+#include "mesh_loader.h"
+#include "mesh_optimizer.h"
+#include "thread_pool.h"
+#include "vertex_format.h"
+
+namespace fs = std::filesystem;
+
+struct CookOptions {
+    // only for flat meshes, half positions drop z
+    bool half_positions = false;
+    bool overdraw = true;
+    bool bench = false;
+};
+
+struct MeshReport {
+    lvk::VertexCacheStats cache;
+    lvk::OverdrawStats overdraw;
+    uint32_t vertex_stride;
+    size_t vertex_count;
+};
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static MeshReport analyze(const lvk::MeshGeometry &geometry, uint32_t vertex_stride) {
+    auto const &indices = geometry.indices;
+    return {
+        lvk::AnalyzeVertexCache(indices.data(), indices.size(), geometry.vertices.size()),
+        lvk::AnalyzeOverdraw(indices.data(), indices.size(), &geometry.vertices[0].pos.x,
+                             geometry.vertices.size(), sizeof(lvk::Vertex3)),
+        vertex_stride,
+        geometry.vertices.size(),
+    };
+}
+
+// Merges bit identical vertices. OBJ corners are already welded by the parser, glTF primitives
+// often duplicate vertices along seams they don't need.
+static void weld_vertices(lvk::MeshGeometry &geometry) {
+    auto &vertices = geometry.vertices;
+    size_t capacity = 1;
+    while (capacity < vertices.size() * 2) {
+        capacity *= 2;
+    }
+    constexpr uint32_t empty = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> table(capacity, empty);
+    std::vector<uint32_t> remap(vertices.size());
+
+    auto hash = [](const lvk::Vertex3 &vertex) {
+        uint32_t words[sizeof(lvk::Vertex3) / 4];
+        memcpy(words, &vertex, sizeof(words));
+        uint32_t h = 2166136261u;
+        for (auto word: words) {
+            h = (h ^ word) * 16777619u;
+        }
+        return h;
+    };
+
+    size_t count = 0;
+    for (size_t i = 0; i < vertices.size(); i++) {
+        size_t slot = hash(vertices[i]) & (capacity - 1);
+        while (table[slot] != empty && memcmp(&vertices[table[slot]], &vertices[i], sizeof(lvk::Vertex3)) != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] == empty) {
+            // kept vertices move down in place, the slot refers to the new position
+            table[slot] = static_cast<uint32_t>(count);
+            vertices[count] = vertices[i];
+            count++;
+        }
+        remap[i] = table[slot];
+    }
+
+    for (auto &index: geometry.indices) {
+        index = remap[index];
+    }
+    vertices.erase(vertices.begin() + static_cast<ptrdiff_t>(count), vertices.end());
+}
+
+// Full precision positions unless asked otherwise, RGBA8 colors, and unorm16 uvs when they stay
+// in [0, 1] (clamped otherwise), half floats for tiling uvs.
+static lvk::VertexFormat select_format(const std::vector<lvk::Vertex3> &vertices, const CookOptions &options) {
+    bool flat = true;
+    bool uv_unit = true;
+    for (auto const &vertex: vertices) {
+        flat = flat && vertex.pos.z == 0.0f;
+        uv_unit = uv_unit && vertex.uv.x >= 0.0f && vertex.uv.x <= 1.0f && vertex.uv.y >= 0.0f && vertex.uv.y <= 1.0f;
+    }
+    if (options.half_positions && !flat) {
+        throw std::runtime_error("failed to cook mesh, half positions drop z and the mesh is not flat!");
+    }
+
+    lvk::VertexFormat format{};
+    format.position = options.half_positions ? lvk::AttributePrecision::Float16 : lvk::AttributePrecision::Float32;
+    format.color = lvk::AttributePrecision::Unorm8;
+    format.uv = uv_unit ? lvk::AttributePrecision::Unorm16 : lvk::AttributePrecision::Float16;
+    return format;
+}
+
+static void write_container(const fs::path &output, const lvk::MeshGeometry &geometry,
+                            const lvk::VertexFormat &format) {
+    auto align = [](uint64_t value) {
+        return (value + lvk::MESH_CONTAINER_ALIGNMENT - 1) & ~(lvk::MESH_CONTAINER_ALIGNMENT - 1);
+    };
+    auto const &vertices = geometry.vertices;
+    auto const &indices = geometry.indices;
+
+    auto packer = lvk::VertexPacker::ForVertex3(format);
+    std::vector<uint8_t> vertex_data(static_cast<size_t>(packer.GetStride()) * vertices.size());
+    packer.Pack(vertices.data(), vertices.size(), vertex_data.data());
+
+    VkIndexType index_type = lvk::SelectIndexType(vertices.size());
+    std::vector<uint16_t> narrow;
+    const void *index_data = indices.data();
+    size_t index_size = indices.size() * sizeof(uint32_t);
+    if (index_type == VK_INDEX_TYPE_UINT16) {
+        narrow.assign(indices.begin(), indices.end());
+        index_data = narrow.data();
+        index_size = narrow.size() * sizeof(uint16_t);
+    }
+
+    lvk::MeshContainerHeader header{};
+    header.magic = lvk::MESH_CONTAINER_MAGIC;
+    header.version = lvk::MESH_CONTAINER_VERSION;
+    header.vertex_count = static_cast<uint32_t>(vertices.size());
+    header.index_count = static_cast<uint32_t>(indices.size());
+    header.vertex_stride = packer.GetStride();
+    header.index_type = static_cast<uint32_t>(index_type);
+    header.position_precision = static_cast<uint8_t>(format.position);
+    header.color_precision = static_cast<uint8_t>(format.color);
+    header.uv_precision = static_cast<uint8_t>(format.uv);
+    for (int axis = 0; axis < 3; axis++) {
+        header.bounds_min[axis] = std::numeric_limits<float>::max();
+        header.bounds_max[axis] = std::numeric_limits<float>::lowest();
+    }
+    for (auto const &vertex: vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            header.bounds_min[axis] = std::min(header.bounds_min[axis], vertex.pos[axis]);
+            header.bounds_max[axis] = std::max(header.bounds_max[axis], vertex.pos[axis]);
+        }
+    }
+    header.vertex_offset = align(sizeof(header));
+    header.index_offset = align(header.vertex_offset + vertex_data.size());
+    header.data_size = header.index_offset + index_size - header.vertex_offset;
+
+    // write next to the target and rename, a running app never maps a half written file
+    fs::path temp = output;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("failed to open " + temp.string());
+        }
+        const char zeros[lvk::MESH_CONTAINER_ALIGNMENT] = {};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(zeros, static_cast<std::streamsize>(header.vertex_offset - sizeof(header)));
+        file.write(reinterpret_cast<const char *>(vertex_data.data()),
+                   static_cast<std::streamsize>(vertex_data.size()));
+        file.write(zeros, static_cast<std::streamsize>(header.index_offset - header.vertex_offset -
+                                                        vertex_data.size()));
+        file.write(static_cast<const char *>(index_data), static_cast<std::streamsize>(index_size));
+        if (!file) {
+            throw std::runtime_error("failed to write " + temp.string());
+        }
+    }
+    fs::rename(temp, output);
+}
+
+// What the MeshLoader does per file for the source mesh and for the cooked one, minus the GPU side.
+static void bench(const fs::path &input, const fs::path &output, lvk::ThreadPool &pool) {
+    constexpr int runs = 5;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        auto geometry = lvk::ParseMeshFile(input.string(), pool);
+        lvk::OptimizeVertexCache(geometry.indices.data(), geometry.indices.data(), geometry.indices.size(),
+                                 geometry.vertices.size());
+        lvk::OptimizeVertexFetch(geometry.vertices, geometry.indices);
+    }
+    double parse_ms = elapsed_ms(start) / runs;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        lvk::MappedFile mapped(output.string());
+        auto header = lvk::ParseMeshContainer(mapped.GetData(), mapped.GetSize());
+        std::vector<uint8_t> staging(header->data_size);
+        memcpy(staging.data(), mapped.GetData() + header->vertex_offset, staging.size());
+    }
+    double mapped_ms = elapsed_ms(start) / runs;
+
+    std::cout << "  load: parse " << parse_ms << " ms, cooked " << mapped_ms << " ms\n";
+}
+
+static void print_report(const char *label, const MeshReport &report) {
+    std::cout << "  " << label << ": " << report.vertex_count << " vertices, ACMR " << report.cache.acmr
+            << ", ATVR " << report.cache.atvr << ", overdraw " << report.overdraw.overdraw << ", "
+            << report.vertex_stride << " bytes per vertex\n";
+}
+
+static void cook(const fs::path &input, const fs::path &output, const CookOptions &options, lvk::ThreadPool &pool) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto geometry = lvk::ParseMeshFile(input.string(), pool);
+    if (geometry.vertices.empty() || geometry.indices.empty() || geometry.indices.size() % 3 != 0) {
+        throw std::runtime_error("failed to cook mesh, no triangle list: " + input.string());
+    }
+    auto before = analyze(geometry, sizeof(lvk::Vertex3));
+
+    weld_vertices(geometry);
+    auto &indices = geometry.indices;
+    lvk::OptimizeVertexCache(indices.data(), indices.data(), indices.size(), geometry.vertices.size());
+    if (options.overdraw) {
+        std::vector<uint32_t> reordered(indices.size());
+        lvk::OptimizeOverdraw(reordered.data(), indices.data(), indices.size(), &geometry.vertices[0].pos.x,
+                              geometry.vertices.size(), sizeof(lvk::Vertex3));
+        indices.swap(reordered);
+    }
+    lvk::OptimizeVertexFetch(geometry.vertices, indices);
+
+    auto format = select_format(geometry.vertices, options);
+    auto after = analyze(geometry, lvk::VertexPacker::ForVertex3(format).GetStride());
+    write_container(output, geometry, format);
+
+    std::cout << input.string() << " -> " << output.string() << ": " << indices.size() / 3 << " triangles, "
+            << fs::file_size(output) << " bytes, " << elapsed_ms(start) << " ms\n";
+    print_report("before", before);
+    print_report("after ", after);
+
+    if (options.bench) {
+        bench(input, output, pool);
+    }
+}
+
+static bool is_mesh(const fs::path &path) {
+    auto extension = path.extension().string();
+    for (auto &c: extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == ".obj" || extension == ".gltf" || extension == ".glb";
+}
+
+int main(int argc, char **argv) {
+    CookOptions options{};
+    std::vector<fs::path> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--half-positions") {
+            options.half_positions = true;
+        } else if (arg == "--no-overdraw") {
+            options.overdraw = false;
+        } else if (arg == "--bench") {
+            options.bench = true;
+        } else {
+            paths.emplace_back(arg);
+        }
+    }
+
+    if (paths.empty() || paths.size() > 2) {
+        std::cerr << "usage: mesh_cook [--half-positions] [--no-overdraw] [--bench] <mesh or directory> "
+                "[output file or directory]\n";
+        return EXIT_FAILURE;
+    }
+
+    try {
+        lvk::ThreadPool pool;
+
+        if (fs::is_directory(paths[0])) {
+            fs::path output_dir = paths.size() > 1 ? paths[1] : paths[0];
+            fs::create_directories(output_dir);
+            for (auto const &entry: fs::directory_iterator(paths[0])) {
+                if (entry.is_regular_file() && is_mesh(entry.path())) {
+                    auto output = output_dir / entry.path().filename();
+                    output.replace_extension(lvk::MESH_CONTAINER_EXTENSION);
+                    cook(entry.path(), output, options, pool);
+                }
+            }
+        } else {
+            fs::path output = paths.size() > 1 ? paths[1] : paths[0];
+            if (paths.size() == 1) {
+                output.replace_extension(lvk::MESH_CONTAINER_EXTENSION);
+            }
+            cook(paths[0], output, options, pool);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+//
+// Created by admin on 2026/10/18.
+//
+// Generates a large grid mesh as .obj, as .gltf with an external .bin and as .glb, then reports
+// ParseMeshFile() throughput in MB/s, OBJ with one worker and with the whole pool. "parse" is the
+// file size over the time spent in the parsers summed over all chunks, "end to end" over the wall
+// time of the call including the merge and weld.
+//
+//   mesh_loader_bench [grid size, default 1024] [directory for the files, default the temp directory]
+//
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "mesh_loader.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+static constexpr uint32_t RUNS = 3;
+
+struct Grid {
+    std::vector<float> positions; // xyz
+    std::vector<float> uvs; // uv
+    std::vector<uint32_t> indices;
+};
+
+static Grid make_grid(uint32_t size) {
+    Grid grid;
+    BenchRandom random;
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            float u = static_cast<float>(x) / static_cast<float>(size);
+            float v = static_cast<float>(y) / static_cast<float>(size);
+            // some height noise so the numbers have a full set of digits
+            grid.positions.insert(grid.positions.end(), {u * 100.0f, random.NextFloat(), v * 100.0f});
+            grid.uvs.insert(grid.uvs.end(), {u, v});
+        }
+    }
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t a = y * (size + 1) + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + size + 1;
+            uint32_t d = c + 1;
+            grid.indices.insert(grid.indices.end(), {a, c, b, b, c, d});
+        }
+    }
+    return grid;
+}
+
+static void write_obj(const fs::path &path, const Grid &grid) {
+    std::ofstream out(path, std::ios::binary);
+    out << std::fixed << std::setprecision(6);
+    for (size_t i = 0; i < grid.positions.size(); i += 3) {
+        out << "v " << grid.positions[i] << " " << grid.positions[i + 1] << " " << grid.positions[i + 2] << "\n";
+    }
+    for (size_t i = 0; i < grid.uvs.size(); i += 2) {
+        out << "vt " << grid.uvs[i] << " " << grid.uvs[i + 1] << "\n";
+    }
+    for (size_t i = 0; i < grid.indices.size(); i += 3) {
+        // OBJ indices are 1 based, position and uv share the index
+        uint32_t a = grid.indices[i] + 1;
+        uint32_t b = grid.indices[i + 1] + 1;
+        uint32_t c = grid.indices[i + 2] + 1;
+        out << "f " << a << "/" << a << " " << b << "/" << b << " " << c << "/" << c << "\n";
+    }
+}
+
+// positions, uvs and indices back to back, every section a multiple of 4 bytes
+static std::string gltf_binary(const Grid &grid) {
+    std::string bin;
+    bin.append(reinterpret_cast<const char *>(grid.positions.data()), grid.positions.size() * sizeof(float));
+    bin.append(reinterpret_cast<const char *>(grid.uvs.data()), grid.uvs.size() * sizeof(float));
+    bin.append(reinterpret_cast<const char *>(grid.indices.data()), grid.indices.size() * sizeof(uint32_t));
+    return bin;
+}
+
+static std::string gltf_json(const Grid &grid, const std::string &uri) {
+    size_t vertex_count = grid.positions.size() / 3;
+    size_t position_size = grid.positions.size() * sizeof(float);
+    size_t uv_size = grid.uvs.size() * sizeof(float);
+    size_t index_size = grid.indices.size() * sizeof(uint32_t);
+
+    std::ostringstream json;
+    json << R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":)" << position_size + uv_size + index_size;
+    if (!uri.empty()) {
+        json << R"(,"uri":")" << uri << '"';
+    }
+    json << R"(}],"bufferViews":[)"
+            << R"({"buffer":0,"byteOffset":0,"byteLength":)" << position_size << "},"
+            << R"({"buffer":0,"byteOffset":)" << position_size << R"(,"byteLength":)" << uv_size << "},"
+            << R"({"buffer":0,"byteOffset":)" << position_size + uv_size << R"(,"byteLength":)" << index_size << "}"
+            << R"(],"accessors":[)"
+            << R"({"bufferView":0,"componentType":5126,"count":)" << vertex_count << R"(,"type":"VEC3"},)"
+            << R"({"bufferView":1,"componentType":5126,"count":)" << vertex_count << R"(,"type":"VEC2"},)"
+            << R"({"bufferView":2,"componentType":5125,"count":)" << grid.indices.size() << R"(,"type":"SCALAR"})"
+            << R"(],"meshes":[{"primitives":[{"attributes":{"POSITION":0,"TEXCOORD_0":1},"indices":2}]}]})";
+    return json.str();
+}
+
+static void write_u32(std::ofstream &out, uint32_t value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void write_gltf(const fs::path &path, const Grid &grid) {
+    auto bin_name = path.stem().string() + ".bin";
+    std::ofstream(path, std::ios::binary) << gltf_json(grid, bin_name);
+    auto bin = gltf_binary(grid);
+    std::ofstream(path.parent_path() / bin_name, std::ios::binary).write(bin.data(), static_cast<std::streamsize>(bin.size()));
+}
+
+static void write_glb(const fs::path &path, const Grid &grid) {
+    auto json = gltf_json(grid, "");
+    json.resize((json.size() + 3) & ~size_t{3}, ' ');
+    auto bin = gltf_binary(grid);
+
+    std::ofstream out(path, std::ios::binary);
+    write_u32(out, 0x46546C67); // "glTF"
+    write_u32(out, 2);
+    write_u32(out, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+    write_u32(out, static_cast<uint32_t>(json.size()));
+    write_u32(out, 0x4E4F534A); // "JSON"
+    out.write(json.data(), static_cast<std::streamsize>(json.size()));
+    write_u32(out, static_cast<uint32_t>(bin.size()));
+    write_u32(out, 0x004E4942); // "BIN"
+    out.write(bin.data(), static_cast<std::streamsize>(bin.size()));
+}
+
+static void run(const char *name, const fs::path &path, lvk::ThreadPool &workers) {
+    lvk::MeshGeometry geometry{};
+    double ms = best_of_ms(RUNS, [&] { geometry = lvk::ParseMeshFile(path.string(), workers); });
+    double megabytes = static_cast<double>(geometry.stats.file_size) / (1024.0 * 1024.0);
+    std::cout << "  " << name << ": " << std::fixed << std::setprecision(1) << megabytes << " MiB, "
+            << geometry.stats.chunk_count << " chunks, parse " << geometry.stats.ParseMegabytesPerSecond()
+            << " MB/s, end to end " << megabytes / ms * 1000.0 << " MB/s (" << ms << " ms), "
+            << geometry.vertices.size() << " vertices\n";
+}
+
+int main(int argc, char **argv) {
+    uint32_t size = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 1024;
+    fs::path directory = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "mesh_loader_bench";
+    fs::create_directories(directory);
+
+    auto grid = make_grid(size);
+    auto obj = directory / "grid.obj";
+    auto gltf = directory / "grid.gltf";
+    auto glb = directory / "grid.glb";
+    write_obj(obj, grid);
+    write_gltf(gltf, grid);
+    write_glb(glb, grid);
+
+    lvk::ThreadPool single(1);
+    lvk::ThreadPool pool;
+    std::cout << "[MeshLoaderBench] " << size << "x" << size << " grid, " << grid.positions.size() / 3
+            << " vertices, " << grid.indices.size() / 3 << " triangles\n";
+    run("obj, 1 worker", obj, single);
+    std::string pool_name = "obj, pool of " + std::to_string(pool.GetThreadCount());
+    run(pool_name.c_str(), obj, pool);
+    run("gltf + bin", gltf, pool);
+    run("glb", glb, pool);
+
+    for (auto const &path: {obj, gltf, directory / "grid.bin", glb}) {
+        fs::remove(path);
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+//
+// Created by admin on 2026/10/18.
+//
+// ACMR / ATVR of generated meshes before and after the mesh optimizer passes. Triangles are
+// shuffled first, the order a naive exporter or a hash based welder leaves behind, then vertex
+// cache and overdraw optimization run on them. Also prints each pass's time and overdraw.
+//
+//   mesh_optimizer_bench
+//
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "bench.h"
+#include "mesh_optimizer.h"
+
+struct BenchMesh {
+    const char *name;
+    std::vector<float> positions; // xyz
+    std::vector<uint32_t> indices;
+
+    [[nodiscard]] size_t VertexCount() const { return positions.size() / 3; }
+};
+
+static BenchMesh make_grid(uint32_t size) {
+    BenchMesh mesh{"grid", {}, {}};
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            mesh.positions.insert(mesh.positions.end(), {static_cast<float>(x), static_cast<float>(y), 0.0f});
+        }
+    }
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t a = y * (size + 1) + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + size + 1;
+            uint32_t d = c + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, c, b, d, c});
+        }
+    }
+    return mesh;
+}
+
+static BenchMesh make_sphere(uint32_t rings, uint32_t segments) {
+    BenchMesh mesh{"sphere", {}, {}};
+    constexpr float PI = 3.14159265358979f;
+    for (uint32_t ring = 0; ring <= rings; ring++) {
+        float theta = PI * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t segment = 0; segment <= segments; segment++) {
+            float phi = 2.0f * PI * static_cast<float>(segment) / static_cast<float>(segments);
+            mesh.positions.insert(mesh.positions.end(),
+                                  {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)});
+        }
+    }
+    for (uint32_t ring = 0; ring < rings; ring++) {
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + segments + 1;
+            // counter clockwise seen from outside
+            mesh.indices.insert(mesh.indices.end(), {a, a + 1, b, a + 1, b + 1, b});
+        }
+    }
+    return mesh;
+}
+
+static void shuffle_triangles(std::vector<uint32_t> &indices) {
+    size_t triangle_count = indices.size() / 3;
+    std::vector<uint32_t> order(triangle_count);
+    std::iota(order.begin(), order.end(), 0u);
+    BenchRandom random;
+    for (size_t i = triangle_count - 1; i > 0; i--) {
+        std::swap(order[i], order[random.Next() % (i + 1)]);
+    }
+    std::vector<uint32_t> shuffled(indices.size());
+    for (size_t i = 0; i < triangle_count; i++) {
+        for (size_t k = 0; k < 3; k++) {
+            shuffled[i * 3 + k] = indices[order[i] * 3 + k];
+        }
+    }
+    indices.swap(shuffled);
+}
+
+static void print_row(const char *stage, const BenchMesh &mesh, const std::vector<uint32_t> &indices, double ms) {
+    auto cache16 = lvk::AnalyzeVertexCache(indices.data(), indices.size(), mesh.VertexCount(), 16);
+    auto cache32 = lvk::AnalyzeVertexCache(indices.data(), indices.size(), mesh.VertexCount(), 32);
+    auto overdraw = lvk::AnalyzeOverdraw(indices.data(), indices.size(), mesh.positions.data(), mesh.VertexCount(),
+                                         3 * sizeof(float));
+    std::cout << "    " << std::left << std::setw(12) << stage << std::right << std::fixed << std::setprecision(3)
+            << " ACMR " << cache16.acmr << " / " << cache32.acmr << "  ATVR " << cache16.atvr << " / "
+            << cache32.atvr << "  overdraw " << overdraw.overdraw;
+    if (ms > 0.0) {
+        std::cout << "  " << std::setprecision(2) << ms << " ms";
+    }
+    std::cout << "\n";
+}
+
+static void run(const BenchMesh &mesh) {
+    std::cout << "  " << mesh.name << ", " << mesh.VertexCount() << " vertices, " << mesh.indices.size() / 3
+            << " triangles (FIFO 16 / 32 entries)\n";
+    print_row("generated", mesh, mesh.indices, 0.0);
+
+    std::vector<uint32_t> shuffled = mesh.indices;
+    shuffle_triangles(shuffled);
+    print_row("shuffled", mesh, shuffled, 0.0);
+
+    std::vector<uint32_t> cache(shuffled.size());
+    double cache_ms = best_of_ms(3, [&] {
+        lvk::OptimizeVertexCache(cache.data(), shuffled.data(), shuffled.size(), mesh.VertexCount());
+    });
+    print_row("vertex cache", mesh, cache, cache_ms);
+
+    std::vector<uint32_t> overdraw(cache.size());
+    double overdraw_ms = best_of_ms(3, [&] {
+        lvk::OptimizeOverdraw(overdraw.data(), cache.data(), cache.size(), mesh.positions.data(), mesh.VertexCount(),
+                              3 * sizeof(float));
+    });
+    print_row("overdraw", mesh, overdraw, overdraw_ms);
+}
+
+int main() {
+    std::cout << "[MeshOptimizerBench]\n";
+    run(make_grid(256));
+    run(make_grid(512));
+    run(make_sphere(256, 512));
+    return 0;
+}
@@ -0,0 +1,227 @@
+//
+// Created by admin on 2026/10/18.
+//
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <set>
+#include <vector>
+
+#include <meshlet.h>
+
+#include "check.h"
+
+namespace {
+struct TestMesh {
+    std::vector<float> positions; // xyz
+    std::vector<uint32_t> indices;
+
+    [[nodiscard]] size_t VertexCount() const { return positions.size() / 3; }
+
+    [[nodiscard]] const float *Position(uint32_t vertex) const { return positions.data() + vertex * 3; }
+};
+
+// closed, counter-clockwise seen from outside
+TestMesh make_sphere(uint32_t rings, uint32_t segments) {
+    TestMesh mesh;
+    constexpr float PI = 3.14159265358979f;
+    for (uint32_t ring = 0; ring <= rings; ring++) {
+        float theta = PI * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t segment = 0; segment <= segments; segment++) {
+            float phi = 2.0f * PI * static_cast<float>(segment) / static_cast<float>(segments);
+            mesh.positions.insert(mesh.positions.end(),
+                                  {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)});
+        }
+    }
+    for (uint32_t ring = 0; ring < rings; ring++) {
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, a + 1, b, a + 1, b + 1, b});
+        }
+    }
+    return mesh;
+}
+
+// flat in the xz plane, facing +y
+TestMesh make_grid(uint32_t size) {
+    TestMesh mesh;
+    for (uint32_t z = 0; z <= size; z++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            mesh.positions.insert(mesh.positions.end(), {static_cast<float>(x), 0.0f, static_cast<float>(z)});
+        }
+    }
+    for (uint32_t z = 0; z < size; z++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t a = z * (size + 1) + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + size + 1;
+            uint32_t d = c + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, c, b, b, c, d});
+        }
+    }
+    return mesh;
+}
+
+// the same triangles in a scrambled order, meshlets can't just follow the index buffer
+void shuffle_triangles(TestMesh &mesh) {
+    size_t triangle_count = mesh.indices.size() / 3;
+    std::vector<uint32_t> order(triangle_count);
+    std::iota(order.begin(), order.end(), 0u);
+    uint32_t state = 12345;
+    for (size_t i = triangle_count - 1; i > 0; i--) {
+        state = state * 1664525u + 1013904223u;
+        std::swap(order[i], order[state % (i + 1)]);
+    }
+    std::vector<uint32_t> shuffled(mesh.indices.size());
+    for (size_t i = 0; i < triangle_count; i++) {
+        for (size_t k = 0; k < 3; k++) {
+            shuffled[i * 3 + k] = mesh.indices[order[i] * 3 + k];
+        }
+    }
+    mesh.indices.swap(shuffled);
+}
+
+using Triangle = std::array<uint32_t, 3>;
+
+// rotated to start at the smallest index, the winding is kept
+Triangle canonical(uint32_t a, uint32_t b, uint32_t c) {
+    Triangle triangle{a, b, c};
+    std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+    return triangle;
+}
+
+Triangle meshlet_triangle(const lvk::MeshletMesh &result, const lvk::Meshlet &meshlet, uint32_t triangle) {
+    uint32_t packed = result.triangles[meshlet.triangle_offset + triangle];
+    return {result.vertices[meshlet.vertex_offset + (packed & 0xFF)],
+            result.vertices[meshlet.vertex_offset + ((packed >> 8) & 0xFF)],
+            result.vertices[meshlet.vertex_offset + ((packed >> 16) & 0xFF)]};
+}
+
+lvk::MeshletMesh build(const TestMesh &mesh, uint32_t max_vertices, uint32_t max_triangles) {
+    return lvk::BuildMeshlets(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), mesh.VertexCount(),
+                              3 * sizeof(float), max_vertices, max_triangles);
+}
+
+void check_limits(const TestMesh &mesh, uint32_t max_vertices, uint32_t max_triangles) {
+    auto result = build(mesh, max_vertices, max_triangles);
+    LVK_CHECK(result.meshlets.size() == result.bounds.size());
+
+    for (auto const &meshlet: result.meshlets) {
+        LVK_CHECK(meshlet.vertex_count > 0 && meshlet.vertex_count <= max_vertices);
+        LVK_CHECK(meshlet.triangle_count > 0 && meshlet.triangle_count <= max_triangles);
+        LVK_CHECK(meshlet.vertex_offset + meshlet.vertex_count <= result.vertices.size());
+        LVK_CHECK(meshlet.triangle_offset + meshlet.triangle_count <= result.triangles.size());
+
+        for (uint32_t t = 0; t < meshlet.triangle_count; t++) {
+            uint32_t packed = result.triangles[meshlet.triangle_offset + t];
+            LVK_CHECK((packed >> 24) == 0);
+            LVK_CHECK((packed & 0xFF) < meshlet.vertex_count);
+            LVK_CHECK(((packed >> 8) & 0xFF) < meshlet.vertex_count);
+            LVK_CHECK(((packed >> 16) & 0xFF) < meshlet.vertex_count);
+        }
+    }
+}
+
+void check_triangles_preserved(const TestMesh &mesh) {
+    auto result = build(mesh, lvk::MESHLET_MAX_VERTICES, lvk::MESHLET_MAX_TRIANGLES);
+
+    std::multiset<Triangle> expected;
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        expected.insert(canonical(mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]));
+    }
+    std::multiset<Triangle> actual;
+    for (auto const &meshlet: result.meshlets) {
+        for (uint32_t t = 0; t < meshlet.triangle_count; t++) {
+            auto triangle = meshlet_triangle(result, meshlet, t);
+            actual.insert(canonical(triangle[0], triangle[1], triangle[2]));
+        }
+    }
+    LVK_CHECK(actual == expected);
+}
+
+void check_bounds_conservative(const TestMesh &mesh) {
+    auto result = build(mesh, lvk::MESHLET_MAX_VERTICES, lvk::MESHLET_MAX_TRIANGLES);
+    for (size_t i = 0; i < result.meshlets.size(); i++) {
+        auto const &meshlet = result.meshlets[i];
+        auto const &bounds = result.bounds[i];
+        for (uint32_t v = 0; v < meshlet.vertex_count; v++) {
+            const float *p = mesh.Position(result.vertices[meshlet.vertex_offset + v]);
+            float dx = p[0] - bounds.center[0];
+            float dy = p[1] - bounds.center[1];
+            float dz = p[2] - bounds.center[2];
+            float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+            LVK_CHECK(distance <= bounds.radius * 1.0001f + 1e-6f);
+        }
+    }
+}
+
+// Whatever IsMeshletBackfacing() culls must not hold a single triangle facing the camera.
+uint32_t check_backface_conservative(const TestMesh &mesh, const std::vector<std::array<float, 3>> &cameras) {
+    auto result = build(mesh, lvk::MESHLET_MAX_VERTICES, lvk::MESHLET_MAX_TRIANGLES);
+    uint32_t culled = 0;
+    for (auto const &camera: cameras) {
+        for (size_t i = 0; i < result.meshlets.size(); i++) {
+            if (!lvk::IsMeshletBackfacing(result.bounds[i], camera.data())) {
+                continue;
+            }
+            culled++;
+            auto const &meshlet = result.meshlets[i];
+            for (uint32_t t = 0; t < meshlet.triangle_count; t++) {
+                auto triangle = meshlet_triangle(result, meshlet, t);
+                const float *p0 = mesh.Position(triangle[0]);
+                const float *p1 = mesh.Position(triangle[1]);
+                const float *p2 = mesh.Position(triangle[2]);
+                float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                float normal[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                                   e1[0] * e2[1] - e1[1] * e2[0]};
+                float view[3] = {p0[0] - camera[0], p0[1] - camera[1], p0[2] - camera[2]};
+                // counter-clockwise front faces have their normal pointing at the camera
+                LVK_CHECK(normal[0] * view[0] + normal[1] * view[1] + normal[2] * view[2] >= 0.0f);
+            }
+        }
+    }
+    return culled;
+}
+
+std::vector<std::array<float, 3>> make_cameras(float extent, float height_offset) {
+    std::vector<std::array<float, 3>> cameras;
+    uint32_t state = 777;
+    auto next = [&] {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+    };
+    for (int i = 0; i < 64; i++) {
+        cameras.push_back({next() * extent, next() * extent + height_offset, next() * extent});
+    }
+    return cameras;
+}
+} // namespace
+
+int main() {
+    auto sphere = make_sphere(48, 96);
+    auto grid = make_grid(64);
+    auto shuffled = make_sphere(48, 96);
+    shuffle_triangles(shuffled);
+
+    for (auto const *mesh: {&sphere, &grid, &shuffled}) {
+        check_limits(*mesh, lvk::MESHLET_MAX_VERTICES, lvk::MESHLET_MAX_TRIANGLES);
+        check_limits(*mesh, 16, 8);
+        check_limits(*mesh, 3, 1);
+        check_triangles_preserved(*mesh);
+        check_bounds_conservative(*mesh);
+    }
+
+    // cameras inside, near and far outside the sphere
+    uint32_t culled = check_backface_conservative(sphere, make_cameras(4.0f, 0.0f));
+    culled += check_backface_conservative(shuffled, make_cameras(1.5f, 0.0f));
+    // the test must actually cull something or it proves nothing
+    LVK_CHECK(culled > 0);
+    // above and below the grid, below it everything faces away
+    LVK_CHECK(check_backface_conservative(grid, make_cameras(64.0f, 0.0f)) > 0);
+
+    return CheckResult("meshlet_test");
+}
@@ -0,0 +1,92 @@
+//
+// Created by admin on 2026/10/18.
+//
+
+#include <allocator.h>
+
+#include "check.h"
+
+using lvk::OffsetAllocator;
+
+namespace {
+void test_alignment_padding() {
+    OffsetAllocator ranges(1024);
+    LVK_CHECK(ranges.Allocate(10) == 0);
+
+    // the 54 bytes of padding in front of the aligned offset are taken with it
+    uint64_t aligned = ranges.Allocate(16, 64);
+    LVK_CHECK(aligned == 64);
+    LVK_CHECK(ranges.GetUsedSize() == 10 + 54 + 16);
+
+    // and given back with it
+    ranges.Free(aligned);
+    LVK_CHECK(ranges.GetUsedSize() == 10);
+    LVK_CHECK(ranges.GetFreeRangeCount() == 1);
+    LVK_CHECK(ranges.GetLargestFreeRange() == 1024 - 10);
+}
+
+void test_best_fit() {
+    OffsetAllocator ranges(1000);
+    uint64_t a = ranges.Allocate(100);
+    uint64_t b = ranges.Allocate(50);
+    uint64_t c = ranges.Allocate(100);
+    uint64_t d = ranges.Allocate(20);
+    uint64_t e = ranges.Allocate(100);
+    LVK_CHECK(a == 0 && b == 100 && c == 150 && d == 250 && e == 270);
+
+    // holes of 50 at 100 and of 20 at 250, plus the 630 at the end
+    ranges.Free(b);
+    ranges.Free(d);
+    LVK_CHECK(ranges.GetFreeRangeCount() == 3);
+
+    LVK_CHECK(ranges.Allocate(20) == 250);
+    LVK_CHECK(ranges.Allocate(40) == 100);
+    LVK_CHECK(ranges.Allocate(60) == 370);
+}
+
+void test_coalescing() {
+    OffsetAllocator ranges(300);
+    uint64_t a = ranges.Allocate(100);
+    uint64_t b = ranges.Allocate(100);
+    uint64_t c = ranges.Allocate(100);
+    LVK_CHECK(ranges.GetFreeRangeCount() == 0);
+
+    ranges.Free(a);
+    ranges.Free(c);
+    LVK_CHECK(ranges.GetFreeRangeCount() == 2);
+    LVK_CHECK(ranges.GetLargestFreeRange() == 100);
+
+    // merges with the free range before and the one after
+    ranges.Free(b);
+    LVK_CHECK(ranges.GetFreeRangeCount() == 1);
+    LVK_CHECK(ranges.GetLargestFreeRange() == 300);
+    LVK_CHECK(ranges.GetUsedSize() == 0);
+    LVK_CHECK(ranges.Allocate(300) == 0);
+}
+
+void test_exhaustion() {
+    OffsetAllocator ranges(256);
+    LVK_CHECK(ranges.Allocate(0) == OffsetAllocator::INVALID_OFFSET);
+    LVK_CHECK(ranges.Allocate(257) == OffsetAllocator::INVALID_OFFSET);
+
+    LVK_CHECK(ranges.Allocate(256) == 0);
+    LVK_CHECK(ranges.Allocate(1) == OffsetAllocator::INVALID_OFFSET);
+    LVK_CHECK(ranges.GetLargestFreeRange() == 0);
+
+    ranges.Reset();
+    LVK_CHECK(ranges.GetUsedSize() == 0 && ranges.GetAllocationCount() == 0);
+
+    // 127 bytes are free, but not 100 of them at a multiple of 64
+    LVK_CHECK(ranges.Allocate(129) == 0);
+    LVK_CHECK(ranges.Allocate(100, 64) == OffsetAllocator::INVALID_OFFSET);
+    LVK_CHECK(ranges.Allocate(100, 1) == 129);
+}
+} // namespace
+
+int main() {
+    test_alignment_padding();
+    test_best_fit();
+    test_coalescing();
+    test_exhaustion();
+    return CheckResult("offset_allocator_test");
+}
@@ -0,0 +1,267 @@
+//
+// Created by admin on 2026/10/18.
+//
+
+#include <stdexcept>
+#include <vector>
+
+#include <render_graph.h>
+
+#include "check.h"
+
+namespace {
+using lvk::RenderAccess;
+using lvk::RenderGraphPlan;
+using Resource = RenderGraphPlan::Resource;
+
+constexpr VkDeviceSize PAGE = 64 * 1024;
+
+// what a driver might report: tightly packed, rounded to 64 KiB pages, depth in its own memory type
+VkMemoryRequirements query_requirements(const RenderGraphPlan &plan, Resource image) {
+    auto const &desc = plan.GetResource(image).desc;
+    VkDeviceSize texel = desc.format == VK_FORMAT_R16G16B16A16_SFLOAT ? 8 : 4;
+    VkDeviceSize size = static_cast<VkDeviceSize>(desc.extent.width) * desc.extent.height * texel;
+    bool depth = (lvk::GetImageAspect(desc.format) & VK_IMAGE_ASPECT_DEPTH_BIT) != 0;
+    return {(size + PAGE - 1) / PAGE * PAGE, PAGE, depth ? 2u : 1u};
+}
+
+RenderGraphPlan::MemoryQuery make_query(const RenderGraphPlan &plan) {
+    return [&plan](Resource image, VkImageUsageFlags) { return query_requirements(plan, image); };
+}
+
+const RenderGraphPlan::ImageBarrier *find_image(const RenderGraphPlan::BarrierBatch &batch, Resource image) {
+    for (auto const &barrier: batch.images) {
+        if (barrier.image == image) {
+            return &barrier;
+        }
+    }
+    return nullptr;
+}
+
+void check_image_barrier(const RenderGraphPlan::BarrierBatch &batch, Resource image, VkImageLayout old_layout,
+                         VkImageLayout new_layout, VkAccessFlags src_access) {
+    auto barrier = find_image(batch, image);
+    LVK_CHECK(barrier != nullptr);
+    if (barrier) {
+        LVK_CHECK(barrier->old_layout == old_layout);
+        LVK_CHECK(barrier->new_layout == new_layout);
+        LVK_CHECK(barrier->src_access == src_access);
+    }
+}
+
+// transient images alive in the same group never share memory
+void check_no_live_overlap(const RenderGraphPlan &plan, const std::vector<Resource> &transients) {
+    for (auto a: transients) {
+        for (auto b: transients) {
+            auto const &x = plan.GetResource(a);
+            auto const &y = plan.GetResource(b);
+            if (a == b || x.heap != y.heap) {
+                continue;
+            }
+            bool live_together = x.first_group <= y.last_group && y.first_group <= x.last_group;
+            bool overlap = x.offset < y.offset + y.size && y.offset < x.offset + x.size;
+            LVK_CHECK(!(live_together && overlap));
+            LVK_CHECK(x.offset + x.size <= plan.GetHeaps()[x.heap].size);
+        }
+    }
+}
+
+// compute particles, g-buffer, lighting, bloom and post into the swapchain image, plus a debug view
+// nothing reads
+void check_deferred_bloom() {
+    RenderGraphPlan plan;
+    VkExtent2D extent{1280, 720};
+    auto backbuffer = plan.ImportImage("backbuffer", {extent, VK_FORMAT_B8G8R8A8_SRGB}, VK_IMAGE_LAYOUT_UNDEFINED,
+                                       VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    auto albedo = plan.CreateImage("albedo", {extent, VK_FORMAT_R16G16B16A16_SFLOAT});
+    auto depth = plan.CreateImage("depth", {extent, VK_FORMAT_D32_SFLOAT});
+    auto hdr = plan.CreateImage("hdr", {extent, VK_FORMAT_R16G16B16A16_SFLOAT});
+    auto debug = plan.CreateImage("debug", {extent, VK_FORMAT_R16G16B16A16_SFLOAT});
+    auto bright = plan.CreateImage("bright", {extent, VK_FORMAT_R16G16B16A16_SFLOAT});
+    auto blur = plan.CreateImage("blur", {extent, VK_FORMAT_R16G16B16A16_SFLOAT});
+    auto particles = plan.ImportBuffer("particles", VK_NULL_HANDLE);
+
+    auto simulate_pass = plan.AddPass("simulate", {}).Write(particles, RenderAccess::StorageWrite).GetPass();
+    auto gbuffer_pass = plan.AddPass("gbuffer", {})
+            .Color(albedo, VK_ATTACHMENT_LOAD_OP_CLEAR)
+            .Depth(depth, VK_ATTACHMENT_LOAD_OP_CLEAR)
+            .GetPass();
+    auto particles_pass = plan.AddPass("particles", {})
+            .Read(particles, RenderAccess::VertexInput)
+            .Color(albedo)
+            .Depth(depth)
+            .GetPass();
+    auto lighting_pass = plan.AddPass("lighting", {})
+            .Read(albedo, RenderAccess::SampledFragment)
+            .Color(hdr, VK_ATTACHMENT_LOAD_OP_CLEAR)
+            .GetPass();
+    auto debug_pass = plan.AddPass("debug", {}).Color(debug, VK_ATTACHMENT_LOAD_OP_CLEAR).GetPass();
+    auto bright_pass = plan.AddPass("bright", {})
+            .Read(hdr, RenderAccess::SampledFragment)
+            .Color(bright, VK_ATTACHMENT_LOAD_OP_CLEAR)
+            .GetPass();
+    auto blur_pass = plan.AddPass("blur", {})
+            .Read(bright, RenderAccess::SampledFragment)
+            .Color(blur, VK_ATTACHMENT_LOAD_OP_CLEAR)
+            .GetPass();
+    auto post_pass = plan.AddPass("post", {})
+            .Read(hdr, RenderAccess::SampledFragment)
+            .Read(blur, RenderAccess::SampledFragment)
+            .Color(backbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR)
+            .GetPass();
+    auto ui_pass = plan.AddPass("ui", {}).Color(backbuffer).GetPass();
+
+    plan.Build(make_query(plan));
+    LVK_CHECK(plan.IsBuilt());
+
+    // passes: only the debug view is culled, the particles and ui draws merge into their predecessors
+    auto const &stats = plan.GetStats();
+    LVK_CHECK(stats.passes == 9);
+    LVK_CHECK(stats.culled == 1);
+    LVK_CHECK(plan.IsCulled(debug_pass));
+    LVK_CHECK(plan.GetGroup(debug_pass) == RenderGraphPlan::NO_GROUP);
+    LVK_CHECK(stats.render_passes == 5);
+
+    auto const &groups = plan.GetGroups();
+    LVK_CHECK(groups.size() == 6);
+    if (groups.size() != 6) {
+        return;
+    }
+    LVK_CHECK(plan.GetGroup(simulate_pass) == 0);
+    LVK_CHECK(groups[0].attachments.empty());
+    LVK_CHECK(plan.GetGroup(gbuffer_pass) == 1);
+    LVK_CHECK(plan.GetGroup(particles_pass) == 1);
+    LVK_CHECK(plan.GetGroup(lighting_pass) == 2);
+    LVK_CHECK(plan.GetGroup(bright_pass) == 3);
+    LVK_CHECK(plan.GetGroup(blur_pass) == 4);
+    LVK_CHECK(plan.GetGroup(post_pass) == 5);
+    LVK_CHECK(plan.GetGroup(ui_pass) == 5);
+
+    // the g-buffer depth is never read again, everything else is
+    LVK_CHECK(groups[1].attachments.size() == 2);
+    if (groups[1].attachments.size() == 2) {
+        LVK_CHECK(groups[1].attachments[0].image == albedo);
+        LVK_CHECK(groups[1].attachments[0].store == VK_ATTACHMENT_STORE_OP_STORE);
+        LVK_CHECK(groups[1].attachments[1].image == depth);
+        LVK_CHECK(groups[1].attachments[1].store == VK_ATTACHMENT_STORE_OP_DONT_CARE);
+    }
+    for (uint32_t group = 2; group < groups.size(); group++) {
+        LVK_CHECK(groups[group].attachments.size() == 1);
+        LVK_CHECK(groups[group].attachments[0].store == VK_ATTACHMENT_STORE_OP_STORE);
+    }
+
+    // barriers: the imported buffer needs none before its first write
+    LVK_CHECK(groups[0].before.IsEmpty());
+
+    // transient images are reused every execution: their first access waits for the previous one's
+    // last accesses to the same memory, albedo's range was last sampled as bright by the blur pass
+    auto const &gbuffer = groups[1].before;
+    LVK_CHECK(gbuffer.images.size() == 2);
+    check_image_barrier(gbuffer, albedo, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    check_image_barrier(gbuffer, depth, VK_IMAGE_LAYOUT_UNDEFINED,
+                        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+    LVK_CHECK(gbuffer.src_stages & VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    LVK_CHECK(gbuffer.src_stages & VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT);
+    // the merged particles draw reads the simulation's output
+    LVK_CHECK(gbuffer.buffers.size() == 1);
+    if (gbuffer.buffers.size() == 1) {
+        LVK_CHECK(gbuffer.buffers[0].buffer == particles);
+        LVK_CHECK(gbuffer.buffers[0].src_access == VK_ACCESS_SHADER_WRITE_BIT);
+        LVK_CHECK(gbuffer.buffers[0].dst_access & VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+    }
+    LVK_CHECK(gbuffer.src_stages & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    LVK_CHECK(gbuffer.dst_stages & VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+
+    auto const &lighting = groups[2].before;
+    LVK_CHECK(lighting.images.size() == 2);
+    LVK_CHECK(lighting.buffers.empty());
+    check_image_barrier(lighting, albedo, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    check_image_barrier(lighting, hdr, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    LVK_CHECK(lighting.src_stages & VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    // bright reuses albedo's memory, so it waits for the lighting pass to be done sampling it
+    auto const &bright_batch = groups[3].before;
+    LVK_CHECK(bright_batch.images.size() == 2);
+    check_image_barrier(bright_batch, hdr, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    check_image_barrier(bright_batch, bright, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    LVK_CHECK(bright_batch.src_stages & VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    auto const &blur_batch = groups[4].before;
+    LVK_CHECK(blur_batch.images.size() == 2);
+    check_image_barrier(blur_batch, bright, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    check_image_barrier(blur_batch, blur, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+    // hdr was made visible to fragment shaders before bright, post reads it without another barrier
+    auto const &post = groups[5].before;
+    LVK_CHECK(post.images.size() == 2);
+    LVK_CHECK(find_image(post, hdr) == nullptr);
+    check_image_barrier(post, blur, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    // chains with the acquire semaphore's wait
+    check_image_barrier(post, backbuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 0);
+    LVK_CHECK(post.src_stages & VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+    auto const &final_barriers = plan.GetFinalBarriers();
+    LVK_CHECK(final_barriers.images.size() == 1);
+    check_image_barrier(final_barriers, backbuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+    LVK_CHECK(stats.barrier_batches == 6);
+    LVK_CHECK(stats.image_barriers == 11);
+    LVK_CHECK(stats.buffer_barriers == 1);
+
+    // placement: albedo and bright never live at the same time and share memory
+    std::vector<Resource> transients = {albedo, depth, hdr, bright, blur};
+    VkDeviceSize color_size = query_requirements(plan, albedo).size;
+    VkDeviceSize depth_size = query_requirements(plan, depth).size;
+    LVK_CHECK(stats.transient_images == 5);
+    LVK_CHECK(stats.transient_size == 4 * color_size + depth_size);
+    LVK_CHECK(stats.transient_memory == 3 * color_size + depth_size);
+    LVK_CHECK(plan.GetHeaps().size() == 2);
+    LVK_CHECK(plan.GetResource(depth).heap != plan.GetResource(albedo).heap);
+    LVK_CHECK(plan.GetResource(debug).size == 0);
+
+    LVK_CHECK(plan.GetResource(albedo).first_group == 1 && plan.GetResource(albedo).last_group == 2);
+    LVK_CHECK(plan.GetResource(hdr).first_group == 2 && plan.GetResource(hdr).last_group == 5);
+    LVK_CHECK(plan.GetResource(bright).first_group == 3 && plan.GetResource(bright).last_group == 4);
+    LVK_CHECK(plan.GetResource(bright).offset == plan.GetResource(albedo).offset);
+    LVK_CHECK(plan.GetResource(bright).aliased == std::vector<Resource>{albedo});
+    LVK_CHECK(plan.GetResource(albedo).aliased.empty());
+    LVK_CHECK(plan.GetResource(blur).aliased.empty());
+    check_no_live_overlap(plan, transients);
+
+    // building again gives the same plan
+    plan.Build(make_query(plan));
+    LVK_CHECK(plan.GetGroups().size() == 6);
+    LVK_CHECK(plan.GetStats().transient_memory == 3 * color_size + depth_size);
+    LVK_CHECK(plan.GetResource(bright).aliased == std::vector<Resource>{albedo});
+}
+
+void check_two_layouts_throw() {
+    RenderGraphPlan plan;
+    auto image = plan.CreateImage("image", {{64, 64}, VK_FORMAT_R8G8B8A8_UNORM});
+    plan.AddPass("feedback", {}).Read(image, RenderAccess::SampledFragment).Color(image).SideEffect();
+    bool threw = false;
+    try {
+        plan.Build(make_query(plan));
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    LVK_CHECK(threw);
+    LVK_CHECK(!plan.IsBuilt());
+}
+} // namespace
+
+int main() {
+    check_deferred_bloom();
+    check_two_layouts_throw();
+    return CheckResult("render_graph_test");
+}
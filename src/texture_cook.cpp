@@ -0,0 +1,256 @@
+//
+// Created by admin on 2026/10/17.
+//
+// Offline texture cooker: decodes images once, builds the mip chain and optionally BC1 compresses
+// it, then writes a container the runtime maps and copies into staging memory without decoding.
+//
+//   texture_cook [--bc1] [--no-mips] [--bench] <image or directory> [output file or directory]
+//
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+#include <stb_image.h>
+
+#include "mapped_file.h"
+#include "mip_generator.h"
+#include "texture_container.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+struct CookOptions {
+    bool bc1 = false;
+    bool mipmaps = true;
+    bool bench = false;
+};
+
+struct CookedLevel {
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> data;
+};
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<uint8_t> compress_bc1(const uint8_t *rgba, uint32_t width, uint32_t height, lvk::ThreadPool &pool) {
+    uint32_t blocks_x = (width + 3) / 4;
+    uint32_t blocks_y = (height + 3) / 4;
+    std::vector<uint8_t> blocks(static_cast<size_t>(blocks_x) * blocks_y * 8);
+
+    pool.ParallelFor(blocks_y, 4, [&](uint32_t begin, uint32_t end) {
+        uint8_t texels[16 * 4];
+        for (uint32_t by = begin; by < end; by++) {
+            for (uint32_t bx = 0; bx < blocks_x; bx++) {
+                // edge blocks repeat the last row / column
+                for (uint32_t y = 0; y < 4; y++) {
+                    uint32_t sy = std::min(by * 4 + y, height - 1);
+                    for (uint32_t x = 0; x < 4; x++) {
+                        uint32_t sx = std::min(bx * 4 + x, width - 1);
+                        memcpy(&texels[(y * 4 + x) * 4], &rgba[(static_cast<size_t>(sy) * width + sx) * 4], 4);
+                    }
+                }
+                stb_compress_dxt_block(&blocks[(static_cast<size_t>(by) * blocks_x + bx) * 8], texels, 0,
+                                       STB_DXT_HIGHQUAL);
+            }
+        }
+    });
+    return blocks;
+}
+
+static void write_container(const fs::path &output, VkFormat format, const std::vector<CookedLevel> &levels) {
+    auto align = [](uint64_t value) {
+        return (value + lvk::TEXTURE_CONTAINER_ALIGNMENT - 1) & ~(lvk::TEXTURE_CONTAINER_ALIGNMENT - 1);
+    };
+
+    std::vector<lvk::TextureContainerLevel> table(levels.size());
+    uint64_t offset = align(sizeof(lvk::TextureContainerHeader) + sizeof(lvk::TextureContainerLevel) * levels.size());
+    uint64_t data_begin = offset;
+    for (size_t i = 0; i < levels.size(); i++) {
+        table[i] = {offset, levels[i].data.size(), levels[i].width, levels[i].height};
+        offset = align(offset + levels[i].data.size());
+    }
+
+    lvk::TextureContainerHeader header{};
+    header.magic = lvk::TEXTURE_CONTAINER_MAGIC;
+    header.version = lvk::TEXTURE_CONTAINER_VERSION;
+    header.format = static_cast<uint32_t>(format);
+    header.width = levels[0].width;
+    header.height = levels[0].height;
+    header.level_count = static_cast<uint32_t>(levels.size());
+    header.data_size = table.back().offset + table.back().size - data_begin;
+
+    // write next to the target and rename, a running app never maps a half written file
+    fs::path temp = output;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("failed to open " + temp.string());
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(table.data()),
+                   static_cast<std::streamsize>(sizeof(lvk::TextureContainerLevel) * table.size()));
+
+        const char zeros[lvk::TEXTURE_CONTAINER_ALIGNMENT] = {};
+        uint64_t position = sizeof(header) + sizeof(lvk::TextureContainerLevel) * table.size();
+        for (size_t i = 0; i < levels.size(); i++) {
+            file.write(zeros, static_cast<std::streamsize>(table[i].offset - position));
+            file.write(reinterpret_cast<const char *>(levels[i].data.data()),
+                       static_cast<std::streamsize>(levels[i].data.size()));
+            position = table[i].offset + table[i].size;
+        }
+        if (!file) {
+            throw std::runtime_error("failed to write " + temp.string());
+        }
+    }
+    fs::rename(temp, output);
+}
+
+// Same work the runtime does for each kind of file, minus the GPU side.
+static void bench(const fs::path &input, const fs::path &output, const CookOptions &options) {
+    constexpr int runs = 5;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        int width, height, channels;
+        stbi_uc *pixels = stbi_load(input.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            throw std::runtime_error("failed to load texture image: " + input.string());
+        }
+        if (options.mipmaps) {
+            auto layout = lvk::MipGenerator::Layout(width, height,
+                                                    lvk::MipGenerator::LevelCount(width, height));
+            std::vector<uint8_t> chain(layout.size);
+            memcpy(chain.data(), pixels, static_cast<size_t>(width) * height * 4);
+            lvk::MipGenerator::Generate(chain.data(), width, height, layout, true);
+        }
+        stbi_image_free(pixels);
+    }
+    double decode_ms = elapsed_ms(start) / runs;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        lvk::MappedFile mapped(output.string());
+        auto header = lvk::ParseTextureContainer(mapped.GetData(), mapped.GetSize());
+        std::vector<uint8_t> staging(header->data_size);
+        memcpy(staging.data(), mapped.GetData() + lvk::GetContainerLevels(header)[0].offset, staging.size());
+    }
+    double mapped_ms = elapsed_ms(start) / runs;
+
+    std::cout << "  load: decode " << decode_ms << " ms, cooked " << mapped_ms << " ms\n";
+}
+
+static void cook(const fs::path &input, const fs::path &output, const CookOptions &options, lvk::ThreadPool &pool) {
+    auto start = std::chrono::steady_clock::now();
+
+    int texWidth, texHeight, texChannels;
+    stbi_uc *pixels = stbi_load(input.string().c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!pixels) {
+        throw std::runtime_error("failed to load texture image: " + input.string());
+    }
+    auto width = static_cast<uint32_t>(texWidth);
+    auto height = static_cast<uint32_t>(texHeight);
+
+    uint32_t level_count = options.mipmaps ? lvk::MipGenerator::LevelCount(width, height) : 1;
+    auto layout = lvk::MipGenerator::Layout(width, height, level_count);
+    std::vector<uint8_t> chain(layout.size);
+    memcpy(chain.data(), pixels, static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+
+    lvk::MipGenerator::Generate(chain.data(), width, height, layout, true, &pool);
+
+    std::vector<CookedLevel> levels(level_count);
+    for (uint32_t i = 0; i < level_count; i++) {
+        auto &level = levels[i];
+        level.width = std::max(width >> i, 1u);
+        level.height = std::max(height >> i, 1u);
+
+        const uint8_t *rgba = chain.data() + layout.offsets[i];
+        if (options.bc1) {
+            level.data = compress_bc1(rgba, level.width, level.height, pool);
+        } else {
+            level.data.assign(rgba, rgba + static_cast<size_t>(level.width) * level.height * 4);
+        }
+    }
+
+    write_container(output, options.bc1 ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_R8G8B8A8_SRGB, levels);
+
+    std::cout << input.string() << " -> " << output.string() << ": " << width << "x" << height << ", "
+            << level_count << " levels, " << (options.bc1 ? "BC1" : "RGBA8") << ", "
+            << fs::file_size(output) << " bytes, " << elapsed_ms(start) << " ms\n";
+
+    if (options.bench) {
+        bench(input, output, options);
+    }
+}
+
+static bool is_image(const fs::path &path) {
+    auto extension = path.extension().string();
+    for (auto &c: extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".tga" ||
+           extension == ".bmp";
+}
+
+int main(int argc, char **argv) {
+    CookOptions options{};
+    std::vector<fs::path> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bc1") {
+            options.bc1 = true;
+        } else if (arg == "--no-mips") {
+            options.mipmaps = false;
+        } else if (arg == "--bench") {
+            options.bench = true;
+        } else {
+            paths.emplace_back(arg);
+        }
+    }
+
+    if (paths.empty() || paths.size() > 2) {
+        std::cerr << "usage: texture_cook [--bc1] [--no-mips] [--bench] <image or directory> "
+                "[output file or directory]\n";
+        return EXIT_FAILURE;
+    }
+
+    try {
+        lvk::ThreadPool pool;
+
+        if (fs::is_directory(paths[0])) {
+            fs::path output_dir = paths.size() > 1 ? paths[1] : paths[0];
+            fs::create_directories(output_dir);
+            for (auto const &entry: fs::directory_iterator(paths[0])) {
+                if (entry.is_regular_file() && is_image(entry.path())) {
+                    auto output = output_dir / entry.path().filename();
+                    output.replace_extension(lvk::TEXTURE_CONTAINER_EXTENSION);
+                    cook(entry.path(), output, options, pool);
+                }
+            }
+        } else {
+            fs::path output = paths.size() > 1 ? paths[1] : paths[0];
+            if (paths.size() == 1) {
+                output.replace_extension(lvk::TEXTURE_CONTAINER_EXTENSION);
+            }
+            cook(paths[0], output, options, pool);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
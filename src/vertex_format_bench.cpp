@@ -0,0 +1,105 @@
+//
+// Created by admin on 2026/10/18.
+//
+// Vertex data cost of each VertexFormat for Vertex2 and Vertex3 meshes: the bytes vertex fetch
+// reads per draw, the CPU time to pack with the scalar and the SIMD kernels, and the time to
+// write the result into upload memory, against copying the float layouts unchanged.
+//
+//   vertex_format_bench [vertex count, default 1000000]
+//
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "vertex_format.h"
+
+static constexpr uint32_t RUNS = 10;
+
+struct FormatCase {
+    const char *name;
+    lvk::VertexFormat format;
+};
+
+static const FormatCase FORMATS[] = {
+    {"float32 (Vertex layout)", {}},
+    {"half position", {lvk::AttributePrecision::Float16, lvk::AttributePrecision::Float32,
+                       lvk::AttributePrecision::Float32}},
+    {"unorm8 color", {lvk::AttributePrecision::Float32, lvk::AttributePrecision::Unorm8,
+                      lvk::AttributePrecision::Float32}},
+    {"compact", lvk::VertexFormat::Compact()},
+};
+
+static std::vector<lvk::Vertex2> make_vertex2(size_t count) {
+    std::vector<lvk::Vertex2> vertices;
+    vertices.reserve(count);
+    BenchRandom random;
+    for (size_t i = 0; i < count; i++) {
+        vertices.emplace_back(glm::vec3{random.NextFloat() * 2048.0f, random.NextFloat() * 2048.0f, 0.0f},
+                              glm::vec3{random.NextFloat(), random.NextFloat(), random.NextFloat()});
+    }
+    return vertices;
+}
+
+static std::vector<lvk::Vertex3> make_vertex3(size_t count) {
+    std::vector<lvk::Vertex3> vertices;
+    vertices.reserve(count);
+    BenchRandom random;
+    for (size_t i = 0; i < count; i++) {
+        vertices.emplace_back(glm::vec3{random.NextFloat() * 2048.0f, random.NextFloat() * 2048.0f, 0.0f},
+                              glm::vec3{random.NextFloat(), random.NextFloat(), random.NextFloat()},
+                              glm::vec2{random.NextFloat(), random.NextFloat()});
+    }
+    return vertices;
+}
+
+// Upload memory is written once and never read by the CPU, a second buffer stands in for it.
+template<typename Vertex>
+static bool run(const char *vertex_name, const std::vector<Vertex> &vertices,
+                lvk::VertexPacker (*for_format)(const lvk::VertexFormat &)) {
+    size_t count = vertices.size();
+    size_t source_bytes = count * sizeof(Vertex);
+    std::vector<uint8_t> upload(source_bytes);
+    double copy_ms = best_of_ms(RUNS, [&] { memcpy(upload.data(), vertices.data(), source_bytes); });
+
+    std::cout << "  " << vertex_name << ", " << sizeof(Vertex) << " bytes per vertex, plain copy "
+            << copy_ms << " ms\n";
+
+    bool identical = true;
+    for (auto const &c: FORMATS) {
+        auto packer = for_format(c.format);
+        size_t packed_bytes = count * packer.GetStride();
+        std::vector<uint8_t> scalar(packed_bytes);
+        std::vector<uint8_t> simd(packed_bytes);
+
+        double scalar_ms = best_of_ms(RUNS, [&] {
+            packer.Pack(vertices.data(), count, scalar.data(), lvk::PackKernel::kScalar);
+        });
+        double simd_ms = best_of_ms(RUNS, [&] {
+            packer.Pack(vertices.data(), count, simd.data(), lvk::PackKernel::kSimd);
+        });
+        double upload_ms = best_of_ms(RUNS, [&] { memcpy(upload.data(), simd.data(), packed_bytes); });
+        if (memcmp(scalar.data(), simd.data(), packed_bytes) != 0) {
+            std::cout << "    " << c.name << ": scalar and simd output differ!\n";
+            identical = false;
+        }
+
+        std::cout << "    " << c.name << ": stride " << packer.GetStride() << ", fetch "
+                << static_cast<double>(packed_bytes) / (1024.0 * 1024.0) << " MiB per draw ("
+                << 100.0 * static_cast<double>(packed_bytes) / static_cast<double>(source_bytes)
+                << "%), pack scalar " << scalar_ms << " ms, simd " << simd_ms << " ms ("
+                << scalar_ms / simd_ms << "x), upload " << upload_ms << " ms\n";
+    }
+    return identical;
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+
+    std::cout << "[VertexFormatBench] " << count << " vertices\n";
+    bool identical = run("Vertex2", make_vertex2(count), lvk::VertexPacker::ForVertex2);
+    identical &= run("Vertex3", make_vertex3(count), lvk::VertexPacker::ForVertex3);
+    return identical ? 0 : 1;
+}